@@ -0,0 +1,106 @@
+# scripts/build_web_assets.py
+#
+# Gera a imagem do LittleFS a partir de web/:
+#   - cada asset vira <nome>.gz (gzip -9, mtime=0 para a saída ser reprodutível);
+#   - o ETag de cada asset é o hash SHA-256 (16 hex) do conteúdo original;
+#   - index.html passa a referenciar scripts.js/style.css com ?v=<hash>, então os
+#     assets podem ser servidos com cache longo e a página só é revalidada (304);
+#   - /assets.manifest lista "<caminho> <etag> <cache>" para o StaticAssetHandler.
+#
+# Uso:
+#   PlatformIO: extra_scripts = pre:scripts/build_web_assets.py (buildfs/uploadfs usam a saída)
+#   Manual:     python3 scripts/build_web_assets.py   (gera e imprime o comparativo de bytes)
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+import sys
+
+MANIFEST_NAME = "assets.manifest"
+HTML_EXTENSIONS = (".html", ".htm")
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:16]
+
+
+def version_references(html, hashes):
+    # href="style.css" -> href="style.css?v=<hash>" (apenas assets locais conhecidos)
+    def replace(match):
+        attr, quote, name = match.group(1), match.group(2), match.group(3)
+        if name not in hashes:
+            return match.group(0)
+        return '%s=%s%s?v=%s%s' % (attr, quote, name, hashes[name], quote)
+
+    pattern = r'(href|src)=(["\'])([^"\'?#:]+)\2'
+    return re.sub(pattern, replace, html.decode("utf-8")).encode("utf-8")
+
+
+def build(source_dir, output_dir):
+    if os.path.isdir(output_dir):
+        shutil.rmtree(output_dir)
+    os.makedirs(output_dir)
+
+    names = sorted(
+        name for name in os.listdir(source_dir)
+        if os.path.isfile(os.path.join(source_dir, name)) and not name.startswith(".")
+    )
+    contents = {}
+    for name in names:
+        with open(os.path.join(source_dir, name), "rb") as f:
+            contents[name] = f.read()
+
+    # Assets primeiro: os hashes entram nas referências das páginas
+    hashes = {name: content_hash(data) for name, data in contents.items()
+              if not name.endswith(HTML_EXTENSIONS)}
+    for name in names:
+        if name.endswith(HTML_EXTENSIONS):
+            contents[name] = version_references(contents[name], hashes)
+            hashes[name] = content_hash(contents[name])
+
+    rows = []
+    manifest_lines = []
+    for name in names:
+        compressed = gzip.compress(contents[name], compresslevel=9, mtime=0)
+        with open(os.path.join(output_dir, name + ".gz"), "wb") as f:
+            f.write(compressed)
+        cache = "revalidate" if name.endswith(HTML_EXTENSIONS) else "immutable"
+        manifest_lines.append("/%s %s %s\n" % (name, hashes[name], cache))
+        rows.append((name, len(contents[name]), len(compressed)))
+
+    with open(os.path.join(output_dir, MANIFEST_NAME), "w") as f:
+        f.writelines(manifest_lines)
+    return rows
+
+
+def print_report(rows):
+    total_raw = sum(raw for _, raw, _ in rows)
+    total_gz = sum(gz for _, _, gz in rows)
+    print("web assets:")
+    for name, raw, gz in rows:
+        print("  %-16s %7d -> %6d bytes (%3d%%)" % (name, raw, gz, 100 * gz // max(raw, 1)))
+    print("  %-16s %7d -> %6d bytes (%3d%%)" % ("total", total_raw, total_gz, 100 * total_gz // max(total_raw, 1)))
+
+
+def _project_dir():
+    return os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+try:
+    Import("env")  # noqa: F821 (definido pelo SCons do PlatformIO)
+except NameError:
+    env = None
+
+if env is not None:
+    project_dir = env.subst("$PROJECT_DIR")
+    source = os.path.join(project_dir, "web")
+    output = os.path.join(env.subst("$PROJECT_BUILD_DIR"), "webfs")
+    print_report(build(source, output))
+    env.Replace(PROJECT_DATA_DIR=output)
+elif __name__ == "__main__":
+    root = _project_dir()
+    source = sys.argv[1] if len(sys.argv) > 1 else os.path.join(root, "web")
+    output = sys.argv[2] if len(sys.argv) > 2 else os.path.join(root, ".pio", "webfs")
+    print_report(build(source, output))
@@ -0,0 +1,278 @@
+// src/actuators/actuatorEngine.hpp
+#ifndef ACTUATOR_ENGINE_HPP
+#define ACTUATOR_ENGINE_HPP
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "data/targetValues.hpp"
+#include "humidityController.hpp"
+#include "lightSchedule.hpp"
+#include "utils/psychrometrics.hpp"
+
+namespace GrowController {
+
+/**
+ * @brief Como um atuador decide seu estado.
+ */
+enum class ActuatorRule : uint8_t {
+    Schedule, ///< Liga/desliga por horário local (onTime/offTime dos alvos)
+    Setpoint, ///< Compara uma leitura com um alvo, via HumidityController (on/off, histerese ou PID)
+};
+
+/**
+ * @brief Leitura de sensor usada por uma regra Setpoint.
+ */
+enum class ActuatorInput : uint8_t { AirHumidity, SoilHumidity, Temperature, Vpd };
+
+/**
+ * @brief Sentido da regra Setpoint.
+ */
+enum class SetpointDirection : uint8_t {
+    Raise, ///< Liga abaixo do alvo (umidificador, irrigação)
+    Lower, ///< Liga acima do alvo (exaustor, desumidificador)
+};
+
+/**
+ * @brief De onde vem o alvo de uma regra Setpoint.
+ */
+enum class SetpointTarget : uint8_t {
+    Fixed,           ///< O campo target dos alvos, como está
+    HumidityForVpd,  ///< Com climateMode = Vpd: UR que dá o vpd alvo na temperatura da amostra
+};
+
+/**
+ * @brief Uma linha da tabela de atuadores: pino, regra e de onde vêm horário ou alvo.
+ * Os campos da regra que não se aplicam ficam nulos. Use schedule() / setpoint().
+ */
+struct ActuatorDescriptor {
+    const char* name;
+    int pin;
+    ActuatorRule rule;
+    uint32_t minDwellMs; ///< Tempo mínimo em cada estado, além do que a estratégia já impõe
+    float ratedWatts;    ///< Potência nominal da carga, para estimar energia (0 = desconhecida)
+
+    // Schedule
+    struct tm TargetValues::*onTime;
+    struct tm TargetValues::*offTime;
+
+    // Setpoint
+    ActuatorInput input;
+    float TargetValues::*target;                 ///< Alvo comparado com a leitura
+    SetpointDirection direction;
+    HumidityControlParams TargetValues::*control; ///< Estratégia; nullptr = on/off simples
+    SetpointTarget targetSource;
+
+    static ActuatorDescriptor schedule(const char* name, int pin, struct tm TargetValues::*onTime,
+                                       struct tm TargetValues::*offTime, uint32_t minDwellMs = 0,
+                                       float ratedWatts = 0.0f) {
+        ActuatorDescriptor descriptor = {name, pin, ActuatorRule::Schedule, minDwellMs, ratedWatts, onTime, offTime,
+                                         ActuatorInput::AirHumidity, nullptr, SetpointDirection::Raise, nullptr,
+                                         SetpointTarget::Fixed};
+        return descriptor;
+    }
+
+    static ActuatorDescriptor setpoint(const char* name, int pin, ActuatorInput input, float TargetValues::*target,
+                                       SetpointDirection direction,
+                                       HumidityControlParams TargetValues::*control = nullptr,
+                                       uint32_t minDwellMs = 0, float ratedWatts = 0.0f,
+                                       SetpointTarget targetSource = SetpointTarget::Fixed) {
+        ActuatorDescriptor descriptor = {name, pin, ActuatorRule::Setpoint, minDwellMs, ratedWatts, nullptr, nullptr,
+                                         input, target, direction, control, targetSource};
+        return descriptor;
+    }
+};
+
+struct ActuatorReadings {
+    float airHumidity = NAN;
+    float soilHumidity = NAN;
+    float temperature = NAN;
+    float vpd = NAN;
+
+    float value(ActuatorInput input) const {
+        switch (input) {
+            case ActuatorInput::AirHumidity:  return airHumidity;
+            case ActuatorInput::SoilHumidity: return soilHumidity;
+            case ActuatorInput::Temperature:  return temperature;
+            case ActuatorInput::Vpd:          return vpd;
+        }
+        return NAN;
+    }
+};
+
+/**
+ * @brief Tudo o que as regras enxergam numa passada.
+ */
+struct ActuatorInputs {
+    TargetValues targets;
+    ActuatorReadings readings;
+    bool resample = false;      ///< Amostra ou alvo novo: regras Setpoint recalculam a demanda
+    bool clockValid = false;    ///< Relógio sincronizado (regras Schedule ficam paradas sem ele)
+    time_t epoch = 0;
+    uint16_t epochMillis = 0;
+    uint32_t nowMs = 0;         ///< millis()
+    uint32_t clockRetryMs = 5000; ///< Espera enquanto o relógio não é válido
+};
+
+/**
+ * @brief Avalia todas as regras de uma tabela de atuadores numa única passada.
+ *
+ * evaluate() devolve quais saídas mudaram e quanto tempo falta até a próxima mudança
+ * prevista (troca de horário, borda da janela do PID, fim de tempo mínimo); entre uma
+ * passada e outra a tarefa dona só precisa dormir. Não é thread-safe: pertence à tarefa
+ * de atuadores. Sem E/S: quem aplica as saídas nos pinos é o chamador.
+ * @tparam MaxActuators Tamanho da tabela (até 32, por causa da máscara de mudanças).
+ */
+template <size_t MaxActuators>
+class ActuatorEngine {
+public:
+    static_assert(MaxActuators > 0 && MaxActuators <= 32, "ActuatorEngine changed-mask is 32 bits");
+
+    static const uint32_t MAX_SLEEP_MS = 15UL * 60UL * 1000UL; ///< Reavalia mesmo sem eventos (deriva do relógio)
+    static const uint32_t WAKE_MARGIN_MS = 50;                 ///< Acorda logo depois de o minuto virar
+    static constexpr float VPD_HUMIDITY_MIN = 30.0f;           ///< Limites do alvo de UR derivado do VPD
+    static constexpr float VPD_HUMIDITY_MAX = 90.0f;           ///< (acima disso condensa nas folhas e paredes)
+
+    bool add(const ActuatorDescriptor& descriptor) {
+        if (count_ >= MaxActuators) {
+            return false;
+        }
+        descriptors_[count_] = descriptor;
+        states_[count_] = State();
+        count_++;
+        return true;
+    }
+
+    size_t count() const { return count_; }
+    const ActuatorDescriptor& descriptor(size_t index) const { return descriptors_[index]; }
+    bool output(size_t index) const { return states_[index].on; }
+    const HumidityController& controller(size_t index) const { return states_[index].controller; }
+    /// Alvo usado na última amostra de uma regra Setpoint (derivado, no modo VPD); NAN antes da primeira.
+    float target(size_t index) const { return states_[index].target; }
+
+    /**
+     * @brief Avalia todas as regras.
+     * @param waitMs Recebe a espera até a próxima mudança prevista (no máximo MAX_SLEEP_MS).
+     * @return Máscara (bit i = atuador i) das saídas que mudaram; a primeira passada reporta todas.
+     */
+    uint32_t evaluate(const ActuatorInputs& in, uint32_t* waitMs) {
+        uint32_t changed = 0;
+        uint32_t wait = MAX_SLEEP_MS;
+        for (size_t i = 0; i < count_; ++i) {
+            const ActuatorDescriptor& descriptor = descriptors_[i];
+            State& state = states_[i];
+            bool desired = state.on;
+            bool bypassDwell = false;
+            uint32_t ruleWait = MAX_SLEEP_MS;
+
+            if (descriptor.rule == ActuatorRule::Schedule) {
+                if (in.clockValid) {
+                    desired = _scheduleOn(descriptor, in, &ruleWait);
+                } else {
+                    ruleWait = in.clockRetryMs; // Mantém o estado até haver relógio
+                }
+            } else {
+                desired = _setpointOn(descriptor, state, in, &ruleWait, &bypassDwell);
+            }
+
+            if (desired != state.on || !state.applied) {
+                uint32_t hold = bypassDwell ? 0 : _dwellRemaining(descriptor, state, in.nowMs);
+                if (hold == 0) {
+                    if (desired != state.on) {
+                        state.lastSwitchMs = in.nowMs;
+                        state.switched = true;
+                    }
+                    state.on = desired;
+                    state.applied = true;
+                    changed |= 1u << i;
+                } else if (hold < ruleWait) {
+                    ruleWait = hold;
+                }
+            }
+            if (ruleWait < wait) {
+                wait = ruleWait;
+            }
+        }
+        if (waitMs) {
+            *waitMs = wait;
+        }
+        return changed;
+    }
+
+private:
+    struct State {
+        bool on = false;
+        bool applied = false;  ///< Já foi escrito no pino ao menos uma vez
+        bool switched = false; ///< Já trocou de estado (o tempo mínimo conta a partir daí)
+        uint32_t lastSwitchMs = 0;
+        float target = NAN;
+        HumidityController controller;
+    };
+
+    static bool _scheduleOn(const ActuatorDescriptor& descriptor, const ActuatorInputs& in, uint32_t* waitMs) {
+        const struct tm& on = in.targets.*(descriptor.onTime);
+        const struct tm& off = in.targets.*(descriptor.offTime);
+        struct tm local;
+        localtime_r(&in.epoch, &local);
+        bool shouldBeOn = lightShouldBeOn(local.tm_hour * 60 + local.tm_min, on.tm_hour * 60 + on.tm_min,
+                                          off.tm_hour * 60 + off.tm_min);
+        LightTransition next = nextLightTransition(in.epoch, on, off);
+        if (next.at != 0) {
+            uint64_t untilNext = (uint64_t)(next.at - in.epoch) * 1000 - in.epochMillis + WAKE_MARGIN_MS;
+            *waitMs = untilNext > MAX_SLEEP_MS ? MAX_SLEEP_MS : (uint32_t)untilNext;
+        }
+        return shouldBeOn;
+    }
+
+    static bool _setpointOn(const ActuatorDescriptor& descriptor, State& state, const ActuatorInputs& in,
+                            uint32_t* waitMs, bool* bypassDwell) {
+        HumidityControlParams params;
+        if (descriptor.control != nullptr) {
+            params = in.targets.*(descriptor.control);
+        } else {
+            params.mode = HumidityControlMode::OnOff;
+        }
+        state.controller.configure(params);
+
+        if (in.resample) {
+            float target = _setpointTarget(descriptor, in);
+            state.target = target;
+            float value = in.readings.value(descriptor.input);
+            if (descriptor.direction == SetpointDirection::Lower) {
+                // Espelha a leitura em torno do alvo: "acima do alvo" vira "abaixo", mesmo controlador
+                value = 2.0f * target - value;
+            }
+            state.controller.onSample(value, target, in.nowMs);
+            *bypassDwell = isnan(value) || isnan(target) || target <= 0.0f; // Dado inválido desliga já
+        }
+        bool on = state.controller.relayState(in.nowMs);
+        *waitMs = state.controller.msUntilNextChange(in.nowMs);
+        return on;
+    }
+
+    static float _setpointTarget(const ActuatorDescriptor& descriptor, const ActuatorInputs& in) {
+        if (descriptor.targetSource == SetpointTarget::HumidityForVpd && in.targets.climateMode == ClimateMode::Vpd) {
+            // Recalculado a cada amostra: a temperatura muda, o VPD alvo não (NAN desliga, por segurança)
+            float humidity = humidityForVpd(in.readings.temperature, in.targets.vpd);
+            if (isnan(humidity)) return NAN;
+            return humidity < VPD_HUMIDITY_MIN ? VPD_HUMIDITY_MIN
+                                               : (humidity > VPD_HUMIDITY_MAX ? VPD_HUMIDITY_MAX : humidity);
+        }
+        return in.targets.*(descriptor.target);
+    }
+
+    static uint32_t _dwellRemaining(const ActuatorDescriptor& descriptor, const State& state, uint32_t nowMs) {
+        if (!state.switched) return 0;
+        uint32_t elapsed = nowMs - state.lastSwitchMs;
+        return elapsed >= descriptor.minDwellMs ? 0 : descriptor.minDwellMs - elapsed;
+    }
+
+    ActuatorDescriptor descriptors_[MaxActuators] = {};
+    State states_[MaxActuators];
+    size_t count_ = 0;
+};
+
+} // namespace GrowController
+
+#endif // ACTUATOR_ENGINE_HPP
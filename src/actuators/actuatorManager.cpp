@@ -3,12 +3,14 @@
 #include <Arduino.h>           // Para pinMode, digitalWrite, Serial, etc.
 #include <math.h>              // Para isnan
 #include <time.h>              // Para struct tm
+#include "data/runtimeSettings.hpp" // Intervalos de verificação (umidade / relógio)
+#include "controlSchedule.hpp"     // Reavaliação de segurança sem eventos
+#include "data/dataHistoryManager.hpp" // Totais diários de uso
+#include "network/mqttManager.hpp"     // Linhas de uso em <room>/actuators/usage
 
 namespace GrowController {
 
-// Definição das constantes estáticas
-const TickType_t ActuatorManager::LIGHT_CHECK_INTERVAL_MS = pdMS_TO_TICKS(5000);     // 5 segundos
-const TickType_t ActuatorManager::HUMIDITY_CHECK_INTERVAL_MS = pdMS_TO_TICKS(10000); // 10 segundos
+static_assert(ActuatorManager::MAX_ACTUATORS <= ACTUATOR_USAGE_SLOTS, "ActuatorDailyUsage must hold every actuator");
 
 // --- Construtor e Destrutor ---
 
@@ -16,26 +18,50 @@ const TickType_t ActuatorManager::HUMIDITY_CHECK_INTERVAL_MS = pdMS_TO_TICKS(100
 ActuatorManager::ActuatorManager(const GPIOControlConfig& config,
                                  TargetDataManager& targetMgr,
                                  SensorManager& sensorMgr,
-                                 TimeService& timeSvc) : // <<< Parâmetro timeSvc adicionado
+                                 TimeService& timeSvc, // <<< Parâmetro timeSvc adicionado
+                                 RuntimeSettings* settings,
+                                 ChangeNotifier* notifier,
+                                 DataHistoryManager* historyMgr,
+                                 MqttManager* mqttMgr) :
     gpioConfig(config),
     targetDataManager(targetMgr),
     sensorManager(sensorMgr),
     timeService(timeSvc),       // <<< Inicializa o membro timeService com o parâmetro timeSvc
-    lastLightState(-1),
-    lightTaskHandle(nullptr),
-    humidityTaskHandle(nullptr),
-    initialized(false)
-{} // Corpo do construtor vazio, inicialização feita na lista
+    runtimeSettings(settings),
+    changeNotifier(notifier),
+    dataHistoryManager(historyMgr),
+    mqttManager(mqttMgr),
+    controlTaskHandle(nullptr),
+    initialized(false),
+    lastCheckpointMs(0)
+{
+    for (size_t i = 0; i < MAX_ACTUATORS; ++i) {
+        publishedTargets[i].store(NAN, std::memory_order_relaxed);
+    }
+    // Tabela de atuadores: um ventilador ou uma bomba é mais uma linha aqui (+ pino em GPIOControlConfig).
+    // A ordem define os índices ACTUATOR_*.
+    engine.add(ActuatorDescriptor::schedule("light", gpioConfig.lightControlPin,
+                                            &TargetValues::lightOnTime, &TargetValues::lightOffTime,
+                                            0, gpioConfig.lightLoadWatts));
+    // No modo VPD (climateMode), o alvo de UR é recalculado a cada amostra a partir da temperatura
+    engine.add(ActuatorDescriptor::setpoint("humidifier", gpioConfig.humidityControlPin,
+                                            ActuatorInput::AirHumidity, &TargetValues::airHumidity,
+                                            SetpointDirection::Raise, &TargetValues::humidityControl,
+                                            0, gpioConfig.humidityLoadWatts, SetpointTarget::HumidityForVpd));
+    if (gpioConfig.irrigationControlPin >= 0) {
+        engine.add(ActuatorDescriptor::setpoint("irrigation", gpioConfig.irrigationControlPin,
+                                                ActuatorInput::SoilHumidity, &TargetValues::soilHumidity,
+                                                SetpointDirection::Raise, &TargetValues::irrigationControl,
+                                                0, gpioConfig.irrigationLoadWatts));
+    }
+}
 
 ActuatorManager::~ActuatorManager() {
-    // Parar tarefas se estiverem rodando
-    if (lightTaskHandle != nullptr) {
-        vTaskDelete(lightTaskHandle);
-        lightTaskHandle = nullptr;
-    }
-    if (humidityTaskHandle != nullptr) {
-        vTaskDelete(humidityTaskHandle);
-        humidityTaskHandle = nullptr;
+    // Parar tarefa se estiver rodando
+    if (controlTaskHandle != nullptr) {
+        if (changeNotifier) changeNotifier->unsubscribe(controlTaskHandle);
+        vTaskDelete(controlTaskHandle);
+        controlTaskHandle = nullptr;
     }
     Serial.println("ActuatorManager: Destroyed.");
 }
@@ -49,15 +75,14 @@ bool ActuatorManager::initialize() {
     }
     Serial.println("ActuatorManager: Initializing Actuator GPIOs...");
 
-    // Configura Pino da Luz
-    Serial.printf(" - Light Control Pin: %d\n", gpioConfig.lightControlPin);
-    pinMode(gpioConfig.lightControlPin, OUTPUT);
-    digitalWrite(gpioConfig.lightControlPin, LOW); // Estado inicial desligado
-
-    // Configura Pino de Umidade
-    Serial.printf(" - Humidity Control Pin: %d\n", gpioConfig.humidityControlPin);
-    pinMode(gpioConfig.humidityControlPin, OUTPUT);
-    digitalWrite(gpioConfig.humidityControlPin, LOW); // Estado inicial desligado
+    uint32_t now = millis();
+    for (size_t i = 0; i < engine.count(); ++i) {
+        const ActuatorDescriptor& actuator = engine.descriptor(i);
+        Serial.printf(" - %s Pin: %d\n", actuator.name, actuator.pin);
+        pinMode(actuator.pin, OUTPUT);
+        digitalWrite(actuator.pin, LOW); // Estado inicial desligado
+        usage[i].begin(false, now);
+    }
 
     initialized = true;
     Serial.println("ActuatorManager: GPIOs Initialized.");
@@ -71,189 +96,267 @@ bool ActuatorManager::isInitialized() const {
 
 // --- Métodos de Controle (Internos) ---
 
-void ActuatorManager::checkAndControlLight(const struct tm& lightOn, const struct tm& lightOff, int lightPin) {
-    struct tm timeinfo = {0};
-    // <<< USA O MEMBRO timeService injetado para chamar getCurrentTime
-    if (!timeService.getCurrentTime(timeinfo)) {
-        Serial.println("ActuatorManager WARN: Failed to get current time for light control!");
-        return;
+void ActuatorManager::readInputs(ActuatorInputs& inputs, bool resample) {
+    // Obtém alvos do TargetDataManager injetado (um único lock para todas as regras)
+    inputs.targets = targetDataManager.getTargets();
+    inputs.resample = resample;
+    if (resample) {
+        // Leituras só quando há amostra/alvo novo: nas bordas de horário elas não mudam nada
+        inputs.readings.airHumidity = sensorManager.getHumidity();
+        inputs.readings.soilHumidity = sensorManager.getSoilHumidity();
+        inputs.readings.temperature = sensorManager.getTemperature();
+        inputs.readings.vpd = sensorManager.getVpd();
     }
+    // <<< USA O MEMBRO timeService injetado para obter a hora atual
+    inputs.clockValid = timeService.getCurrentEpoch(inputs.epoch, &inputs.epochMillis);
+    inputs.clockRetryMs = runtimeSettings ? runtimeSettings->getRates().lightCheckIntervalMs
+                                          : RuntimeRates().lightCheckIntervalMs;
+    inputs.nowMs = millis();
+}
+
+void ActuatorManager::applyOutputs(uint32_t changed, const ActuatorInputs& inputs) {
+    bool statusChanged = false;
+    for (size_t i = 0; i < engine.count(); ++i) {
+        // Alvo derivado (modo VPD) acompanha a temperatura: o status só é avisado a cada 0.5 %UR
+        float target = engine.target(i);
+        float published = publishedTargets[i].load(std::memory_order_relaxed);
+        if (!(isnan(target) && isnan(published)) &&
+            (isnan(target) != isnan(published) || fabsf(target - published) >= TARGET_PUBLISH_STEP)) {
+            publishedTargets[i].store(target, std::memory_order_relaxed);
+            statusChanged = true;
+        }
+        if ((changed & (1u << i)) == 0) {
+            continue;
+        }
+        const ActuatorDescriptor& actuator = engine.descriptor(i);
+        bool on = engine.output(i);
+        int desiredState = on ? HIGH : LOW;
+        // Só escreve (e avisa) quando o pino realmente muda
+        if (digitalRead(actuator.pin) == desiredState) {
+            continue;
+        }
+        digitalWrite(actuator.pin, desiredState);
+        statusChanged = true;
+        if (xSemaphoreTake(usageMutex.get(), pdMS_TO_TICKS(50)) == pdTRUE) {
+            usage[i].onTransition(on, inputs.nowMs);
+            xSemaphoreGive(usageMutex.get());
+        } else {
+            Serial.printf("ActuatorManager WARN: Usage lock timed out, %s transition not counted.\n", actuator.name);
+        }
 
-    int nowMinutes = timeinfo.tm_hour * 60 + timeinfo.tm_min;
-    int startMinutes = lightOn.tm_hour * 60 + lightOn.tm_min;
-    int endMinutes = lightOff.tm_hour * 60 + lightOff.tm_min;
-    bool shouldBeOn = false;
-
-    if (startMinutes == endMinutes) {
-        shouldBeOn = false; // Sempre desligado se on=off
-    } else if (startMinutes < endMinutes) { // Horário diurno
-        shouldBeOn = (nowMinutes >= startMinutes && nowMinutes < endMinutes);
-    } else { // Horário noturno (atravessa meia-noite)
-        shouldBeOn = (nowMinutes >= startMinutes || nowMinutes < endMinutes);
+        if (actuator.rule == ActuatorRule::Setpoint) {
+            Serial.printf("ActuatorManager: %s changed to %s (Reading: %.1f, Target: %.1f, Mode: %s, Duty: %.2f, Pin: %d)\n",
+                          actuator.name, on ? "ON" : "OFF",
+                          inputs.readings.value(actuator.input), engine.target(i),
+                          humidityControlModeName(engine.controller(i).params().mode),
+                          engine.controller(i).duty(), actuator.pin);
+        } else {
+            const struct tm& onTime = inputs.targets.*(actuator.onTime);
+            const struct tm& offTime = inputs.targets.*(actuator.offTime);
+            Serial.printf("ActuatorManager: %s changed to %s (Pin: %d, Schedule: %02d:%02d-%02d:%02d)\n",
+                          actuator.name, on ? "ON" : "OFF", actuator.pin,
+                          onTime.tm_hour, onTime.tm_min, offTime.tm_hour, offTime.tm_min);
+        }
     }
+    if (statusChanged) {
+        _onRelayChanged(); // Uma notificação por passada, mesmo que vários relés/alvos mudem
+    }
+}
 
-    // Aplica o estado e loga apenas na mudança
-    int desiredState = shouldBeOn ? HIGH : LOW;
-    // Ler estado atual para evitar escritas desnecessárias? Opcional.
-    // int currentState = digitalRead(lightPin);
-    // if (desiredState != currentState) { ... }
-
-    digitalWrite(lightPin, desiredState);
-
-    if (desiredState != this->lastLightState) {
-        Serial.printf("ActuatorManager: Light state changed to %s (Pin: %d, Schedule: %02d:%02d-%02d:%02d, Now: %02d:%02d)\n",
-                      shouldBeOn ? "ON" : "OFF",
-                      lightPin,
-                      lightOn.tm_hour, lightOn.tm_min,
-                      lightOff.tm_hour, lightOff.tm_min,
-                      timeinfo.tm_hour, timeinfo.tm_min);
-        this->lastLightState = desiredState;
+void ActuatorManager::_onRelayChanged() {
+    stateVersion.fetch_add(1, std::memory_order_release);
+    if (changeNotifier) {
+        changeNotifier->notify(CHANGE_STATUS);
     }
 }
 
-void ActuatorManager::checkAndControlHumidity(float currentHumidity, float targetHumidity, int humidityPin) {
-    // Validação (igual à anterior)
-    if (isnan(currentHumidity) || isnan(targetHumidity) || targetHumidity <= 0.0f) {
-        if (digitalRead(humidityPin) == HIGH) {
-            digitalWrite(humidityPin, LOW);
-            Serial.printf("ActuatorManager: Humidifier turned OFF due to invalid data (Current: %.1f, Target: %.1f, Pin: %d)\n",
-                          currentHumidity, targetHumidity, humidityPin);
+// --- Contabilidade de uso ---
+
+uint32_t ActuatorManager::_serviceUsage(const ActuatorInputs& inputs) {
+    if (!inputs.clockValid) {
+        return UINT32_MAX; // Sem relógio não há "dia": os contadores seguem acumulando
+    }
+    uint32_t today = localDayKey(inputs.epoch);
+    uint32_t current = usageDay.load(std::memory_order_relaxed);
+    ActuatorDailyUsage record = {};
+    record.count = (uint8_t)engine.count();
+
+    if (current == 0) {
+        // Primeiro relógio válido desde o boot: retoma o checkpoint de hoje, se houver
+        ActuatorDailyUsage saved;
+        if (dataHistoryManager && dataHistoryManager->readDailyUsage(&saved, 1) == 1 && saved.day == today &&
+            xSemaphoreTake(usageMutex.get(), pdMS_TO_TICKS(50)) == pdTRUE) {
+            for (size_t i = 0; i < engine.count() && i < saved.count; ++i) {
+                usage[i].seedToday(saved.onSeconds[i], saved.switches[i]);
+            }
+            xSemaphoreGive(usageMutex.get());
+            Serial.printf("ActuatorManager: Resumed usage totals of %lu.\n", (unsigned long)today);
+        }
+        usageDay.store(today, std::memory_order_release);
+        lastCheckpointMs = inputs.nowMs;
+    } else if (today != current || inputs.nowMs - lastCheckpointMs >= USAGE_CHECKPOINT_MS) {
+        bool closing = today != current;
+        record.day = current;
+        if (xSemaphoreTake(usageMutex.get(), pdMS_TO_TICKS(50)) == pdTRUE) {
+            for (size_t i = 0; i < engine.count(); ++i) {
+                uint32_t onSeconds = 0;
+                uint32_t switches = 0;
+                if (closing) {
+                    usage[i].closeDay(inputs.nowMs, &onSeconds, &switches);
+                } else {
+                    ActuatorUsageSnapshot snapshot = usage[i].snapshot(inputs.nowMs);
+                    onSeconds = snapshot.todayOnMs / 1000;
+                    switches = snapshot.todaySwitches;
+                }
+                record.onSeconds[i] = onSeconds;
+                record.switches[i] = switches > UINT16_MAX ? UINT16_MAX : (uint16_t)switches;
+            }
+            xSemaphoreGive(usageMutex.get());
+            if (closing) {
+                usageDay.store(today, std::memory_order_release);
+            }
+            lastCheckpointMs = inputs.nowMs;
+            _saveUsage(record);
         }
-        return;
     }
 
-    // Lógica de controle (igual à anterior)
-    bool shouldBeOn = (currentHumidity < targetHumidity);
-    int currentState = digitalRead(humidityPin);
-    int desiredState = shouldBeOn ? HIGH : LOW;
+    // Acorda na meia-noite local (fecha o dia na hora certa) ou no próximo checkpoint
+    uint64_t untilMidnight = (uint64_t)(nextLocalMidnight(inputs.epoch) - inputs.epoch) * 1000 -
+                             inputs.epochMillis + ActuatorEngine<MAX_ACTUATORS>::WAKE_MARGIN_MS;
+    uint32_t sinceCheckpoint = inputs.nowMs - lastCheckpointMs;
+    uint32_t untilCheckpoint = sinceCheckpoint >= USAGE_CHECKPOINT_MS ? 0 : USAGE_CHECKPOINT_MS - sinceCheckpoint;
+    return untilMidnight < untilCheckpoint ? (uint32_t)untilMidnight : untilCheckpoint;
+}
 
-    if (desiredState != currentState) {
-        digitalWrite(humidityPin, desiredState);
-        Serial.printf("ActuatorManager: Humidifier state changed to %s (Current: %.1f%%, Target: %.1f%%, Pin: %d)\n",
-                      shouldBeOn ? "ON" : "OFF",
-                      currentHumidity, targetHumidity, humidityPin);
+void ActuatorManager::_saveUsage(const ActuatorDailyUsage& record) {
+    if (dataHistoryManager && !dataHistoryManager->putDailyUsage(record)) {
+        Serial.printf("ActuatorManager WARN: Failed to save usage totals of %lu.\n", (unsigned long)record.day);
+    }
+    if (mqttManager == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < record.count; ++i) {
+        const ActuatorDescriptor& actuator = engine.descriptor(i);
+        char payload[40];
+        if (formatUsagePayload(payload, sizeof(payload), actuator.name, record.day, record.onSeconds[i],
+                               record.switches[i], energyWh(record.onSeconds[i], actuator.ratedWatts)) < 0) {
+            Serial.printf("ActuatorManager WARN: Usage line of %s does not fit the MQTT payload.\n", actuator.name);
+            continue;
+        }
+        mqttManager->publish(MqttTopic::ActuatorUsage, payload);
     }
 }
 
-// --- Gerenciamento das Tarefas ---
+// --- Gerenciamento da Tarefa ---
 
-bool ActuatorManager::startControlTasks(UBaseType_t lightTaskPriority,
-                                        UBaseType_t humidityTaskPriority,
-                                        uint32_t stackSize)
+bool ActuatorManager::startControlTask(UBaseType_t priority, uint32_t stackSize)
 {
      if (!initialized) {
-         Serial.println("ActuatorManager ERROR: Cannot start tasks, manager not initialized.");
+         Serial.println("ActuatorManager ERROR: Cannot start task, manager not initialized.");
          return false;
     }
-    if (lightTaskHandle != nullptr || humidityTaskHandle != nullptr) {
-        Serial.println("ActuatorManager WARN: Tasks already started.");
-        return true; // Ou false?
-    }
-
-    Serial.println("ActuatorManager: Starting control tasks...");
-    bool success = true;
-
-    // Inicia Tarefa de Luz
-    BaseType_t lightResult = xTaskCreate(
-        lightControlTaskWrapper,
-        "LightCtrlTask",
-        stackSize, // Usar stack size comum ou individual?
-        this,      // Passa ponteiro da instância
-        lightTaskPriority,
-        &this->lightTaskHandle
-    );
-    if (lightResult != pdPASS) {
-        lightTaskHandle = nullptr;
-        Serial.print("ActuatorManager ERROR: Failed to create Light Control task! Code: ");
-        Serial.println(lightResult);
-        success = false;
+    if (controlTaskHandle != nullptr) {
+        Serial.println("ActuatorManager WARN: Task already started.");
+        return true;
     }
 
-    // Inicia Tarefa de Umidade
-    BaseType_t humidityResult = xTaskCreate(
-        humidityControlTaskWrapper,
-        "HumidCtrlTask",
+    Serial.println("ActuatorManager: Starting actuator control task...");
+    BaseType_t result = xTaskCreate(
+        controlTaskWrapper,
+        "ActuatorTask",
         stackSize,
-        this,
-        humidityTaskPriority,
-        &this->humidityTaskHandle
+        this,      // Passa ponteiro da instância
+        priority,
+        &this->controlTaskHandle
     );
-     if (humidityResult != pdPASS) {
-        humidityTaskHandle = nullptr;
-        Serial.print("ActuatorManager ERROR: Failed to create Humidity Control task! Code: ");
-        Serial.println(humidityResult);
-        success = false;
+    if (result != pdPASS) {
+        controlTaskHandle = nullptr;
+        Serial.print("ActuatorManager ERROR: Failed to create actuator control task! Code: ");
+        Serial.println(result);
+        return false;
     }
-
-    if (success) {
-        Serial.println("ActuatorManager: Control tasks started.");
-    } else {
-         // Se uma falhou, talvez parar a outra?
-         if (lightTaskHandle) { vTaskDelete(lightTaskHandle); lightTaskHandle = nullptr; }
-         // (humidityTaskHandle já seria null se falhou)
-    }
-
-    return success;
+    Serial.println("ActuatorManager: Actuator control task started.");
+    return true;
 }
 
 
-// --- Implementação das Tarefas (Wrappers e Loops) ---
+// --- Implementação da Tarefa (Wrapper e Loop) ---
 
-void ActuatorManager::lightControlTaskWrapper(void* pvParameters) {
+void ActuatorManager::controlTaskWrapper(void* pvParameters) {
      ActuatorManager* instance = static_cast<ActuatorManager*>(pvParameters);
      if (instance) {
-         instance->runLightControlTask();
+         instance->runControlTask();
      }
      vTaskDelete(NULL); // Garante término
 }
 
-void ActuatorManager::runLightControlTask() {
-    Serial.println("ActuatorManager: Light Control Task started.");
+void ActuatorManager::runControlTask() {
+    Serial.println("ActuatorManager: Actuator Control Task started.");
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (runtimeSettings) {
+        runtimeSettings->addListener(self);
+    }
+    // Amostra nova e alvo novo reavaliam os setpoints; ajuste do relógio (SNTP) reprograma os horários
+    if (changeNotifier && !changeNotifier->subscribe(self, CHANGE_SENSORS | CHANGE_TARGETS | CHANGE_TIME)) {
+        Serial.println("ActuatorManager WARN: ChangeNotifier full, actuator control falls back to polling.");
+    }
+    EventDrivenSchedule schedule;
+    bool notified = false;
+    ActuatorInputs inputs;
     while (true) {
-        // Obtém alvos do TargetDataManager injetado
-        struct tm onTime = targetDataManager.getLightOnTime();
-        struct tm offTime = targetDataManager.getLightOffTime();
+        uint32_t interval = runtimeSettings ? runtimeSettings->getRates().humidityCheckIntervalMs
+                                            : RuntimeRates().humidityCheckIntervalMs;
+        bool resample = schedule.due(notified, millis(), interval);
+        readInputs(inputs, resample);
+        if (resample) {
+            schedule.markRun(inputs.nowMs);
+        }
 
-        // Chama método de controle interno (que agora usa o timeService injetado)
-        checkAndControlLight(onTime, offTime, gpioConfig.lightControlPin);
+        // Todas as regras numa passada; o motor diz quando é a próxima mudança prevista
+        uint32_t waitMs = 0;
+        uint32_t changed = engine.evaluate(inputs, &waitMs);
+        applyOutputs(changed, inputs);
+        uint32_t usageWaitMs = _serviceUsage(inputs);
+        if (usageWaitMs < waitMs) {
+            waitMs = usageWaitMs;
+        }
 
-        vTaskDelay(LIGHT_CHECK_INTERVAL_MS);
+        // Dorme até: evento (ChangeNotifier), intervalo alterado (RuntimeSettings, também
+        // conta como notificação: só custa uma avaliação extra), a próxima mudança prevista
+        // (horário, janela do PID, tempo mínimo), a virada do dia/checkpoint de uso
+        // ou a reavaliação de segurança.
+        uint32_t fallbackMs = schedule.waitMs(millis(), interval);
+        if (fallbackMs < waitMs) {
+            waitMs = fallbackMs;
+        }
+        notified = xTaskNotifyWait(0, UINT32_MAX, nullptr, pdMS_TO_TICKS(waitMs)) == pdTRUE;
     }
 }
 
-
-void ActuatorManager::humidityControlTaskWrapper(void* pvParameters) {
-    ActuatorManager* instance = static_cast<ActuatorManager*>(pvParameters);
-     if (instance) {
-         instance->runHumidityControlTask();
-     }
-     vTaskDelete(NULL);
+bool ActuatorManager::isActuatorOn(size_t index) const {
+    if (!initialized || index >= engine.count()) return false;
+    // A lógica do relé pode ser invertida (LOW para ON). Ajuste conforme necessário.
+    return digitalRead(engine.descriptor(index).pin) == HIGH;
 }
 
-void ActuatorManager::runHumidityControlTask() {
-    Serial.println("ActuatorManager: Humidity Control Task started.");
-    while (true) {
-        // Obtém umidade atual do SensorManager injetado (THREAD-SAFE getter)
-        float currentAirHumidity = sensorManager.getHumidity();
-
-        // Obtém umidade alvo do TargetDataManager injetado (THREAD-SAFE getter)
-        float targetAirHumidity = targetDataManager.getTargetAirHumidity();
-
-        // Chama método de controle interno
-        checkAndControlHumidity(currentAirHumidity, targetAirHumidity, gpioConfig.humidityControlPin);
+bool ActuatorManager::getActuatorUsage(size_t index, ActuatorUsageSnapshot* out) const {
+    if (out == nullptr || index >= engine.count()) return false;
+    if (xSemaphoreTake(usageMutex.get(), pdMS_TO_TICKS(50)) != pdTRUE) return false;
+    *out = usage[index].snapshot(millis());
+    xSemaphoreGive(usageMutex.get());
+    return true;
+}
 
-        vTaskDelay(HUMIDITY_CHECK_INTERVAL_MS);
-    }
+float ActuatorManager::getActuatorTarget(size_t index) const {
+    if (index >= engine.count()) return NAN;
+    return publishedTargets[index].load(std::memory_order_relaxed);
 }
 
 bool ActuatorManager::isLightRelayOn() const {
-    if (!initialized) return false; // Ou o estado padrão que você preferir se não inicializado
-    // A lógica do relé pode ser invertida (LOW para ON). Ajuste conforme necessário.
-    return digitalRead(gpioConfig.lightControlPin) == HIGH;
+    return isActuatorOn(ACTUATOR_LIGHT);
 }
 
 bool ActuatorManager::isHumidifierRelayOn() const {
-    if (!initialized) return false;
-    return digitalRead(gpioConfig.humidityControlPin) == HIGH;
+    return isActuatorOn(ACTUATOR_HUMIDIFIER);
 }
-} // namespace GrowController
\ No newline at end of file
+} // namespace GrowController
@@ -7,12 +7,21 @@
 #include "sensors/sensorManager.hpp"  // For SensorManager
 #include "utils/timeService.hpp"    // For TimeService
 #include "utils/freeRTOSMutex.hpp"  // For FreeRTOSMutex (if needed for shared state, though not explicitly used in this header)
+#include "utils/changeNotifier.hpp" // For ChangeNotifier
+#include "actuatorEngine.hpp"      // For ActuatorEngine / ActuatorDescriptor
+#include "actuatorUsage.hpp"       // For ActuatorUsageTracker
+#include "data/actuatorDailyUsage.hpp" // For ActuatorDailyUsage
 #include <time.h>                   // For struct tm
+#include <atomic>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 namespace GrowController {
 
+class RuntimeSettings;
+class DataHistoryManager;
+class MqttManager;
+
 // Forward declaration for TimeService, if preferred over direct include in some contexts,
 // but direct include is generally fine for member types.
 // class TimeService;
@@ -22,7 +31,8 @@ namespace GrowController {
  * 
  * This class is responsible for initializing and controlling actuators based on
  * target values (e.g., from TargetDataManager) and current conditions (e.g., time from TimeService,
- * sensor readings from SensorManager). It uses FreeRTOS tasks for continuous control loops.
+ * sensor readings from SensorManager). Actuators are rows of a descriptor table (pin, rule,
+ * schedule or setpoint source, minimum dwell) evaluated together by one FreeRTOS task.
  */
 class ActuatorManager {
 public:
@@ -33,11 +43,21 @@ public:
      * @param targetMgr Reference to the TargetDataManager to get target settings (e.g., light on/off times, target humidity).
      * @param sensorMgr Reference to the SensorManager to get current sensor readings (e.g., humidity).
      * @param timeSvc Reference to the TimeService to get the current time for time-based control (e.g., lights).
+     * @param settings Optional runtime-tunable check intervals (defaults are used when null).
+     * @param notifier Optional; told (CHANGE_STATUS) on every relay transition, and wakes the control
+     *                 task on new samples (CHANGE_SENSORS), new targets (CHANGE_TARGETS) and clock
+     *                 corrections (CHANGE_TIME).
+     * @param historyMgr Optional; receives the daily on-time/switch totals (checkpointed during the day).
+     * @param mqttMgr Optional; usage lines are published to <room>/actuators/usage with each checkpoint.
      */
     ActuatorManager(const GPIOControlConfig& config,
                     TargetDataManager& targetMgr,
                     SensorManager& sensorMgr,
-                    TimeService& timeSvc);
+                    TimeService& timeSvc,
+                    RuntimeSettings* settings = nullptr,
+                    ChangeNotifier* notifier = nullptr,
+                    DataHistoryManager* historyMgr = nullptr,
+                    MqttManager* mqttMgr = nullptr);
 
     /**
      * @brief Destroys the ActuatorManager instance.
@@ -57,16 +77,13 @@ public:
     bool initialize();
 
     /**
-     * @brief Starts the FreeRTOS tasks for controlling the light and humidifier.
+     * @brief Starts the single FreeRTOS task that drives every actuator in the table.
      * 
-     * @param lightTaskPriority Priority for the light control task.
-     * @param humidityTaskPriority Priority for the humidity control task.
-     * @param stackSize Stack size for each control task.
-     * @return true if both tasks were started successfully, false otherwise.
+     * @param priority Priority for the actuator control task.
+     * @param stackSize Stack size for the task (the daily usage checkpoint does LittleFS I/O here).
+     * @return true if the task was started successfully, false otherwise.
      */
-    bool startControlTasks(UBaseType_t lightTaskPriority = 1,
-                           UBaseType_t humidityTaskPriority = 1,
-                           uint32_t stackSize = 2560);
+    bool startControlTask(UBaseType_t priority = 1, uint32_t stackSize = 4096);
 
     /**
      * @brief Checks if the ActuatorManager has been successfully initialized.
@@ -88,60 +105,123 @@ public:
      */
     bool isHumidifierRelayOn() const;
 
+    /**
+     * @brief Checks if the actuator at the given table index is currently ON (pin read).
+     * @param index One of the ACTUATOR_* indices (or any index below getActuatorCount()).
+     * @return true if the relay is ON, false otherwise or if the index is out of range.
+     */
+    bool isActuatorOn(size_t index) const;
+
+    /**
+     * @brief Target the setpoint rule at the given index is currently using (the humidity derived
+     * from the VPD target in VPD mode). Updated in steps of TARGET_PUBLISH_STEP.
+     * @return NAN for schedule rules, before the first sample or if the index is out of range.
+     */
+    float getActuatorTarget(size_t index) const;
+
+    /**
+     * @brief Number of actuators in the descriptor table.
+     */
+    size_t getActuatorCount() const { return engine.count(); }
+
+    /**
+     * @brief Descriptor (name, pin, rule) of the actuator at the given table index.
+     */
+    const ActuatorDescriptor& getActuatorDescriptor(size_t index) const { return engine.descriptor(index); }
+
+    /**
+     * @brief On-time, switch counts and rolling duty cycles of the actuator at the given table index.
+     * Thread-safe; includes the interval still open at the time of the call.
+     * @return false if the index is out of range or the usage lock timed out.
+     */
+    bool getActuatorUsage(size_t index, ActuatorUsageSnapshot* out) const;
+
+    /**
+     * @brief Local day (YYYYMMDD) the "today" counters refer to; 0 until the clock is valid.
+     */
+    uint32_t getUsageDay() const { return usageDay.load(std::memory_order_acquire); }
+
+    static const uint32_t USAGE_CHECKPOINT_MS = 30UL * 60UL * 1000UL; ///< Daily totals saved/published this often.
+
+    static const size_t ACTUATOR_LIGHT = 0;      ///< Table index of the light (schedule rule).
+    static const size_t ACTUATOR_HUMIDIFIER = 1; ///< Table index of the humidifier (setpoint rule).
+    static const size_t ACTUATOR_IRRIGATION = 2; ///< Table index of the irrigation pump, when its pin is set.
+    static constexpr float TARGET_PUBLISH_STEP = 0.5f; ///< Derived target change that counts as a status change.
+    static const size_t MAX_ACTUATORS = 4;       ///< Table capacity.
+
+    /**
+     * @brief Counter bumped on every relay transition and on every published target step.
+     */
+    uint32_t getStateVersion() const { return stateVersion.load(std::memory_order_acquire); }
+
 private:
     /**
-     * @brief Checks current time against target light schedule and controls the light relay.
-     * @param lightOn The target time for lights to turn ON.
-     * @param lightOff The target time for lights to turn OFF.
-     * @param lightPin The GPIO pin connected to the light relay.
+     * @brief Fills the rule inputs: targets (one lock), clock and, when resample is set,
+     * the sensor readings.
+     * @param inputs Reused between passes (readings keep their last values when not resampled).
+     * @param resample True on a new sample/target event or when the fallback re-check is due.
      */
-    void checkAndControlLight(const struct tm& lightOn, const struct tm& lightOff, int lightPin);
+    void readInputs(ActuatorInputs& inputs, bool resample);
 
     /**
-     * @brief Checks current humidity against target humidity and controls the humidifier relay.
-     * @param currentHumidity The current humidity reading from sensors.
-     * @param targetHumidity The desired target humidity.
-     * @param humidityPin The GPIO pin connected to the humidifier relay.
+     * @brief Writes the pins whose engine output changed, logs them and notifies once
+     * (also when a derived target moved by TARGET_PUBLISH_STEP).
+     * @param changed Bitmask returned by ActuatorEngine::evaluate().
+     * @param inputs The inputs used in that pass (for logging).
      */
-    void checkAndControlHumidity(float currentHumidity, float targetHumidity, int humidityPin);
+    void applyOutputs(uint32_t changed, const ActuatorInputs& inputs);
 
     /**
-     * @brief Main loop for the light control task.
-     * Periodically calls checkAndControlLight.
+     * @brief Bumps the state version and notifies subscribers after a relay transition.
      */
-    void runLightControlTask();
+    void _onRelayChanged();
 
     /**
-     * @brief Main loop for the humidity control task.
-     * Periodically calls checkAndControlHumidity.
+     * @brief Day bookkeeping for the usage counters: resumes today's totals after a reboot,
+     * closes the day at local midnight and checkpoints the totals every USAGE_CHECKPOINT_MS.
+     * @return ms until the next midnight or checkpoint (the control task wakes for it).
      */
-    void runHumidityControlTask();
+    uint32_t _serviceUsage(const ActuatorInputs& inputs);
 
     /**
-     * @brief Static wrapper function for the light control FreeRTOS task.
-     * @param pvParameters Pointer to the ActuatorManager instance.
+     * @brief Stores the day record (history) and publishes one usage line per actuator (MQTT).
+     */
+    void _saveUsage(const ActuatorDailyUsage& record);
+
+    /**
+     * @brief Main loop for the actuator control task.
+     * Evaluates every rule in one pass when a new sample, new targets (ChangeNotifier) or a
+     * clock correction arrives, or when the engine's next deadline is reached (schedule
+     * transition, PID window edge, end of a minimum on/off time). humidityCheckIntervalMs
+     * is the fallback re-check when no event arrives.
      */
-    static void lightControlTaskWrapper(void* pvParameters);
+    void runControlTask();
 
     /**
-     * @brief Static wrapper function for the humidity control FreeRTOS task.
+     * @brief Static wrapper function for the actuator control FreeRTOS task.
      * @param pvParameters Pointer to the ActuatorManager instance.
      */
-    static void humidityControlTaskWrapper(void* pvParameters);
+    static void controlTaskWrapper(void* pvParameters);
 
     const GPIOControlConfig& gpioConfig;      ///< Configuration for GPIO pins.
     TargetDataManager& targetDataManager;   ///< Provides target values for control.
     SensorManager& sensorManager;           ///< Provides current sensor readings.
     TimeService& timeService;               ///< Provides current time.
+    RuntimeSettings* runtimeSettings;       ///< Fallback/clock-retry intervals (may be null).
+    ChangeNotifier* changeNotifier;         ///< Relay transitions out; samples, targets and clock in (may be null).
+    DataHistoryManager* dataHistoryManager; ///< Daily usage records (may be null).
+    MqttManager* mqttManager;               ///< Usage lines (may be null).
     
-    int lastLightState;                     ///< Last known state of the light relay (HIGH/LOW or -1 if unknown).
-    TaskHandle_t lightTaskHandle;           ///< Handle for the light control task.
-    TaskHandle_t humidityTaskHandle;        ///< Handle for the humidity control task.
+    ActuatorEngine<MAX_ACTUATORS> engine;   ///< Descriptor table + rule state (owned by the control task).
+    TaskHandle_t controlTaskHandle;         ///< Handle for the actuator control task.
     bool initialized;                       ///< Flag indicating if the manager is initialized.
+    std::atomic<uint32_t> stateVersion{0};  ///< See getStateVersion().
+    std::atomic<float> publishedTargets[MAX_ACTUATORS]; ///< See getActuatorTarget().
 
-    // Consider making these configurable or constants in a config file/namespace
-    static const TickType_t LIGHT_CHECK_INTERVAL_MS;    ///< Interval for checking light status.
-    static const TickType_t HUMIDITY_CHECK_INTERVAL_MS; ///< Interval for checking humidity status.
+    ActuatorUsageTracker usage[MAX_ACTUATORS]; ///< Written by the control task, read by the web server.
+    mutable FreeRTOSMutex usageMutex;       ///< Guards usage[].
+    std::atomic<uint32_t> usageDay{0};      ///< See getUsageDay().
+    uint32_t lastCheckpointMs;              ///< millis() of the last saved checkpoint (control task only).
 };
 
 } // namespace GrowController
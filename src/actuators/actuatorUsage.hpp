@@ -0,0 +1,166 @@
+// src/actuators/actuatorUsage.hpp
+#ifndef ACTUATOR_USAGE_HPP
+#define ACTUATOR_USAGE_HPP
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+namespace GrowController {
+
+/**
+ * @brief Contabilidade de um atuador num instante (ver ActuatorUsageTracker::snapshot()).
+ */
+struct ActuatorUsageSnapshot {
+    bool on = false;
+    uint32_t onForMs = 0;        ///< Há quanto tempo está no estado atual
+    uint64_t totalOnMs = 0;      ///< Tempo ligado desde o boot
+    uint32_t totalSwitches = 0;  ///< Trocas desde o boot
+    uint32_t todayOnMs = 0;      ///< Tempo ligado no dia local corrente
+    uint32_t todaySwitches = 0;  ///< Trocas no dia local corrente
+    float duty1h = 0.0f;         ///< Fração ligada, média exponencial de ~1 h
+    float duty24h = 0.0f;        ///< Fração ligada, média exponencial de ~24 h
+};
+
+/**
+ * @brief Tempo ligado, trocas e duty cycle de um atuador, atualizados só nas transições.
+ *
+ * Cada onTransition() é O(1): acumula o intervalo que acabou no estado anterior e
+ * decai as médias exponenciais pelo tempo decorrido (d = s + (d - s)·e^(-dt/τ)), então
+ * não há amostragem periódica nem buffer por janela. snapshot() inclui o intervalo
+ * ainda aberto sem alterar o estado. Tempos em ms de millis(), com wraparound;
+ * intervalos acima de ~49 dias sem transição nem leitura se perdem no wraparound.
+ * Não é thread-safe: quem compartilha protege com mutex.
+ */
+class ActuatorUsageTracker {
+public:
+    static constexpr float SHORT_TAU_MS = 3600000.0f;  ///< Constante de tempo do duty1h
+    static constexpr float LONG_TAU_MS = 86400000.0f;  ///< Constante de tempo do duty24h
+
+    /**
+     * @brief Começa a contar a partir do estado inicial do pino (sem contar como troca).
+     */
+    void begin(bool on, uint32_t nowMs) {
+        *this = ActuatorUsageTracker();
+        on_ = on;
+        lastMs_ = nowMs;
+        sinceMs_ = nowMs;
+    }
+
+    void onTransition(bool on, uint32_t nowMs) {
+        _accrue(nowMs);
+        if (on == on_) return;
+        on_ = on;
+        sinceMs_ = nowMs;
+        totalSwitches_++;
+        todaySwitches_++;
+    }
+
+    ActuatorUsageSnapshot snapshot(uint32_t nowMs) const {
+        ActuatorUsageTracker copy = *this;
+        copy._accrue(nowMs);
+        ActuatorUsageSnapshot out;
+        out.on = copy.on_;
+        out.onForMs = nowMs - copy.sinceMs_;
+        out.totalOnMs = copy.totalOnMs_;
+        out.totalSwitches = copy.totalSwitches_;
+        out.todayOnMs = copy.todayOnMs_;
+        out.todaySwitches = copy.todaySwitches_;
+        out.duty1h = copy.duty1h_;
+        out.duty24h = copy.duty24h_;
+        return out;
+    }
+
+    /**
+     * @brief Fecha o dia: devolve os totais do dia (até nowMs) e zera os contadores diários.
+     */
+    void closeDay(uint32_t nowMs, uint32_t* onSeconds, uint32_t* switches) {
+        _accrue(nowMs);
+        if (onSeconds) *onSeconds = todayOnMs_ / 1000;
+        if (switches) *switches = todaySwitches_;
+        todayOnMs_ = 0;
+        todaySwitches_ = 0;
+    }
+
+    /**
+     * @brief Retoma os totais do dia gravados antes de um reboot (só se somam ao que já contou).
+     */
+    void seedToday(uint32_t onSeconds, uint32_t switches) {
+        todayOnMs_ += onSeconds * 1000;
+        todaySwitches_ += switches;
+    }
+
+private:
+    void _accrue(uint32_t nowMs) {
+        uint32_t dt = nowMs - lastMs_;
+        lastMs_ = nowMs;
+        if (dt == 0) return;
+        if (on_) {
+            totalOnMs_ += dt;
+            todayOnMs_ += dt;
+        }
+        float target = on_ ? 1.0f : 0.0f;
+        duty1h_ = target + (duty1h_ - target) * expf(-(float)dt / SHORT_TAU_MS);
+        duty24h_ = target + (duty24h_ - target) * expf(-(float)dt / LONG_TAU_MS);
+    }
+
+    bool on_ = false;
+    uint32_t lastMs_ = 0;   // Até onde já foi acumulado
+    uint32_t sinceMs_ = 0;  // Última troca (ou begin)
+    uint64_t totalOnMs_ = 0;
+    uint32_t totalSwitches_ = 0;
+    uint32_t todayOnMs_ = 0;
+    uint32_t todaySwitches_ = 0;
+    float duty1h_ = 0.0f;
+    float duty24h_ = 0.0f;
+};
+
+/**
+ * @brief Data local AAAAMMDD de um epoch (chave dos registros diários).
+ */
+inline uint32_t localDayKey(time_t epoch) {
+    struct tm local;
+    localtime_r(&epoch, &local);
+    return (uint32_t)(local.tm_year + 1900) * 10000 + (uint32_t)(local.tm_mon + 1) * 100 + (uint32_t)local.tm_mday;
+}
+
+/**
+ * @brief Próxima meia-noite local estritamente depois de now (respeita horário de verão via mktime).
+ */
+inline time_t nextLocalMidnight(time_t now) {
+    struct tm local;
+    localtime_r(&now, &local);
+    struct tm midnight = {};
+    midnight.tm_year = local.tm_year;
+    midnight.tm_mon = local.tm_mon;
+    midnight.tm_mday = local.tm_mday + 1;
+    midnight.tm_isdst = -1;
+    return mktime(&midnight);
+}
+
+/**
+ * @brief Energia estimada em Wh a partir do tempo ligado e da potência nominal da carga.
+ */
+inline float energyWh(uint32_t onSeconds, float ratedWatts) {
+    return ratedWatts > 0.0f ? ratedWatts * (float)onSeconds / 3600.0f : 0.0f;
+}
+
+/**
+ * @brief Linha de uso publicada em <room>/actuators/usage (cabe na outbox do MQTT):
+ * "<nome> <dia> <segundos ligado> <trocas> <Wh>", ex: "humidifier 20261018 7260 41 50.4".
+ * @return int Caracteres escritos (sem o terminador), ou -1 se não coube.
+ */
+inline int formatUsagePayload(char* out, size_t size, const char* name, uint32_t day, uint32_t onSeconds,
+                              uint32_t switches, float wh) {
+    int len = snprintf(out, size, "%s %lu %lu %lu %.1f", name, (unsigned long)day, (unsigned long)onSeconds,
+                       (unsigned long)switches, wh);
+    if (len < 0 || (size_t)len >= size) {
+        return -1;
+    }
+    return len;
+}
+
+} // namespace GrowController
+
+#endif // ACTUATOR_USAGE_HPP
@@ -0,0 +1,61 @@
+// src/actuators/controlSchedule.hpp
+#ifndef CONTROL_SCHEDULE_HPP
+#define CONTROL_SCHEDULE_HPP
+
+#include <math.h>
+#include <stdint.h>
+
+namespace GrowController {
+
+/**
+ * @brief Decisão liga/desliga do umidificador.
+ * Leitura ou alvo inválido desliga, por segurança.
+ */
+inline bool humidifierShouldRun(float currentHumidity, float targetHumidity) {
+    if (isnan(currentHumidity) || isnan(targetHumidity) || targetHumidity <= 0.0f) {
+        return false;
+    }
+    return currentHumidity < targetHumidity;
+}
+
+/**
+ * @brief Agenda de um laço de controle dirigido a eventos.
+ *
+ * O laço avalia assim que é notificado (amostra nova ou alvo novo); o intervalo
+ * configurado vira só a reavaliação de segurança para quando nenhum evento chega
+ * (sensor travado, notificador ausente). Tempos em ms de millis(), com wraparound.
+ */
+class EventDrivenSchedule {
+public:
+    /**
+     * @brief Quanto esperar, a partir de nowMs, até a próxima avaliação de segurança (0 = já venceu).
+     */
+    uint32_t waitMs(uint32_t nowMs, uint32_t fallbackIntervalMs) const {
+        if (!hasRun_) {
+            return 0;
+        }
+        uint32_t elapsed = nowMs - lastRunMs_;
+        return elapsed >= fallbackIntervalMs ? 0 : fallbackIntervalMs - elapsed;
+    }
+
+    /**
+     * @brief true se o laço deve avaliar agora.
+     * @param notified A tarefa acordou por notificação (e não por timeout).
+     */
+    bool due(bool notified, uint32_t nowMs, uint32_t fallbackIntervalMs) const {
+        return notified || waitMs(nowMs, fallbackIntervalMs) == 0;
+    }
+
+    void markRun(uint32_t nowMs) {
+        lastRunMs_ = nowMs;
+        hasRun_ = true;
+    }
+
+private:
+    uint32_t lastRunMs_ = 0;
+    bool hasRun_ = false;
+};
+
+} // namespace GrowController
+
+#endif // CONTROL_SCHEDULE_HPP
@@ -0,0 +1,227 @@
+// src/actuators/humidityController.hpp
+#ifndef HUMIDITY_CONTROLLER_HPP
+#define HUMIDITY_CONTROLLER_HPP
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "controlSchedule.hpp" // humidifierShouldRun (modo OnOff)
+
+namespace GrowController {
+
+/**
+ * @brief Estratégia de controle do relé do umidificador.
+ */
+enum class HumidityControlMode : uint8_t {
+    OnOff = 0,      ///< Liga abaixo do alvo, desliga no alvo (comportamento original)
+    Hysteresis = 1, ///< Banda em torno do alvo + tempos mínimos ligado/desligado
+    Pid = 2,        ///< PID com saída em tempo proporcional (duty dentro de uma janela)
+};
+
+/**
+ * @brief Parâmetros do controle de umidade (configurados via TargetDataManager).
+ */
+struct HumidityControlParams {
+    HumidityControlMode mode = HumidityControlMode::Hysteresis;
+    float band = 2.0f;          ///< %UR, largura total: liga abaixo de alvo - band/2, desliga acima de alvo + band/2
+    uint32_t minOnMs = 30000;   ///< Tempo mínimo ligado (Hysteresis e Pid)
+    uint32_t minOffMs = 60000;  ///< Tempo mínimo desligado (Hysteresis e Pid)
+    float kp = 0.15f;           ///< Duty por %UR de erro
+    float ki = 0.0005f;         ///< Duty por %UR·s
+    float kd = 0.0f;            ///< Duty por %UR/s (derivada da medida, não do erro)
+    uint32_t windowMs = 300000; ///< Janela do tempo proporcional (Pid)
+
+    bool operator==(const HumidityControlParams& other) const {
+        return mode == other.mode && band == other.band && minOnMs == other.minOnMs &&
+               minOffMs == other.minOffMs && kp == other.kp && ki == other.ki && kd == other.kd &&
+               windowMs == other.windowMs;
+    }
+    bool operator!=(const HumidityControlParams& other) const { return !(*this == other); }
+};
+
+inline const char* humidityControlModeName(HumidityControlMode mode) {
+    switch (mode) {
+        case HumidityControlMode::OnOff:      return "onoff";
+        case HumidityControlMode::Hysteresis: return "hysteresis";
+        case HumidityControlMode::Pid:        return "pid";
+    }
+    return "onoff";
+}
+
+inline bool parseHumidityControlMode(const char* name, HumidityControlMode* out) {
+    if (name == nullptr) return false;
+    if (strcmp(name, "onoff") == 0) { *out = HumidityControlMode::OnOff; return true; }
+    if (strcmp(name, "hysteresis") == 0) { *out = HumidityControlMode::Hysteresis; return true; }
+    if (strcmp(name, "pid") == 0) { *out = HumidityControlMode::Pid; return true; }
+    return false;
+}
+
+/**
+ * @brief Limites aceitos: recusa configurações que prenderiam o relé ou o desgastariam.
+ */
+inline bool humidityControlParamsValid(const HumidityControlParams& params) {
+    const uint32_t maxHoldMs = 3600000;
+    if (!(params.band >= 0.0f && params.band <= 20.0f)) return false;
+    if (!(params.kp >= 0.0f && params.kp <= 10.0f)) return false;
+    if (!(params.ki >= 0.0f && params.ki <= 1.0f)) return false;
+    if (!(params.kd >= 0.0f && params.kd <= 100.0f)) return false;
+    if (params.minOnMs > maxHoldMs || params.minOffMs > maxHoldMs) return false;
+    if (params.windowMs < 10000 || params.windowMs > maxHoldMs) return false;
+    return true;
+}
+
+/**
+ * @brief Controlador do umidificador: decide o estado do relé a partir das amostras.
+ *
+ * onSample() recebe cada leitura nova (ou alvo novo) e recalcula a demanda;
+ * relayState() diz o estado do relé em um instante, aplicando tempos mínimos e a
+ * janela do PID; msUntilNextChange() diz quando relayState() pode mudar sem
+ * amostra nova, para a tarefa dormir até lá. Leitura/alvo inválido desliga na hora,
+ * ignorando o tempo mínimo ligado. Tempos em ms de millis(), com wraparound.
+ * Não é thread-safe: pertence à tarefa de umidade.
+ */
+class HumidityController {
+public:
+    static const uint32_t NO_CHANGE = 0xFFFFFFFFu;
+
+    explicit HumidityController(const HumidityControlParams& params = HumidityControlParams()) : params_(params) {}
+
+    /**
+     * @brief Aplica novos parâmetros; mudar de modo ou de janela reinicia o estado do PID.
+     */
+    void configure(const HumidityControlParams& params) {
+        if (params == params_) return;
+        if (params.mode != params_.mode || params.windowMs != params_.windowMs) {
+            _resetPid();
+        }
+        params_ = params;
+    }
+
+    void onSample(float currentHumidity, float targetHumidity, uint32_t nowMs) {
+        if (isnan(currentHumidity) || isnan(targetHumidity) || targetHumidity <= 0.0f) {
+            demand_ = false;
+            safetyOff_ = true;
+            _resetPid();
+            return;
+        }
+        safetyOff_ = false;
+        switch (params_.mode) {
+            case HumidityControlMode::OnOff:
+                demand_ = humidifierShouldRun(currentHumidity, targetHumidity);
+                break;
+            case HumidityControlMode::Hysteresis: {
+                float half = params_.band * 0.5f;
+                if (currentHumidity < targetHumidity - half) demand_ = true;
+                else if (currentHumidity > targetHumidity + half) demand_ = false;
+                // Dentro da banda: mantém a demanda anterior
+                break;
+            }
+            case HumidityControlMode::Pid:
+                _updatePid(currentHumidity, targetHumidity, nowMs);
+                break;
+        }
+    }
+
+    /**
+     * @brief Estado do relé em nowMs (já respeitando tempos mínimos). Chame depois de onSample().
+     */
+    bool relayState(uint32_t nowMs) {
+        bool desired = params_.mode == HumidityControlMode::Pid && !safetyOff_ ? _pidWindowOn(nowMs) : demand_;
+        if (desired != relayOn_ && (safetyOff_ || _holdRemaining(nowMs) == 0)) {
+            relayOn_ = desired;
+            lastSwitchMs_ = nowMs;
+            hasSwitched_ = true;
+            switches_++;
+        }
+        return relayOn_;
+    }
+
+    /**
+     * @brief ms até relayState() poder mudar sem amostra nova (NO_CHANGE = só com amostra).
+     */
+    uint32_t msUntilNextChange(uint32_t nowMs) const {
+        uint32_t hold = _holdRemaining(nowMs);
+        if (params_.mode == HumidityControlMode::Pid && !safetyOff_ && pidStarted_) {
+            uint32_t elapsed = (nowMs - windowStartMs_) % params_.windowMs;
+            uint32_t onMs = _pidOnMs();
+            uint32_t edge = elapsed < onMs ? onMs - elapsed : params_.windowMs - elapsed;
+            return hold > edge ? hold : edge;
+        }
+        return demand_ == relayOn_ ? NO_CHANGE : hold;
+    }
+
+    float duty() const { return params_.mode == HumidityControlMode::Pid ? duty_ : (relayOn_ ? 1.0f : 0.0f); }
+    uint32_t switchCount() const { return switches_; }
+    const HumidityControlParams& params() const { return params_; }
+
+private:
+    void _resetPid() {
+        integral_ = 0.0f;
+        duty_ = 0.0f;
+        pidStarted_ = false;
+    }
+
+    void _updatePid(float current, float target, uint32_t nowMs) {
+        float error = target - current; // Positivo: falta umidade, liga
+        float dt = 0.0f;
+        float derivative = 0.0f;
+        if (pidStarted_) {
+            dt = (nowMs - lastSampleMs_) / 1000.0f;
+            if (dt > 0.0f) derivative = -params_.kd * (current - lastMeasurement_) / dt;
+        } else {
+            windowStartMs_ = nowMs;
+            pidStarted_ = true;
+        }
+        float proportional = params_.kp * error;
+        float integral = integral_ + params_.ki * error * dt;
+        float output = proportional + integral + derivative;
+        // Anti-windup: não integra enquanto a saída está saturada no sentido do erro
+        if ((output > 1.0f && error > 0.0f) || (output < 0.0f && error < 0.0f)) {
+            integral = integral_;
+            output = proportional + integral + derivative;
+        }
+        integral_ = integral < 0.0f ? 0.0f : (integral > 1.0f ? 1.0f : integral);
+        duty_ = output < 0.0f ? 0.0f : (output > 1.0f ? 1.0f : output);
+        lastMeasurement_ = current;
+        lastSampleMs_ = nowMs;
+    }
+
+    /// Tempo ligado dentro da janela; pulsos menores que os tempos mínimos viram 0 ou a janela toda.
+    uint32_t _pidOnMs() const {
+        uint32_t onMs = (uint32_t)(duty_ * params_.windowMs);
+        if (onMs < params_.minOnMs) return 0;
+        if (params_.windowMs - onMs < params_.minOffMs) return params_.windowMs;
+        return onMs;
+    }
+
+    bool _pidWindowOn(uint32_t nowMs) const {
+        if (!pidStarted_) return false;
+        return (nowMs - windowStartMs_) % params_.windowMs < _pidOnMs();
+    }
+
+    uint32_t _holdRemaining(uint32_t nowMs) const {
+        if (!hasSwitched_ || params_.mode == HumidityControlMode::OnOff) return 0;
+        uint32_t hold = relayOn_ ? params_.minOnMs : params_.minOffMs;
+        uint32_t elapsed = nowMs - lastSwitchMs_;
+        return elapsed >= hold ? 0 : hold - elapsed;
+    }
+
+    HumidityControlParams params_;
+    bool demand_ = false;
+    bool safetyOff_ = true;
+    bool relayOn_ = false;
+    bool hasSwitched_ = false;
+    uint32_t lastSwitchMs_ = 0;
+    uint32_t switches_ = 0;
+    // PID
+    bool pidStarted_ = false;
+    float integral_ = 0.0f;
+    float duty_ = 0.0f;
+    float lastMeasurement_ = 0.0f;
+    uint32_t lastSampleMs_ = 0;
+    uint32_t windowStartMs_ = 0;
+};
+
+} // namespace GrowController
+
+#endif // HUMIDITY_CONTROLLER_HPP
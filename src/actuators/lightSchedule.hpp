@@ -0,0 +1,67 @@
+// src/actuators/lightSchedule.hpp
+#ifndef LIGHT_SCHEDULE_HPP
+#define LIGHT_SCHEDULE_HPP
+
+#include <time.h>
+
+namespace GrowController {
+
+/**
+ * @brief A luz deve estar ligada neste minuto do dia?
+ * on == off significa sempre desligada; on > off atravessa a meia-noite.
+ */
+inline bool lightShouldBeOn(int nowMinutes, int onMinutes, int offMinutes) {
+    if (onMinutes == offMinutes) {
+        return false;
+    }
+    if (onMinutes < offMinutes) { // Horário diurno
+        return nowMinutes >= onMinutes && nowMinutes < offMinutes;
+    }
+    return nowMinutes >= onMinutes || nowMinutes < offMinutes; // Horário noturno
+}
+
+struct LightTransition {
+    time_t at;    ///< Instante (epoch) da próxima troca; 0 = nunca (on == off)
+    bool turnsOn; ///< Estado da luz a partir de at
+};
+
+/**
+ * @brief Próxima troca de estado da luz estritamente depois de now.
+ *
+ * Os horários são locais (tm_hour/tm_min); cada candidato (hoje, amanhã, depois de amanhã)
+ * passa por mktime com tm_isdst = -1, então o fuso e o horário de verão vigentes em
+ * cada dia são respeitados. Um horário que não existe no dia da mudança de horário
+ * (ex: 02:30 quando o relógio pula de 02:00 para 03:00) é normalizado pelo mktime
+ * para o instante equivalente logo depois do salto.
+ */
+inline LightTransition nextLightTransition(time_t now, const struct tm& lightOn, const struct tm& lightOff) {
+    LightTransition next = {0, false};
+    if (lightOn.tm_hour == lightOff.tm_hour && lightOn.tm_min == lightOff.tm_min) {
+        return next;
+    }
+    struct tm today;
+    localtime_r(&now, &today);
+    for (int day = 0; day <= 2; ++day) {
+        for (int which = 0; which < 2; ++which) {
+            const struct tm& target = which == 0 ? lightOn : lightOff;
+            struct tm candidate = {};
+            candidate.tm_year = today.tm_year;
+            candidate.tm_mon = today.tm_mon;
+            candidate.tm_mday = today.tm_mday + day;
+            candidate.tm_hour = target.tm_hour;
+            candidate.tm_min = target.tm_min;
+            candidate.tm_sec = 0;
+            candidate.tm_isdst = -1;
+            time_t at = mktime(&candidate);
+            if (at > now && (next.at == 0 || at < next.at)) {
+                next.at = at;
+                next.turnsOn = which == 0;
+            }
+        }
+    }
+    return next;
+}
+
+} // namespace GrowController
+
+#endif // LIGHT_SCHEDULE_HPP
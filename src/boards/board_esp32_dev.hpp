@@ -6,6 +6,7 @@
 // Pinos de Controle GPIO (Atuadores)
 #define GPIO_HUMIDITY_PIN 2  // Pino para controlar umidificador/ventilador
 #define GPIO_LIGHT_PIN 5     // Pino para controlar a iluminação
+#define GPIO_IRRIGATION_PIN 19 // Pino para controlar a bomba de irrigação
 
 // Pinos de Sensores
 #define DHT_PIN 4            // Pino de dados do sensor DHT22
@@ -8,6 +8,7 @@
 //       Pinos como D0, D1 podem ter restrições. D4, D5 são geralmente seguros.
 #define GPIO_HUMIDITY_PIN 0 // (Antigo D0 - verificar se é adequado)
 #define GPIO_LIGHT_PIN 4    // (D4)
+#define GPIO_IRRIGATION_PIN 3 // (D1) Bomba de irrigação (verificar se é adequado)
 
 // Pinos de Sensores
 #define DHT_PIN 10           // (D10) Pino de dados do sensor DHT22
@@ -61,16 +61,48 @@
         const char *password = WIFI_PASSWORD;
     };
 
+// QoS das leituras de sensor (0 ou 1). Pode ser sobrescrito via build_flags.
+#ifndef MQTT_TELEMETRY_QOS
+#define MQTT_TELEMETRY_QOS 1
+#endif
+
+// Codificação do payload das leituras: 0 = texto "%.2f", 1 = CBOR, 2 = struct binária (ver telemetryCodec.hpp)
+#ifndef MQTT_TELEMETRY_CODEC
+#define MQTT_TELEMETRY_CODEC 0
+#endif
+
 struct MQTTConfig {
     const char* server = MQTT_SERVER; 
     int port = MQTT_PORT;             
     const char* clientId = MQTT_CLIENT_ID;
     const char* roomTopic = MQTT_ROOM_TOPIC;
+    uint8_t telemetryQos = MQTT_TELEMETRY_QOS;
+    uint8_t telemetryCodec = MQTT_TELEMETRY_CODEC;
 };
 
+// Potência nominal das cargas (W), só para a estimativa de energia. Ajuste via build_flags.
+#ifndef ACTUATOR_LIGHT_WATTS
+#define ACTUATOR_LIGHT_WATTS 100.0f
+#endif
+#ifndef ACTUATOR_HUMIDIFIER_WATTS
+#define ACTUATOR_HUMIDIFIER_WATTS 25.0f
+#endif
+#ifndef ACTUATOR_IRRIGATION_WATTS
+#define ACTUATOR_IRRIGATION_WATTS 15.0f
+#endif
+
+// Placas sem bomba de irrigação: -1 tira a linha da tabela de atuadores
+#ifndef GPIO_IRRIGATION_PIN
+#define GPIO_IRRIGATION_PIN -1
+#endif
+
 struct GPIOControlConfig {
     int humidityControlPin = GPIO_HUMIDITY_PIN;
     int lightControlPin = GPIO_LIGHT_PIN;
+    int irrigationControlPin = GPIO_IRRIGATION_PIN; // -1 = sem irrigação
+    float humidityLoadWatts = ACTUATOR_HUMIDIFIER_WATTS;
+    float lightLoadWatts = ACTUATOR_LIGHT_WATTS;
+    float irrigationLoadWatts = ACTUATOR_IRRIGATION_WATTS;
 };
 
 struct TimeConfig {
@@ -0,0 +1,26 @@
+// src/data/actuatorDailyUsage.hpp
+#ifndef ACTUATOR_DAILY_USAGE_HPP
+#define ACTUATOR_DAILY_USAGE_HPP
+
+#include <stdint.h> // Para uint32_t
+#include <stddef.h> // Para size_t
+
+namespace GrowController {
+
+static const size_t ACTUATOR_USAGE_SLOTS = 4; // Atuadores por registro (índices da tabela do ActuatorManager)
+
+/**
+ * @brief Totais de um dia local por atuador (um registro por dia no DataHistoryManager).
+ * Os nomes não são gravados: o índice é a posição na tabela de atuadores do firmware.
+ */
+struct ActuatorDailyUsage {
+    uint32_t day;                                 // Data local AAAAMMDD; 0 = slot vazio
+    uint8_t count;                                // Atuadores válidos em onSeconds/switches
+    uint8_t reserved[3];
+    uint32_t onSeconds[ACTUATOR_USAGE_SLOTS];     // Tempo ligado no dia
+    uint16_t switches[ACTUATOR_USAGE_SLOTS];      // Trocas de estado no dia
+};
+
+} // namespace GrowController
+
+#endif // ACTUATOR_DAILY_USAGE_HPP
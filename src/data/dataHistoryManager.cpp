@@ -1,18 +1,22 @@
 // src/data/dataHistoryManager.cpp
 #include "dataHistoryManager.hpp"
+#include "utils/metrics.hpp"
 #include <algorithm> // Para std::sort (se a ordenação explícita fosse necessária)
 
 namespace GrowController {
 
 // Definição das constantes estáticas
 const char* DataHistoryManager::LOG_FILE_NAME = "/sensor_log.dat";
+const char* DataHistoryManager::USAGE_FILE_NAME = "/actuator_usage.dat";
 const char* DataHistoryManager::NVS_KEY_NEXT_INDEX = "hist_next_idx";
 const char* DataHistoryManager::NVS_KEY_RECORD_COUNT = "hist_rec_cnt";
+const char* DataHistoryManager::NVS_KEY_CURSOR = "hist_cursor";
 // MAX_RECORDS já é definido no .hpp
 
 DataHistoryManager::DataHistoryManager() :
     nextWriteIndex(0),
     recordCount(0),
+    latestCursor(0),
     initializedState(false),
     nvsNamespace(nullptr)
     // dataMutex é inicializado automaticamente pelo seu construtor
@@ -87,13 +91,20 @@ bool DataHistoryManager::initialize(const char* nvs_name) {
             Logger::warn("DataHistoryManager: Invalid recordCount (%u) from NVS. Resetting to 0.", recordCount);
             recordCount = 0;
         }
+        // Firmware antigo não tinha cursor: numera os registros existentes a partir de 1
+        latestCursor = preferences.getUInt(NVS_KEY_CURSOR, recordCount);
+        if (latestCursor < recordCount) {
+            latestCursor = recordCount;
+        }
         preferences.end(); // Fechar NVS após leitura inicial
 
         initializedState = true;
-        Logger::info("DataHistoryManager: Initialized. NextWriteIndex: %u, RecordCount: %u", nextWriteIndex, recordCount);
+        Logger::info("DataHistoryManager: Initialized. NextWriteIndex: %u, RecordCount: %u, Cursor: %lu",
+                     nextWriteIndex, recordCount, (unsigned long)latestCursor);
         xSemaphoreGive(dataMutex.get());
         return true;
     } else {
+        Metrics::mutexTimeoutsHistory.inc();
         Logger::error("DataHistoryManager: Timed out acquiring mutex for initialization.");
         return false;
     }
@@ -106,6 +117,7 @@ bool DataHistoryManager::addDataPoint(const HistoricDataPoint& dataPoint) {
     }
 
     if (xSemaphoreTake(dataMutex.get(), MUTEX_TIMEOUT_MS) != pdTRUE) {
+        Metrics::mutexTimeoutsHistory.inc();
         Logger::error("DataHistoryManager: Timed out acquiring mutex for addDataPoint.");
         return false;
     }
@@ -149,12 +161,14 @@ bool DataHistoryManager::addDataPoint(const HistoricDataPoint& dataPoint) {
     if (recordCount < MAX_RECORDS) {
         recordCount++;
     }
+    latestCursor++;
 
     // Salvar os novos índices na NVS
     bool nvsOk = false;
     if (preferences.begin(this->nvsNamespace, false)) {
         if (preferences.putUChar(NVS_KEY_NEXT_INDEX, nextWriteIndex) &&
-            preferences.putUChar(NVS_KEY_RECORD_COUNT, recordCount)) {
+            preferences.putUChar(NVS_KEY_RECORD_COUNT, recordCount) &&
+            preferences.putUInt(NVS_KEY_CURSOR, latestCursor)) {
             nvsOk = true;
         } else {
             Logger::error("DataHistoryManager: Failed to save one or both indices to NVS.");
@@ -201,6 +215,7 @@ std::vector<HistoricDataPoint> DataHistoryManager::getAllDataPointsSorted() {
         localRecordCount = this->recordCount;
         xSemaphoreGive(dataMutex.get());
     } else {
+        Metrics::mutexTimeoutsHistory.inc();
         Logger::error("DataHistoryManager: Timed out acquiring mutex for getAllDataPointsSorted (index read).");
         return points;
     }
@@ -270,6 +285,171 @@ std::vector<HistoricDataPoint> DataHistoryManager::getAllDataPointsSorted() {
     return points;
 }
 
+size_t DataHistoryManager::readSince(uint32_t since, HistoricDataPoint* out, size_t maxCount,
+                                     uint32_t* lastCursor, HistoryWindow* window) {
+    if (lastCursor) *lastCursor = since;
+    if (!initializedState || out == nullptr || maxCount == 0) {
+        return 0;
+    }
+
+    uint8_t localNextWriteIndex;
+    uint8_t localRecordCount;
+    uint32_t localCursor;
+    if (xSemaphoreTake(dataMutex.get(), MUTEX_TIMEOUT_MS) == pdTRUE) {
+        localNextWriteIndex = this->nextWriteIndex;
+        localRecordCount = this->recordCount;
+        localCursor = this->latestCursor;
+        xSemaphoreGive(dataMutex.get());
+    } else {
+        Metrics::mutexTimeoutsHistory.inc();
+        Logger::error("DataHistoryManager: Timed out acquiring mutex for readSince (index read).");
+        return 0;
+    }
+
+    HistoryWindow range = historyWindowSince(since, localCursor, localRecordCount);
+    if (window) *window = range;
+    if (range.count == 0) {
+        if (lastCursor && range.reset) *lastCursor = 0;
+        return 0;
+    }
+
+    File file = LittleFS.open(LOG_FILE_NAME, "r");
+    if (!file) {
+        Logger::error("DataHistoryManager: Failed to open log file '%s' for reading.", LOG_FILE_NAME);
+        return 0;
+    }
+
+    uint8_t oldestIndex = (localRecordCount < MAX_RECORDS) ? 0 : localNextWriteIndex;
+    size_t copied = 0;
+    while (copied < range.count && copied < maxCount) {
+        uint8_t actualFileIndex = (oldestIndex + range.offset + copied) % MAX_RECORDS;
+        if (!file.seek((size_t)actualFileIndex * sizeof(HistoricDataPoint)) ||
+            file.read((uint8_t *)&out[copied], sizeof(HistoricDataPoint)) != sizeof(HistoricDataPoint)) {
+            Logger::error("DataHistoryManager: Failed to read record at actual file index %u.", actualFileIndex);
+            break;
+        }
+        copied++;
+    }
+    file.close();
+
+    if (lastCursor) *lastCursor = copied > 0 ? range.firstCursor + (uint32_t)copied - 1 : since;
+    return copied;
+}
+
+// Arquivo de uso: MAX_USAGE_DAYS slots de ActuatorDailyUsage, sem índice na NVS.
+// O dia (AAAAMMDD) de cada slot já diz a ordem; um slot vazio ou além do fim do arquivo tem day = 0.
+bool DataHistoryManager::putDailyUsage(const ActuatorDailyUsage& usage) {
+    if (!initializedState || usage.day == 0) {
+        return false;
+    }
+    if (xSemaphoreTake(dataMutex.get(), MUTEX_TIMEOUT_MS) != pdTRUE) {
+        Metrics::mutexTimeoutsHistory.inc();
+        Logger::error("DataHistoryManager: Timed out acquiring mutex for putDailyUsage.");
+        return false;
+    }
+
+    File file = LittleFS.open(USAGE_FILE_NAME, LittleFS.exists(USAGE_FILE_NAME) ? "r+" : "w+");
+    if (!file) {
+        Logger::error("DataHistoryManager: Failed to open usage file '%s'.", USAGE_FILE_NAME);
+        xSemaphoreGive(dataMutex.get());
+        return false;
+    }
+
+    // Mesmo dia: sobrescreve; senão o primeiro slot vazio; senão o dia mais antigo
+    size_t slots = file.size() / sizeof(ActuatorDailyUsage);
+    int target = -1;
+    int emptySlot = slots < (size_t)MAX_USAGE_DAYS ? (int)slots : -1;
+    int oldestSlot = 0;
+    uint32_t oldestDay = UINT32_MAX;
+    ActuatorDailyUsage current;
+    for (size_t i = 0; i < slots && i < (size_t)MAX_USAGE_DAYS; ++i) {
+        if (!file.seek(i * sizeof(ActuatorDailyUsage)) ||
+            file.read((uint8_t*)&current, sizeof(current)) != sizeof(current)) {
+            break;
+        }
+        if (current.day == usage.day) {
+            target = (int)i;
+            break;
+        }
+        if (current.day == 0 && emptySlot < 0) {
+            emptySlot = (int)i;
+        }
+        if (current.day != 0 && current.day < oldestDay) {
+            oldestDay = current.day;
+            oldestSlot = (int)i;
+        }
+    }
+    if (target < 0) {
+        target = emptySlot >= 0 ? emptySlot : oldestSlot;
+    }
+
+    bool ok = file.seek((size_t)target * sizeof(ActuatorDailyUsage)) &&
+              file.write((const uint8_t*)&usage, sizeof(usage)) == sizeof(usage);
+    file.flush();
+    file.close();
+    if (!ok) {
+        Logger::error("DataHistoryManager: Failed to write usage record for day %lu.", (unsigned long)usage.day);
+    }
+    xSemaphoreGive(dataMutex.get());
+    return ok;
+}
+
+size_t DataHistoryManager::readDailyUsage(ActuatorDailyUsage* out, size_t maxCount) {
+    if (!initializedState || out == nullptr || maxCount == 0) {
+        return 0;
+    }
+    if (xSemaphoreTake(dataMutex.get(), MUTEX_TIMEOUT_MS) != pdTRUE) {
+        Metrics::mutexTimeoutsHistory.inc();
+        Logger::error("DataHistoryManager: Timed out acquiring mutex for readDailyUsage.");
+        return 0;
+    }
+    File file = LittleFS.open(USAGE_FILE_NAME, "r");
+    if (!file) {
+        xSemaphoreGive(dataMutex.get()); // Nenhum dia gravado ainda
+        return 0;
+    }
+
+    // Inserção ordenada direto no buffer do chamador, mantendo só os maxCount mais recentes
+    size_t copied = 0;
+    ActuatorDailyUsage current;
+    for (int i = 0; i < MAX_USAGE_DAYS; ++i) {
+        if (!file.seek((size_t)i * sizeof(ActuatorDailyUsage)) ||
+            file.read((uint8_t*)&current, sizeof(current)) != sizeof(current)) {
+            break;
+        }
+        if (current.day == 0 || (copied == maxCount && current.day <= out[0].day)) {
+            continue;
+        }
+        size_t pos = copied;
+        if (copied == maxCount) {
+            // Cheio: descarta o mais antigo (out[0]) abrindo espaço no fim
+            for (size_t j = 1; j < copied; ++j) out[j - 1] = out[j];
+            pos = copied - 1;
+        } else {
+            copied++;
+        }
+        while (pos > 0 && out[pos - 1].day > current.day) {
+            out[pos] = out[pos - 1];
+            pos--;
+        }
+        out[pos] = current;
+    }
+    file.close();
+    xSemaphoreGive(dataMutex.get());
+    return copied;
+}
+
+uint32_t DataHistoryManager::getCursor() const {
+    uint32_t cursor = 0;
+    if (xSemaphoreTake(dataMutex.get(), MUTEX_TIMEOUT_MS) == pdTRUE) {
+        cursor = latestCursor;
+        xSemaphoreGive(dataMutex.get());
+    } else {
+        Metrics::mutexTimeoutsHistory.inc();
+    }
+    return cursor;
+}
+
 size_t DataHistoryManager::getRecordCount() const {
     size_t count = 0;
     if (xSemaphoreTake(dataMutex.get(), MUTEX_TIMEOUT_MS) == pdTRUE) {
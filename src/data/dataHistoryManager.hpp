@@ -3,6 +3,8 @@
 #define DATA_HISTORY_MANAGER_HPP
 
 #include "historicDataPoint.hpp"
+#include "actuatorDailyUsage.hpp"
+#include "historyCursor.hpp"
 #include <LittleFS.h>
 #include <Preferences.h>
 #include <vector>
@@ -23,18 +25,51 @@ public:
     bool initialize(const char* nvs_namespace = "history_mgr");
     bool addDataPoint(const HistoricDataPoint& dataPoint);
     std::vector<HistoricDataPoint> getAllDataPointsSorted();
+
     size_t getRecordCount() const;
     uint8_t getNextWriteIndex() const;
 
+    /**
+     * @brief Cursor do registro mais recente (0 = nenhum). Cresce 1 por addDataPoint e sobrevive a reboots.
+     */
+    uint32_t getCursor() const;
+
+    /**
+     * @brief Lê, em ordem cronológica, até maxCount registros com cursor > since.
+     * Para continuar, chame de novo com since = *lastCursor.
+     * @param window Recebe a janela calculada (reset indica since à frente do histórico).
+     * @param lastCursor Recebe o cursor do último registro copiado (since se nenhum).
+     * @return size_t Número de registros copiados para out.
+     */
+    size_t readSince(uint32_t since, HistoricDataPoint* out, size_t maxCount,
+                     uint32_t* lastCursor, HistoryWindow* window = nullptr);
+
+    /**
+     * @brief Grava os totais diários dos atuadores: sobrescreve o registro do mesmo dia
+     * (checkpoints ao longo do dia) ou ocupa o slot do dia mais antigo.
+     */
+    bool putDailyUsage(const ActuatorDailyUsage& usage);
+
+    /**
+     * @brief Lê os maxCount dias mais recentes, em ordem cronológica.
+     * @return size_t Número de registros copiados para out.
+     */
+    size_t readDailyUsage(ActuatorDailyUsage* out, size_t maxCount);
+
+    static const int MAX_USAGE_DAYS = 31; ///< Dias guardados no arquivo de uso dos atuadores
+
 private:
     static const char* LOG_FILE_NAME;
+    static const char* USAGE_FILE_NAME;
     static const int MAX_RECORDS = 48;
     static const char* NVS_KEY_NEXT_INDEX;
     static const char* NVS_KEY_RECORD_COUNT;
+    static const char* NVS_KEY_CURSOR;
 
     Preferences preferences;
     uint8_t nextWriteIndex;
     uint8_t recordCount;
+    uint32_t latestCursor; // Ver getCursor()
     bool initializedState;
     const char* nvsNamespace;
 
@@ -0,0 +1,55 @@
+// src/data/historyCursor.hpp
+#ifndef HISTORY_CURSOR_HPP
+#define HISTORY_CURSOR_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace GrowController {
+
+/**
+ * @brief Cursor do histórico: número de sequência do registro (1, 2, 3...), persistido na NVS
+ * e nunca reutilizado. O buffer circular guarda os recordCount registros mais novos, cujos
+ * cursores vão de latest - recordCount + 1 até latest. Cursor 0 = "nada visto ainda".
+ */
+struct HistoryWindow {
+    uint32_t firstCursor; ///< Cursor do primeiro registro a enviar
+    uint32_t offset;      ///< Posição desse registro a partir do mais antigo guardado
+    uint32_t count;       ///< Registros a enviar
+    bool reset;           ///< O cliente está à frente (histórico apagado): deve descartar o que tem
+};
+
+/**
+ * @brief Calcula quais registros são mais novos que since.
+ * Se since ficou para trás do buffer circular, envia tudo o que ainda existe.
+ */
+inline HistoryWindow historyWindowSince(uint32_t since, uint32_t latest, uint32_t recordCount) {
+    HistoryWindow window = {0, 0, 0, false};
+    if (recordCount > latest) {
+        recordCount = latest; // Defensivo: NVS inconsistente
+    }
+    uint32_t oldest = latest - recordCount + 1;
+    if (since > latest) {
+        window.reset = true;
+        since = 0;
+    }
+    if (recordCount == 0 || since >= latest) {
+        window.firstCursor = latest + 1;
+        return window;
+    }
+    window.firstCursor = since + 1 > oldest ? since + 1 : oldest;
+    window.offset = window.firstCursor - oldest;
+    window.count = latest - window.firstCursor + 1;
+    return window;
+}
+
+/**
+ * @brief ETag da coleção de histórico: muda exatamente quando um registro é adicionado.
+ */
+inline int formatHistoryEtag(char* out, size_t size, uint32_t latest) {
+    return snprintf(out, size, "\"h%lu\"", (unsigned long)latest);
+}
+
+} // namespace GrowController
+
+#endif // HISTORY_CURSOR_HPP
@@ -0,0 +1,62 @@
+// src/data/runtimeRates.hpp
+#ifndef RUNTIME_RATES_HPP
+#define RUNTIME_RATES_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace GrowController {
+
+/**
+ * @brief Intervalos das tarefas ajustáveis em tempo de execução (MQTT <room>/config e /api/config).
+ * Os valores padrão são os que antes eram constantes de compilação.
+ */
+struct RuntimeRates {
+    uint32_t sensorReadIntervalMs = 10000;             ///< Leitura dos sensores (SensorManager)
+    uint32_t historySaveIntervalMs = 30UL * 60UL * 1000UL; ///< Média gravada no histórico
+    uint32_t mqttServiceIntervalMs = 1000;             ///< Espera máxima da tarefa MQTT sem eventos
+    uint32_t lightCheckIntervalMs = 5000;              ///< Nova tentativa da luz enquanto o relógio não está sincronizado
+    uint32_t humidityCheckIntervalMs = 10000;          ///< Reavaliação da umidade sem amostra/alvo novo
+};
+
+/**
+ * @brief Limites aceitos para cada campo de RuntimeRates.
+ */
+struct RuntimeRateField {
+    const char* key;  ///< Chave JSON
+    const char* nvsKey; ///< Chave NVS (máx. 15 caracteres)
+    uint32_t RuntimeRates::*member;
+    uint32_t minMs;
+    uint32_t maxMs;
+};
+
+// DHT22 não aceita leituras em menos de 2 s; keepalive MQTT é 15 s.
+static const RuntimeRateField RUNTIME_RATE_FIELDS[] = {
+    {"sensorReadIntervalMs",    "sensor_ms", &RuntimeRates::sensorReadIntervalMs,    2000,  3600000},
+    {"historySaveIntervalMs",   "save_ms",   &RuntimeRates::historySaveIntervalMs,   60000, 86400000},
+    {"mqttServiceIntervalMs",   "mqtt_ms",   &RuntimeRates::mqttServiceIntervalMs,   100,   10000},
+    {"lightCheckIntervalMs",    "light_ms",  &RuntimeRates::lightCheckIntervalMs,    1000,  600000},
+    {"humidityCheckIntervalMs", "humid_ms",  &RuntimeRates::humidityCheckIntervalMs, 1000,  600000},
+};
+static const size_t RUNTIME_RATE_FIELD_COUNT = sizeof(RUNTIME_RATE_FIELDS) / sizeof(RUNTIME_RATE_FIELDS[0]);
+
+/**
+ * @brief Valida todos os campos.
+ * @param invalidKey Recebe a chave JSON do primeiro campo fora dos limites (pode ser nullptr).
+ * @return true Se todos os campos estão dentro dos limites.
+ */
+inline bool validateRuntimeRates(const RuntimeRates& rates, const char** invalidKey = nullptr) {
+    for (size_t i = 0; i < RUNTIME_RATE_FIELD_COUNT; ++i) {
+        const RuntimeRateField& field = RUNTIME_RATE_FIELDS[i];
+        uint32_t value = rates.*(field.member);
+        if (value < field.minMs || value > field.maxMs) {
+            if (invalidKey) *invalidKey = field.key;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace GrowController
+
+#endif // RUNTIME_RATES_HPP
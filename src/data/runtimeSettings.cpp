@@ -0,0 +1,236 @@
+// src/data/runtimeSettings.cpp
+#include "runtimeSettings.hpp"
+#include <stdio.h>
+#include "utils/logger.hpp"
+#include "utils/metrics.hpp"
+
+namespace GrowController {
+
+const TickType_t RuntimeSettings::MUTEX_TIMEOUT = pdMS_TO_TICKS(100);
+const TickType_t RuntimeSettings::PERSIST_DEBOUNCE = pdMS_TO_TICKS(5000); // Grava 5 s após o último ajuste
+
+RuntimeSettings::RuntimeSettings() {}
+
+RuntimeSettings::~RuntimeSettings() {
+    if (persistTimer != nullptr) {
+        xTimerDelete(persistTimer, 0);
+        persistTimer = nullptr;
+    }
+}
+
+bool RuntimeSettings::initialize(const char* nvs_namespace) {
+    if (initialized) {
+        Logger::warn("RuntimeSettings: Already initialized.");
+        return true;
+    }
+    if (!settingsMutex) {
+        Logger::error("RuntimeSettings: Failed to create mutex!");
+        return false;
+    }
+    nvsNamespace = nvs_namespace;
+
+    RuntimeRates loaded;
+    if (preferences.begin(nvsNamespace, true)) { // true = somente leitura
+        for (size_t i = 0; i < RUNTIME_RATE_FIELD_COUNT; ++i) {
+            const RuntimeRateField& field = RUNTIME_RATE_FIELDS[i];
+            loaded.*(field.member) = preferences.getUInt(field.nvsKey, loaded.*(field.member));
+        }
+        preferences.end();
+    } else {
+        Logger::info("RuntimeSettings: NVS namespace '%s' not found, using defaults.", nvsNamespace);
+    }
+
+    const char* invalidKey = nullptr;
+    if (!validateRuntimeRates(loaded, &invalidKey)) {
+        Logger::warn("RuntimeSettings: Stored value for '%s' out of range, using defaults.", invalidKey);
+        loaded = RuntimeRates();
+    }
+
+    persistTimer = xTimerCreate("RtCfgSave", PERSIST_DEBOUNCE, pdFALSE, this, persistTimerCallback);
+    if (persistTimer == nullptr) {
+        Logger::error("RuntimeSettings: Failed to create persist timer, changes will not survive reboot.");
+    }
+
+    if (xSemaphoreTake(settingsMutex.get(), MUTEX_TIMEOUT) != pdTRUE) {
+        Logger::error("RuntimeSettings: Timed out acquiring mutex for initialization.");
+        return false;
+    }
+    rates = loaded;
+    xSemaphoreGive(settingsMutex.get());
+
+    initialized = true;
+    Logger::info("RuntimeSettings: sensor=%lu ms, save=%lu ms, mqtt=%lu ms, light=%lu ms, humidity=%lu ms.",
+                 (unsigned long)loaded.sensorReadIntervalMs, (unsigned long)loaded.historySaveIntervalMs,
+                 (unsigned long)loaded.mqttServiceIntervalMs, (unsigned long)loaded.lightCheckIntervalMs,
+                 (unsigned long)loaded.humidityCheckIntervalMs);
+    return true;
+}
+
+RuntimeRates RuntimeSettings::getRates() const {
+    RuntimeRates copy; // Padrões se o mutex falhar
+    if (xSemaphoreTake(settingsMutex.get(), MUTEX_TIMEOUT) == pdTRUE) {
+        copy = rates;
+        xSemaphoreGive(settingsMutex.get());
+    } else {
+        Metrics::mutexTimeoutsSettings.inc();
+    }
+    return copy;
+}
+
+bool RuntimeSettings::updateFromJson(const JsonDocument& doc, char* error, size_t errorSize) {
+    if (xSemaphoreTake(settingsMutex.get(), MUTEX_TIMEOUT) != pdTRUE) {
+        Metrics::mutexTimeoutsSettings.inc();
+        if (error) snprintf(error, errorSize, "settings busy");
+        return false;
+    }
+
+    // 1. Monta o candidato completo a partir do valor atual
+    RuntimeRates candidate = rates;
+    bool changed = false;
+    for (size_t i = 0; i < RUNTIME_RATE_FIELD_COUNT; ++i) {
+        const RuntimeRateField& field = RUNTIME_RATE_FIELDS[i];
+        if (doc[field.key].isNull()) {
+            continue;
+        }
+        if (!doc[field.key].is<uint32_t>()) {
+            xSemaphoreGive(settingsMutex.get());
+            if (error) snprintf(error, errorSize, "'%s' must be an unsigned integer (ms)", field.key);
+            return false;
+        }
+        uint32_t value = doc[field.key].as<uint32_t>();
+        changed |= (value != candidate.*(field.member));
+        candidate.*(field.member) = value;
+    }
+
+    // 2. Valida tudo antes de aplicar qualquer coisa
+    const char* invalidKey = nullptr;
+    if (!validateRuntimeRates(candidate, &invalidKey)) {
+        xSemaphoreGive(settingsMutex.get());
+        for (size_t i = 0; i < RUNTIME_RATE_FIELD_COUNT; ++i) {
+            if (RUNTIME_RATE_FIELDS[i].key == invalidKey && error) {
+                snprintf(error, errorSize, "'%s' must be between %lu and %lu ms", invalidKey,
+                         (unsigned long)RUNTIME_RATE_FIELDS[i].minMs, (unsigned long)RUNTIME_RATE_FIELDS[i].maxMs);
+            }
+        }
+        return false;
+    }
+
+    // 3. Aplica de uma vez
+    rates = candidate;
+    xSemaphoreGive(settingsMutex.get());
+
+    if (changed) {
+        version.fetch_add(1, std::memory_order_release);
+        Logger::info("RuntimeSettings: Rates updated (version %u).", (unsigned)getVersion());
+        _notifyListeners();
+        if (persistTimer != nullptr) {
+            xTimerReset(persistTimer, 0); // Debounce: reinicia a contagem a cada mudança
+        }
+    }
+    return true;
+}
+
+void RuntimeSettings::toJson(JsonDocument& doc) const {
+    RuntimeRates current = getRates();
+    for (size_t i = 0; i < RUNTIME_RATE_FIELD_COUNT; ++i) {
+        doc[RUNTIME_RATE_FIELDS[i].key] = current.*(RUNTIME_RATE_FIELDS[i].member);
+    }
+}
+
+bool RuntimeSettings::addListener(TaskHandle_t task) {
+    if (task == nullptr) {
+        return false;
+    }
+    bool added = false;
+    if (xSemaphoreTake(settingsMutex.get(), MUTEX_TIMEOUT) == pdTRUE) {
+        for (size_t i = 0; i < MAX_LISTENERS; ++i) {
+            if (listeners[i] == task) {
+                added = true;
+                break;
+            }
+            if (listeners[i] == nullptr) {
+                listeners[i] = task;
+                added = true;
+                break;
+            }
+        }
+        xSemaphoreGive(settingsMutex.get());
+    }
+    if (!added) {
+        Logger::warn("RuntimeSettings: Listener table full.");
+    }
+    return added;
+}
+
+void RuntimeSettings::waitForNextCycle(RuntimeSettings* settings, uint32_t RuntimeRates::*interval, TickType_t cycleStart) {
+    while (true) {
+        if (settings) {
+            settings->servicePersist();
+        }
+        RuntimeRates current = settings ? settings->getRates() : RuntimeRates();
+        TickType_t period = pdMS_TO_TICKS(current.*interval);
+        TickType_t elapsed = xTaskGetTickCount() - cycleStart;
+        if (elapsed >= period) {
+            return;
+        }
+        ulTaskNotifyTake(pdTRUE, period - elapsed);
+    }
+}
+
+void RuntimeSettings::_notifyListeners() {
+    TaskHandle_t snapshot[MAX_LISTENERS] = {nullptr};
+    if (xSemaphoreTake(settingsMutex.get(), MUTEX_TIMEOUT) == pdTRUE) {
+        for (size_t i = 0; i < MAX_LISTENERS; ++i) snapshot[i] = listeners[i];
+        xSemaphoreGive(settingsMutex.get());
+    }
+    for (size_t i = 0; i < MAX_LISTENERS; ++i) {
+        if (snapshot[i] != nullptr) {
+            xTaskNotifyGive(snapshot[i]); // Interrompe a espera atual da tarefa
+        }
+    }
+}
+
+void RuntimeSettings::persistTimerCallback(TimerHandle_t timer) {
+    // Roda na tarefa de serviço de timers: nada de NVS nem log aqui, só acorda quem grava
+    RuntimeSettings* instance = static_cast<RuntimeSettings*>(pvTimerGetTimerID(timer));
+    if (instance) {
+        instance->persistPending.store(true, std::memory_order_release);
+        TaskHandle_t task = instance->persistTask.load(std::memory_order_acquire);
+        if (task != nullptr) {
+            xTaskNotifyGive(task);
+        }
+    }
+}
+
+bool RuntimeSettings::servicePersist() {
+    if (!persistPending.exchange(false, std::memory_order_acq_rel)) {
+        return false;
+    }
+    _persist();
+    return true;
+}
+
+void RuntimeSettings::_persist() {
+    RuntimeRates current = getRates();
+    if (!preferences.begin(nvsNamespace, false)) {
+        Logger::error("RuntimeSettings: Failed to open NVS namespace '%s' for saving.", nvsNamespace);
+        return;
+    }
+    bool ok = true;
+    for (size_t i = 0; i < RUNTIME_RATE_FIELD_COUNT; ++i) {
+        const RuntimeRateField& field = RUNTIME_RATE_FIELDS[i];
+        uint32_t value = current.*(field.member);
+        // Só escreve o que mudou: poupa ciclos de escrita da flash
+        if (preferences.getUInt(field.nvsKey, value + 1) != value) {
+            ok &= preferences.putUInt(field.nvsKey, value) == sizeof(uint32_t);
+        }
+    }
+    preferences.end();
+    if (ok) {
+        Logger::info("RuntimeSettings: Rates persisted to NVS.");
+    } else {
+        Logger::error("RuntimeSettings: Failed to persist one or more rates to NVS.");
+    }
+}
+
+} // namespace GrowController
@@ -0,0 +1,113 @@
+// src/data/runtimeSettings.hpp
+#ifndef RUNTIME_SETTINGS_HPP
+#define RUNTIME_SETTINGS_HPP
+
+#include <ArduinoJson.h>
+#include <Preferences.h>
+#include <atomic>
+#include "data/runtimeRates.hpp"
+#include "utils/freeRTOSMutex.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+
+namespace GrowController {
+
+/**
+ * @brief Intervalos das tarefas ajustáveis em tempo de execução, persistidos na NVS.
+ *
+ * Atualizações são validadas por inteiro e aplicadas de uma vez (tudo ou nada)
+ * sob o mutex; as tarefas leem uma cópia consistente a cada ciclo via getRates().
+ * Tarefas registradas com addListener() são acordadas (xTaskNotifyGive) para que
+ * o novo intervalo valha já na espera corrente. A gravação na NVS é adiada por
+ * um timer one-shot reiniciado a cada mudança, agrupando rajadas de ajustes; o
+ * callback do timer só acorda a tarefa de gravação (setPersistTask()), que grava
+ * fora da tarefa de serviço de timers (pilha pequena, não pode travar na flash).
+ */
+class RuntimeSettings {
+public:
+    static const size_t MAX_LISTENERS = 6;
+
+    RuntimeSettings();
+    ~RuntimeSettings();
+
+    RuntimeSettings(const RuntimeSettings&) = delete;
+    RuntimeSettings& operator=(const RuntimeSettings&) = delete;
+
+    /**
+     * @brief Carrega os valores salvos na NVS (ou os padrões, se ausentes/inválidos) e cria o timer de gravação.
+     */
+    bool initialize(const char* nvs_namespace = "rt_settings");
+
+    /**
+     * @brief Cópia consistente dos intervalos atuais. Thread-safe.
+     */
+    RuntimeRates getRates() const;
+
+    /**
+     * @brief Aplica as chaves presentes no JSON. Thread-safe.
+     * Chaves ausentes mantêm o valor atual; se alguma for inválida, nada muda.
+     * @param error Recebe a mensagem de erro (opcional).
+     * @return true Se a atualização foi aplicada (mesmo que nenhum valor tenha mudado).
+     */
+    bool updateFromJson(const JsonDocument& doc, char* error = nullptr, size_t errorSize = 0);
+
+    /**
+     * @brief Escreve os intervalos atuais no documento JSON.
+     */
+    void toJson(JsonDocument& doc) const;
+
+    /**
+     * @brief Incrementado a cada mudança aplicada.
+     */
+    uint32_t getVersion() const { return version.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Registra uma tarefa para ser notificada quando os intervalos mudarem.
+     * A tarefa deve esperar com ulTaskNotifyTake(pdTRUE, intervalo) em vez de vTaskDelay().
+     */
+    bool addListener(TaskHandle_t task);
+
+    /**
+     * @brief Define a tarefa que grava os intervalos na NVS. Ela é notificada quando o timer
+     * de gravação dispara e deve chamar servicePersist() ao acordar (waitForNextCycle() já chama).
+     */
+    void setPersistTask(TaskHandle_t task) { persistTask.store(task, std::memory_order_release); }
+
+    /**
+     * @brief Grava na NVS se o timer marcou uma gravação pendente. Chamar só da tarefa de gravação.
+     * @return true Se havia gravação pendente.
+     */
+    bool servicePersist();
+
+    /**
+     * @brief Aguarda até que o intervalo indicado tenha passado desde cycleStart.
+     * Uma notificação (mudança de intervalo) reavalia a espera com o valor novo,
+     * sem antecipar o ciclo; uma gravação pendente na NVS é feita ao acordar.
+     * Com settings nulo usa o valor padrão.
+     */
+    static void waitForNextCycle(RuntimeSettings* settings, uint32_t RuntimeRates::*interval, TickType_t cycleStart);
+
+private:
+    static void persistTimerCallback(TimerHandle_t timer);
+    void _persist();
+    void _notifyListeners();
+
+    static const TickType_t MUTEX_TIMEOUT;
+    static const TickType_t PERSIST_DEBOUNCE;
+
+    RuntimeRates rates;
+    mutable FreeRTOSMutex settingsMutex;
+    Preferences preferences;
+    const char* nvsNamespace = nullptr;
+    TimerHandle_t persistTimer = nullptr;
+    TaskHandle_t listeners[MAX_LISTENERS] = {nullptr};
+    std::atomic<uint32_t> version{0};
+    std::atomic<TaskHandle_t> persistTask{nullptr};
+    std::atomic<bool> persistPending{false}; // Marcado pelo timer, consumido pela tarefa de gravação
+    bool initialized = false;
+};
+
+} // namespace GrowController
+
+#endif // RUNTIME_SETTINGS_HPP
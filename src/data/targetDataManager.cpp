@@ -32,7 +32,7 @@ namespace GrowController
 {
 
   // --- Construtor ---
-  TargetDataManager::TargetDataManager()
+  TargetDataManager::TargetDataManager(ChangeNotifier *notifier) : changeNotifier(notifier)
   {
     dataMutex = xSemaphoreCreateMutex();
     if (dataMutex == nullptr)
@@ -76,11 +76,19 @@ namespace GrowController
       updated |= _updateFloatValue("temperature", doc, currentTargets.temperature);
       updated |= _updateTimeValue("lightOnTime", doc, currentTargets.lightOnTime);
       updated |= _updateTimeValue("lightOffTime", doc, currentTargets.lightOffTime);
+      updated |= _updateControlParams("humidityControl", doc, currentTargets.humidityControl);
+      updated |= _updateControlParams("irrigationControl", doc, currentTargets.irrigationControl);
+      updated |= _updateClimateMode(doc, currentTargets.climateMode);
 
       xSemaphoreGive(dataMutex);
 
       if (updated)
       {
+        dataVersion.fetch_add(1, std::memory_order_release);
+        if (changeNotifier)
+        {
+          changeNotifier->notify(CHANGE_STATUS | CHANGE_TARGETS);
+        }
         temp_log(LOG_LEVEL_INFO, "Targets updated via JSON."); // Log info opcional
       }
       else
@@ -234,4 +242,66 @@ namespace GrowController
     return false;
   }
 
+  // --- Helper _updateClimateMode ---
+  bool TargetDataManager::_updateClimateMode(const JsonDocument &doc, ClimateMode &outValue)
+  {
+    JsonVariantConst mode = doc["climateMode"];
+    if (mode.isNull())
+    {
+      return false;
+    }
+    ClimateMode next;
+    if (!mode.is<const char *>() || !parseClimateMode(mode.as<const char *>(), &next))
+    {
+      temp_log(LOG_LEVEL_WARN, "climateMode must be \"humidity\" or \"vpd\".");
+      return false;
+    }
+    outValue = next;
+    temp_log(LOG_LEVEL_INFO, "Updated climateMode to: %s", climateModeName(next));
+    return true;
+  }
+
+  // --- Helper _updateControlParams ---
+  bool TargetDataManager::_updateControlParams(const char *key, const JsonDocument &doc, HumidityControlParams &outValue)
+  {
+    JsonVariantConst control = doc[key];
+    if (control.isNull())
+    {
+      return false;
+    }
+    if (!control.is<JsonObjectConst>())
+    {
+      temp_log(LOG_LEVEL_WARN, "JSON key '%s' exists but is not an object.", key);
+      return false;
+    }
+
+    HumidityControlParams next = outValue;
+    if (!control["mode"].isNull() &&
+        !(control["mode"].is<const char *>() && parseHumidityControlMode(control["mode"].as<const char *>(), &next.mode)))
+    {
+      temp_log(LOG_LEVEL_WARN, "%s.mode must be \"onoff\", \"hysteresis\" or \"pid\".", key);
+      return false;
+    }
+    if (control["band"].is<float>()) next.band = control["band"].as<float>();
+    if (control["kp"].is<float>()) next.kp = control["kp"].as<float>();
+    if (control["ki"].is<float>()) next.ki = control["ki"].as<float>();
+    if (control["kd"].is<float>()) next.kd = control["kd"].as<float>();
+    // Tempos chegam em segundos; acima de 1 h já é inválido (e evita overflow na conversão)
+    auto secondsToMs = [](uint32_t seconds) { return seconds > 3600UL ? 0xFFFFFFFFUL : seconds * 1000UL; };
+    if (control["minOnS"].is<uint32_t>()) next.minOnMs = secondsToMs(control["minOnS"].as<uint32_t>());
+    if (control["minOffS"].is<uint32_t>()) next.minOffMs = secondsToMs(control["minOffS"].as<uint32_t>());
+    if (control["windowS"].is<uint32_t>()) next.windowMs = secondsToMs(control["windowS"].as<uint32_t>());
+
+    if (!humidityControlParamsValid(next))
+    {
+      temp_log(LOG_LEVEL_WARN, "%s rejected: value out of range.", key);
+      return false;
+    }
+    outValue = next;
+    temp_log(LOG_LEVEL_INFO, "Updated %s: mode=%s band=%.1f minOn=%lus minOff=%lus", key,
+             humidityControlModeName(next.mode), next.band,
+             (unsigned long)(next.minOnMs / 1000), (unsigned long)(next.minOffMs / 1000));
+    return true;
+  }
+
 } // namespace GrowController
\ No newline at end of file
@@ -6,27 +6,21 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include <Arduino.h> // Para Serial (logs de erro) e memset
+#include <atomic>
+#include "utils/changeNotifier.hpp"
+#include "data/targetValues.hpp" // TargetValues
 
 namespace GrowController
 {
 
-  struct TargetValues
-  {
-    float airHumidity = 73;
-    float vpd = NAN;
-    float soilHumidity = NAN;
-    float temperature = 25;
-    struct tm lightOnTime;
-    struct tm lightOffTime;
-  };
-
   class TargetDataManager
   {
   public:
     /**
      * @brief Construtor. Inicializa os valores padrão e o mutex.
+     * @param notifier Avisado (CHANGE_STATUS) a cada atualização de alvos (opcional).
      */
-    TargetDataManager();
+    explicit TargetDataManager(ChangeNotifier *notifier = nullptr);
 
     /**
      * @brief Destrutor. Libera o mutex.
@@ -80,6 +74,12 @@ namespace GrowController
 
     // Adicione getters para vpd, soilHumidity, temperature se forem necessários individualmente
 
+    /**
+     * @brief Contador incrementado a cada atualização de alvos aplicada.
+     * Permite a quem guarda uma cópia serializada saber se ela ficou velha.
+     */
+    uint32_t getDataVersion() const { return dataVersion.load(std::memory_order_acquire); }
+
   private:
     /**
      * @brief Helper interno para obter um valor float do JSON de forma segura.
@@ -101,9 +101,26 @@ namespace GrowController
      */
     bool _updateTimeValue(const char *key, const JsonDocument &doc, struct tm &outValue);
 
+    /**
+     * @brief Helper interno para os objetos "humidityControl" e "irrigationControl" do JSON.
+     * Aceita mode ("onoff" | "hysteresis" | "pid"), band, minOnS, minOffS, kp, ki, kd, windowS;
+     * campos ausentes mantêm o valor atual. O objeto inteiro é recusado se algum valor for inválido.
+     * @param key Chave do objeto no JSON.
+     * @return true Se os parâmetros foram validados e atualizados.
+     */
+    bool _updateControlParams(const char *key, const JsonDocument &doc, HumidityControlParams &outValue);
+
+    /**
+     * @brief Helper interno para "climateMode": "humidity" (alvo airHumidity) ou "vpd" (alvo derivado de vpd).
+     * @return true Se o modo foi reconhecido e atualizado.
+     */
+    bool _updateClimateMode(const JsonDocument &doc, ClimateMode &outValue);
+
     TargetValues currentTargets;                              // Armazena os valores
     mutable SemaphoreHandle_t dataMutex;                      // Mutex para proteger currentTargets (mutable para getters const)
     static const TickType_t mutexTimeout = pdMS_TO_TICKS(200); // Timeout para leituras
+    std::atomic<uint32_t> dataVersion{0};                     // Ver getDataVersion()
+    ChangeNotifier *changeNotifier;                           // Pode ser nullptr
   };
 
 } // namespace GrowController
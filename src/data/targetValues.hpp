@@ -0,0 +1,71 @@
+// src/data/targetValues.hpp
+#ifndef TARGET_VALUES_HPP
+#define TARGET_VALUES_HPP
+
+#include <math.h>   // NAN
+#include <string.h> // strcmp
+#include <time.h>   // struct tm
+#include "actuators/humidityController.hpp" // HumidityControlParams
+
+namespace GrowController
+{
+
+  /**
+   * @brief De onde vem o alvo de umidade do ar do umidificador.
+   */
+  enum class ClimateMode : uint8_t
+  {
+    Humidity = 0, ///< Alvo fixo: airHumidity
+    Vpd = 1,      ///< Alvo derivado a cada amostra: UR que dá o vpd alvo na temperatura medida
+  };
+
+  inline const char *climateModeName(ClimateMode mode)
+  {
+    return mode == ClimateMode::Vpd ? "vpd" : "humidity";
+  }
+
+  inline bool parseClimateMode(const char *name, ClimateMode *out)
+  {
+    if (name == nullptr) return false;
+    if (strcmp(name, "humidity") == 0) { *out = ClimateMode::Humidity; return true; }
+    if (strcmp(name, "vpd") == 0) { *out = ClimateMode::Vpd; return true; }
+    return false;
+  }
+
+  /**
+   * @brief Irrigação: pulsos curtos e espera longa para a água chegar ao sensor do solo.
+   * PID em tempo proporcional com janela de 15 min: a demanda vira duração do pulso.
+   */
+  inline HumidityControlParams defaultIrrigationControl()
+  {
+    HumidityControlParams params;
+    params.mode = HumidityControlMode::Pid;
+    params.kp = 0.005f;       // 4.5 s de bomba por janela para cada ponto de umidade do solo abaixo do alvo
+    params.ki = 0.000002f;    // Integral lenta: tira o erro de regime (sem ela o solo fica ~3 pontos abaixo)
+    params.kd = 0.0f;
+    params.minOnMs = 5000;    // Pulsos menores não vencem a mangueira
+    params.minOffMs = 300000; // Tempo mínimo para a água infiltrar antes de outro pulso
+    params.windowMs = 900000;
+    return params;
+  }
+
+  /**
+   * @brief Valores alvo (sem dependências de Arduino/FreeRTOS, usável nos testes de host).
+   * Guardados e protegidos por mutex no TargetDataManager.
+   */
+  struct TargetValues
+  {
+    float airHumidity = 73;
+    float vpd = NAN;
+    float soilHumidity = NAN;
+    float temperature = 25;
+    struct tm lightOnTime = {};
+    struct tm lightOffTime = {};
+    HumidityControlParams humidityControl; // Estratégia do relé do umidificador
+    ClimateMode climateMode = ClimateMode::Humidity;
+    HumidityControlParams irrigationControl = defaultIrrigationControl(); // Estratégia da bomba (alvo: soilHumidity)
+  };
+
+} // namespace GrowController
+
+#endif // TARGET_VALUES_HPP
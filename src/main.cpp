@@ -9,6 +9,8 @@
 #include "ui/displayManager.hpp"
 #include "network/webServerManager.hpp"
 #include "data/dataHistoryManager.hpp"
+#include "data/runtimeSettings.hpp"
+#include "utils/changeNotifier.hpp"
 #include "utils/logger.hpp"
 
 #include <WiFi.h>
@@ -26,15 +28,18 @@ char g_receivedPassword[64];
 
 // --- Instâncias Principais (Managers Globais) ---
 AppConfig appConfig;
-GrowController::TargetDataManager targetManager;
-GrowController::TimeService timeService;
+GrowController::ChangeNotifier dashboardNotifier; // Amostras, alvos, relés e relógio -> tarefa SSE e controle de umidade/luz
+GrowController::TargetDataManager targetManager(&dashboardNotifier);
+GrowController::TimeService timeService(&dashboardNotifier);
 GrowController::DataHistoryManager dataHistoryMgr;
+GrowController::RuntimeSettings runtimeSettings;
 
 GrowController::DisplayManager displayMgr(LCD_I2C_ADDR, LCD_COLS, LCD_ROWS, timeService);
-GrowController::MqttManager mqttMgr(appConfig.mqtt, targetManager);
-GrowController::SensorManager sensorMgr(appConfig.sensor, timeService, &dataHistoryMgr, &displayMgr, &mqttMgr);
-GrowController::ActuatorManager actuatorMgr(appConfig.gpioControl, targetManager, sensorMgr, timeService);
-GrowController::WebServerManager webServerManager(HTTP_PORT, &sensorMgr, &targetManager, &actuatorMgr, &dataHistoryMgr);
+GrowController::MqttManager mqttMgr(appConfig.mqtt, targetManager, &dataHistoryMgr, &runtimeSettings);
+GrowController::SensorManager sensorMgr(appConfig.sensor, timeService, &dataHistoryMgr, &displayMgr, &mqttMgr, &runtimeSettings, &dashboardNotifier);
+GrowController::ActuatorManager actuatorMgr(appConfig.gpioControl, targetManager, sensorMgr, timeService, &runtimeSettings, &dashboardNotifier,
+                                          &dataHistoryMgr, &mqttMgr);
+GrowController::WebServerManager webServerManager(HTTP_PORT, &sensorMgr, &targetManager, &actuatorMgr, &dataHistoryMgr, &runtimeSettings, &dashboardNotifier);
 
 BLEServer* pServer = nullptr;
 BLECharacteristic* pCharacteristic = nullptr;
@@ -161,6 +166,11 @@ void setup() {
         dataHistoryOk = false;
     }
 
+    GrowController::Logger::info("Loading runtime rates...");
+    if (!runtimeSettings.initialize("rt_settings")) {
+        GrowController::Logger::error("Runtime settings initialization failed, tasks will use default intervals.");
+    }
+
     if (digitalRead(PAIRING_BUTTON_PIN) == LOW) {
         activatePairingMode();
     } else {
@@ -209,6 +219,12 @@ void setup() {
     if (wifiOk && littleFsOk) {
         GrowController::Logger::info("Starting Web Server...");
         webServerManager.begin();
+        if (!webServerManager.startEventTask(1, 3072)) {
+            GrowController::Logger::error("Failed to start SSE Task!");
+        }
+        if (!webServerManager.startLiveTask(1, 3072)) {
+            GrowController::Logger::error("Failed to start live stream Task!");
+        }
     } else if (!bleAdvertising) {
         GrowController::Logger::warn("Skipping Web Server start (No WiFi or LittleFS not mounted).");
     }
@@ -256,7 +272,7 @@ void setup() {
         if (wifiOk && mqttSetupOk) {
             GrowController::Logger::info("Starting MQTT Task...");
             if (displayOk) displayMgr.showMqttConnecting();
-            BaseType_t mqttTaskResult = xTaskCreate( GrowController::MqttManager::taskRunner, "MQTTTask", 4096, &mqttMgr, 2, nullptr );
+            BaseType_t mqttTaskResult = xTaskCreate( GrowController::MqttManager::taskRunner, "MQTTTask", 5120, &mqttMgr, 2, nullptr );
             mqttTaskOk = (mqttTaskResult == pdPASS);
             if (!mqttTaskOk) {
                 GrowController::Logger::error("Failed to start MQTT Task! Code: %d", mqttTaskResult);
@@ -281,10 +297,10 @@ void setup() {
 
         bool canStartActuatorTasks = actuatorsOk && timeService.isInitialized() && sensorMgr.isInitialized();
         if (canStartActuatorTasks) {
-            GrowController::Logger::info("Starting Actuator Control Tasks...");
-            actuatorTasksOk = actuatorMgr.startControlTasks(1, 1, 2560);
+            GrowController::Logger::info("Starting Actuator Control Task...");
+            actuatorTasksOk = actuatorMgr.startControlTask(1, 4096);
             if (!actuatorTasksOk) {
-                GrowController::Logger::error("Failed to start one or both Actuator Tasks!");
+                GrowController::Logger::error("Failed to start the Actuator Control Task!");
                 if (displayOk) displayMgr.showError("Task Act Fail");
             }
         } else {
@@ -325,12 +341,6 @@ void loop() {
         lastButtonCheck = currentLoopMillis;
     }
 
-    static unsigned long lastSseSendTime = 0;
-    if (wifiOk && littleFsOk && !bleAdvertising && (currentLoopMillis - lastSseSendTime > 2000)) {
-        webServerManager.sendSensorUpdateEvent();
-        webServerManager.sendStatusUpdateEvent();
-        lastSseSendTime = currentLoopMillis;
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(50));
+    // SSE é enviado pela tarefa do WebServerManager quando algo muda; aqui só o botão
+    vTaskDelay(pdMS_TO_TICKS(100));
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+// src/network/admissionControl.hpp
+#ifndef ADMISSION_CONTROL_HPP
+#define ADMISSION_CONTROL_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+namespace GrowController {
+
+/**
+ * @brief Prioridade de uma requisição HTTP: sob pressão, a menor é descartada primeiro.
+ */
+enum class RequestPriority : uint8_t {
+    Low = 0,    ///< Assets estáticos e /metrics (o navegador/scraper tenta de novo)
+    Normal = 1, ///< Leituras da API (GET /api/...)
+    High = 2,   ///< Escritas (POST /api/targets, /api/config): nunca cortadas antes das outras
+};
+
+enum class AdmissionResult : uint8_t {
+    Admitted,
+    Busy,      ///< Sem vaga de requisição/cliente (503)
+    LowMemory, ///< Heap abaixo do limite da prioridade (503)
+};
+
+/**
+ * @brief Limites de admissão. Os limites de heap são em bytes livres; cada prioridade
+ * tem o seu, do maior (Low) para o menor (High), então escritas só são recusadas
+ * depois de todo o resto.
+ */
+struct AdmissionLimits {
+    uint8_t maxActiveRequests = 6;   ///< Requisições em andamento (todas as prioridades)
+    uint8_t reservedForHigh = 2;     ///< Dessas, vagas que só High pode usar
+    uint8_t maxStreamClients = 4;    ///< Clientes /events + /ws (conexões longas)
+    uint32_t minHeapLow = 48 * 1024;
+    uint32_t minHeapNormal = 32 * 1024;
+    uint32_t minHeapHigh = 20 * 1024;
+};
+
+/**
+ * @brief Classifica a requisição pela URL (sem query string) e método.
+ */
+inline RequestPriority requestPriorityFor(const char* url, bool isWrite) {
+    if (strncmp(url, "/api/", 5) == 0) {
+        return isWrite ? RequestPriority::High : RequestPriority::Normal;
+    }
+    return RequestPriority::Low;
+}
+
+/**
+ * @brief Contagem de requisições em andamento e decisão de admissão/descarte.
+ * tryAdmit() e release() são lock-free; cada Admitted deve ter exatamente um release().
+ */
+class AdmissionController {
+public:
+    explicit AdmissionController(const AdmissionLimits& limits = AdmissionLimits()) : limits_(limits) {}
+
+    /**
+     * @brief Decide se uma requisição comum entra.
+     * @param freeHeap Heap livre agora (ESP.getFreeHeap()).
+     */
+    AdmissionResult tryAdmit(RequestPriority priority, uint32_t freeHeap) {
+        if (freeHeap < minHeapFor(priority)) {
+            return AdmissionResult::LowMemory;
+        }
+        uint32_t limit = limits_.maxActiveRequests;
+        if (priority != RequestPriority::High) {
+            limit = limit > limits_.reservedForHigh ? limit - limits_.reservedForHigh : 0;
+        }
+        uint32_t current = active_.load(std::memory_order_relaxed);
+        do {
+            if (current >= limit) {
+                return AdmissionResult::Busy;
+            }
+        } while (!active_.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel));
+        return AdmissionResult::Admitted;
+    }
+
+    void release() {
+        uint32_t current = active_.load(std::memory_order_relaxed);
+        while (current > 0 && !active_.compare_exchange_weak(current, current - 1, std::memory_order_acq_rel)) {
+        }
+    }
+
+    /**
+     * @brief Decide se um novo cliente de stream (SSE/WebSocket) entra.
+     * Esses não ocupam vaga de requisição; o limite é sobre os clientes já conectados.
+     */
+    AdmissionResult tryAdmitStream(size_t connectedClients, uint32_t freeHeap) const {
+        if (freeHeap < limits_.minHeapLow) {
+            return AdmissionResult::LowMemory; // Um stream a mais é tão dispensável quanto um asset
+        }
+        return connectedClients >= limits_.maxStreamClients ? AdmissionResult::Busy : AdmissionResult::Admitted;
+    }
+
+    uint32_t active() const {
+        return active_.load(std::memory_order_relaxed);
+    }
+
+    const AdmissionLimits& limits() const {
+        return limits_;
+    }
+
+    uint32_t minHeapFor(RequestPriority priority) const {
+        switch (priority) {
+            case RequestPriority::High:   return limits_.minHeapHigh;
+            case RequestPriority::Normal: return limits_.minHeapNormal;
+            default:                      return limits_.minHeapLow;
+        }
+    }
+
+private:
+    AdmissionLimits limits_;
+    std::atomic<uint32_t> active_{0};
+};
+
+} // namespace GrowController
+
+#endif // ADMISSION_CONTROL_HPP
@@ -0,0 +1,55 @@
+#include "admissionHandler.hpp"
+#include <Arduino.h>
+#include "utils/logger.hpp"
+#include "utils/metrics.hpp"
+
+namespace GrowController {
+
+bool AdmissionHandler::canHandle(AsyncWebServerRequest* request) {
+    uint32_t freeHeap = ESP.getFreeHeap();
+    const String& url = request->url();
+    AdmissionResult result;
+
+    // Roda antes de qualquer outro handler: registra o cabeçalho das requisições condicionais
+    // (/api/history, assets), que o ESPAsyncWebServer 1.2.x descartaria sem interesse declarado
+    if (request->method() == HTTP_GET || request->method() == HTTP_HEAD) {
+        request->addInterestingHeader("If-None-Match");
+    }
+
+    if (url == "/events" || url == "/ws") {
+        result = controller_.tryAdmitStream(events_.count() + ws_.count(), freeHeap);
+    } else {
+        bool isWrite = request->method() == HTTP_POST || request->method() == HTTP_PUT ||
+                       request->method() == HTTP_PATCH || request->method() == HTTP_DELETE;
+        RequestPriority priority = requestPriorityFor(url.c_str(), isWrite);
+        result = controller_.tryAdmit(priority, freeHeap);
+        if (result == AdmissionResult::Admitted) {
+            // Uma requisição por conexão: o slot volta quando o cliente desconecta (inclusive se abortar)
+            request->onDisconnect([this, request]() {
+                controller_.release();
+                if (onFinished_) onFinished_(request);
+            });
+            return false; // Segue para os handlers normais
+        }
+    }
+
+    if (result == AdmissionResult::Admitted) {
+        return false;
+    }
+    if (result == AdmissionResult::LowMemory) {
+        Metrics::httpShedLowMemory.inc();
+        Logger::warn("AdmissionHandler: Shedding %s (free heap %u).", url.c_str(), (unsigned)freeHeap);
+    } else {
+        Metrics::httpShedBusy.inc();
+    }
+    return true; // handleRequest() responde 503
+}
+
+void AdmissionHandler::handleRequest(AsyncWebServerRequest* request) {
+    AsyncWebServerResponse* response = request->beginResponse(503, "application/json",
+                                                              "{\"error\":\"Server busy, retry shortly\"}");
+    response->addHeader("Retry-After", "2");
+    request->send(response);
+}
+
+} // namespace GrowController
@@ -0,0 +1,46 @@
+// src/network/admissionHandler.hpp
+#ifndef ADMISSION_HANDLER_HPP
+#define ADMISSION_HANDLER_HPP
+
+#include <ESPAsyncWebServer.h>
+#include <functional>
+#include "network/admissionControl.hpp"
+
+namespace GrowController
+{
+
+  /**
+   * @brief First handler in the chain: admits or sheds every request before any other handler allocates for it.
+   *
+   * Admitted requests fall through (canHandle() returns false) and hold a slot in the
+   * AdmissionController until the connection closes. Rejected ones are answered here with
+   * 503 + Retry-After. /events and /ws are checked against the number of connected stream
+   * clients instead, since they outlive the request. Being first, it also registers
+   * If-None-Match for GET/HEAD so conditional requests reach the handlers that check it.
+   */
+  class AdmissionHandler : public AsyncWebHandler
+  {
+  public:
+    typedef std::function<void(AsyncWebServerRequest *)> FinishedCallback;
+
+    AdmissionHandler(AdmissionController &controller, AsyncEventSource &events, AsyncWebSocket &ws)
+        : controller_(controller), events_(events), ws_(ws) {}
+
+    /**
+     * @brief Called when an admitted request's connection closes (e.g. to release per-request buffers).
+     */
+    void onFinished(FinishedCallback callback) { onFinished_ = callback; }
+
+    bool canHandle(AsyncWebServerRequest *request) override;
+    void handleRequest(AsyncWebServerRequest *request) override;
+
+  private:
+    AdmissionController &controller_;
+    AsyncEventSource &events_;
+    AsyncWebSocket &ws_;
+    FinishedCallback onFinished_;
+  };
+
+} // namespace GrowController
+
+#endif // ADMISSION_HANDLER_HPP
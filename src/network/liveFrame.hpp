@@ -0,0 +1,168 @@
+// src/network/liveFrame.hpp
+#ifndef LIVE_FRAME_HPP
+#define LIVE_FRAME_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+namespace GrowController {
+
+/**
+ * @brief Frames binários do WebSocket /ws (little-endian, sem nomes de campo).
+ *
+ * Cabeçalho comum (8 bytes): { uint8 version; uint8 type; uint16 seq; uint32 millis }
+ * LIVE_FRAME_SENSORS (+10): { int16 temp*100; uint16 airHum*100; uint16 soil*100; uint16 vpd*1000; uint16 soilAdc }
+ * LIVE_FRAME_ACTUATORS (+2): { uint8 relays (bit0 luz, bit1 umidificador, bit2 irrigação); uint8 changed }
+ * Valores ausentes (NAN) usam LIVE_FRAME_MISSING_I16/U16. O decodificador JS em web/scripts.js
+ * espelha este formato; mude os dois juntos e incremente LIVE_FRAME_VERSION.
+ */
+static const uint8_t LIVE_FRAME_VERSION = 1;
+static const uint8_t LIVE_FRAME_SENSORS = 1;
+static const uint8_t LIVE_FRAME_ACTUATORS = 2;
+static const size_t LIVE_FRAME_HEADER_SIZE = 8;
+static const size_t LIVE_FRAME_SENSORS_SIZE = LIVE_FRAME_HEADER_SIZE + 10;
+static const size_t LIVE_FRAME_ACTUATORS_SIZE = LIVE_FRAME_HEADER_SIZE + 2;
+static const int16_t LIVE_FRAME_MISSING_I16 = INT16_MIN;
+static const uint16_t LIVE_FRAME_MISSING_U16 = 0xFFFF;
+
+static const uint8_t LIVE_RELAY_LIGHT = 1u << 0;
+static const uint8_t LIVE_RELAY_HUMIDIFIER = 1u << 1;
+static const uint8_t LIVE_RELAY_IRRIGATION = 1u << 2;
+
+/// Intervalo entre frames de sensor escolhido pelo cliente ("rate=<ms>").
+static const uint16_t LIVE_RATE_MIN_MS = 100;
+static const uint16_t LIVE_RATE_MAX_MS = 10000;
+static const uint16_t LIVE_RATE_DEFAULT_MS = 1000;
+
+struct LiveSensorSample {
+    float temperature = NAN;
+    float airHumidity = NAN;
+    float soilHumidity = NAN;
+    float vpd = NAN;
+    uint16_t soilAdc = LIVE_FRAME_MISSING_U16; ///< Leitura crua do ADC do solo (0-4095)
+};
+
+namespace detail {
+
+inline void putU16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)(value & 0xFF);
+    out[1] = (uint8_t)(value >> 8);
+}
+
+inline uint16_t getU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+inline uint16_t scaledU16(float value, float scale) {
+    if (isnan(value)) return LIVE_FRAME_MISSING_U16;
+    float scaled = value * scale;
+    if (scaled < 0.0f) return 0;
+    if (scaled >= (float)(LIVE_FRAME_MISSING_U16 - 1)) return LIVE_FRAME_MISSING_U16 - 1;
+    return (uint16_t)lroundf(scaled);
+}
+
+inline float unscaledU16(uint16_t raw, float scale) {
+    return raw == LIVE_FRAME_MISSING_U16 ? NAN : raw / scale;
+}
+
+inline size_t putLiveHeader(uint8_t* out, uint8_t type, uint16_t seq, uint32_t millisNow) {
+    out[0] = LIVE_FRAME_VERSION;
+    out[1] = type;
+    putU16(out + 2, seq);
+    putU16(out + 4, (uint16_t)(millisNow & 0xFFFF));
+    putU16(out + 6, (uint16_t)(millisNow >> 16));
+    return LIVE_FRAME_HEADER_SIZE;
+}
+
+} // namespace detail
+
+/**
+ * @brief Codifica um frame de leituras.
+ * @return size_t LIVE_FRAME_SENSORS_SIZE, ou 0 se out é pequeno demais.
+ */
+inline size_t encodeLiveSensorFrame(const LiveSensorSample& sample, uint16_t seq, uint32_t millisNow,
+                                    uint8_t* out, size_t size) {
+    if (out == nullptr || size < LIVE_FRAME_SENSORS_SIZE) {
+        return 0;
+    }
+    uint8_t* p = out + detail::putLiveHeader(out, LIVE_FRAME_SENSORS, seq, millisNow);
+    int16_t temperature = LIVE_FRAME_MISSING_I16;
+    if (!isnan(sample.temperature)) {
+        float centi = sample.temperature * 100.0f;
+        if (centi < (float)(INT16_MIN + 1)) centi = (float)(INT16_MIN + 1);
+        if (centi > (float)INT16_MAX) centi = (float)INT16_MAX;
+        temperature = (int16_t)lroundf(centi);
+    }
+    detail::putU16(p, (uint16_t)temperature);
+    detail::putU16(p + 2, detail::scaledU16(sample.airHumidity, 100.0f));
+    detail::putU16(p + 4, detail::scaledU16(sample.soilHumidity, 100.0f));
+    detail::putU16(p + 6, detail::scaledU16(sample.vpd, 1000.0f));
+    detail::putU16(p + 8, sample.soilAdc);
+    return LIVE_FRAME_SENSORS_SIZE;
+}
+
+/**
+ * @brief Codifica um frame de estado dos relés.
+ * @param changed Relés que mudaram desde o último frame enviado a este cliente.
+ */
+inline size_t encodeLiveActuatorFrame(uint8_t relays, uint8_t changed, uint16_t seq, uint32_t millisNow,
+                                      uint8_t* out, size_t size) {
+    if (out == nullptr || size < LIVE_FRAME_ACTUATORS_SIZE) {
+        return 0;
+    }
+    uint8_t* p = out + detail::putLiveHeader(out, LIVE_FRAME_ACTUATORS, seq, millisNow);
+    p[0] = relays;
+    p[1] = changed;
+    return LIVE_FRAME_ACTUATORS_SIZE;
+}
+
+/**
+ * @brief Decodifica um frame de leituras (testes e ferramentas no host).
+ * @return false Se o tamanho, versão ou tipo não conferem.
+ */
+inline bool decodeLiveSensorFrame(const uint8_t* in, size_t length, LiveSensorSample& sample,
+                                  uint16_t* seq = nullptr, uint32_t* millisAt = nullptr) {
+    if (in == nullptr || length != LIVE_FRAME_SENSORS_SIZE || in[0] != LIVE_FRAME_VERSION ||
+        in[1] != LIVE_FRAME_SENSORS) {
+        return false;
+    }
+    if (seq) *seq = detail::getU16(in + 2);
+    if (millisAt) *millisAt = (uint32_t)detail::getU16(in + 4) | ((uint32_t)detail::getU16(in + 6) << 16);
+    const uint8_t* p = in + LIVE_FRAME_HEADER_SIZE;
+    int16_t temperature = (int16_t)detail::getU16(p);
+    sample.temperature = temperature == LIVE_FRAME_MISSING_I16 ? NAN : temperature / 100.0f;
+    sample.airHumidity = detail::unscaledU16(detail::getU16(p + 2), 100.0f);
+    sample.soilHumidity = detail::unscaledU16(detail::getU16(p + 4), 100.0f);
+    sample.vpd = detail::unscaledU16(detail::getU16(p + 6), 1000.0f);
+    sample.soilAdc = detail::getU16(p + 8);
+    return true;
+}
+
+/**
+ * @brief Interpreta a mensagem de texto do cliente "rate=<ms>" (limitada a [MIN, MAX]).
+ * @return false Se a mensagem não é um comando de taxa válido.
+ */
+inline bool parseLiveRateCommand(const char* message, size_t length, uint16_t& rateMs) {
+    static const char PREFIX[] = "rate=";
+    const size_t prefixLength = sizeof(PREFIX) - 1;
+    if (message == nullptr || length <= prefixLength || length > prefixLength + 6 ||
+        strncmp(message, PREFIX, prefixLength) != 0) {
+        return false;
+    }
+    uint32_t value = 0;
+    for (size_t i = prefixLength; i < length; ++i) {
+        if (message[i] < '0' || message[i] > '9') return false;
+        value = value * 10 + (uint32_t)(message[i] - '0');
+    }
+    if (value < LIVE_RATE_MIN_MS) value = LIVE_RATE_MIN_MS;
+    if (value > LIVE_RATE_MAX_MS) value = LIVE_RATE_MAX_MS;
+    rateMs = (uint16_t)value;
+    return true;
+}
+
+} // namespace GrowController
+
+#endif // LIVE_FRAME_HPP
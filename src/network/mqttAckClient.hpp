@@ -0,0 +1,92 @@
+// src/network/mqttAckClient.hpp
+#ifndef MQTT_ACK_CLIENT_HPP
+#define MQTT_ACK_CLIENT_HPP
+
+#include <Client.h>
+#include "network/mqttQos1.hpp"
+#include "utils/ringBuffer.hpp"
+
+namespace GrowController {
+
+/**
+ * @brief Client que repassa tudo ao cliente real e observa os bytes lidos.
+ * Fica entre o PubSubClient e o WiFiClient: o PubSubClient continua lendo
+ * normalmente, e os PUBACKs que ele descartaria ficam guardados para a
+ * janela QoS 1 do MqttManager. Usado apenas pela tarefa MQTT.
+ */
+class MqttAckClient : public Client {
+public:
+    static const size_t ACK_QUEUE_CAPACITY = 16;
+
+    explicit MqttAckClient(Client& inner) : inner(inner) {}
+
+    int connect(IPAddress ip, uint16_t port) override {
+        sniffer.reset();
+        return inner.connect(ip, port);
+    }
+    int connect(const char* host, uint16_t port) override {
+        sniffer.reset();
+        return inner.connect(host, port);
+    }
+    size_t write(uint8_t b) override { return inner.write(b); }
+    size_t write(const uint8_t* buf, size_t size) override { return inner.write(buf, size); }
+    int available() override { return inner.available(); }
+
+    int read() override {
+        int b = inner.read();
+        if (b >= 0) {
+            _observe((uint8_t)b);
+        }
+        return b;
+    }
+
+    int read(uint8_t* buf, size_t size) override {
+        int n = inner.read(buf, size);
+        for (int i = 0; i < n; ++i) {
+            _observe(buf[i]);
+        }
+        return n;
+    }
+
+    int peek() override { return inner.peek(); }
+    void flush() override { inner.flush(); }
+    void stop() override {
+        sniffer.reset();
+        inner.stop();
+    }
+    uint8_t connected() override { return inner.connected(); }
+    operator bool() override { return (bool)inner; }
+
+    /**
+     * @brief Retira o próximo PUBACK observado.
+     * @return false Se não há PUBACK pendente.
+     */
+    bool popAck(uint16_t& packetId) {
+        return acks.pop(packetId);
+    }
+
+    /**
+     * @brief Limpa o estado do parser (chamar ao abrir um socket novo fora de connect()).
+     */
+    void resetStream() {
+        sniffer.reset();
+        acks.clear();
+    }
+
+private:
+    void _observe(uint8_t b) {
+        uint16_t packetId;
+        if (sniffer.feed(b, packetId)) {
+            // Com a fila cheia o PUBACK se perde e a mensagem é retransmitida (duplicata, não perda)
+            acks.push(packetId);
+        }
+    }
+
+    Client& inner;
+    MqttPacketSniffer sniffer;
+    RingBuffer<uint16_t, ACK_QUEUE_CAPACITY> acks;
+};
+
+} // namespace GrowController
+
+#endif // MQTT_ACK_CLIENT_HPP
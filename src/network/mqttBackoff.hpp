@@ -0,0 +1,48 @@
+// src/network/mqttBackoff.hpp
+#ifndef MQTT_BACKOFF_HPP
+#define MQTT_BACKOFF_HPP
+
+#include <stdint.h>
+
+namespace GrowController {
+
+/**
+ * @brief Estados da conexão MQTT, avançados apenas pela tarefa MQTT.
+ */
+enum class MqttConnectionState : uint8_t {
+    WaitingForWiFi = 0, ///< Sem WiFi; nenhuma tentativa é feita
+    Backoff,            ///< Aguardando o instante da próxima tentativa
+    Connected           ///< CONNACK recebido, sessão ativa
+};
+
+/**
+ * @brief Teto do backoff exponencial: baseMs * 2^min(failures, maxDoublings), limitado a capMs.
+ */
+inline uint32_t backoffCeilingMs(uint8_t failures, uint32_t baseMs, uint32_t capMs, uint8_t maxDoublings) {
+    uint8_t doublings = failures < maxDoublings ? failures : maxDoublings;
+    if (doublings > 31) {
+        doublings = 31;
+    }
+    uint64_t ceiling = (uint64_t)baseMs << doublings;
+    return ceiling > capMs ? capMs : (uint32_t)ceiling;
+}
+
+/**
+ * @brief Atraso até a próxima tentativa de conexão ("full jitter").
+ * Sorteia uniformemente em [0, teto] para que vários dispositivos que caíram
+ * juntos (ex: reinício do broker) não reconectem todos no mesmo instante.
+ * @param failures Falhas consecutivas desde a última conexão bem-sucedida.
+ * @param randomValue Valor aleatório de 32 bits (ex: esp_random()).
+ */
+inline uint32_t computeBackoffMs(uint8_t failures, uint32_t baseMs, uint32_t capMs, uint8_t maxDoublings,
+                                 uint32_t randomValue) {
+    uint32_t ceiling = backoffCeilingMs(failures, baseMs, capMs, maxDoublings);
+    if (ceiling == UINT32_MAX) {
+        return randomValue;
+    }
+    return randomValue % (ceiling + 1);
+}
+
+} // namespace GrowController
+
+#endif // MQTT_BACKOFF_HPP
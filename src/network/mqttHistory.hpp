@@ -0,0 +1,138 @@
+// src/network/mqttHistory.hpp
+#ifndef MQTT_HISTORY_HPP
+#define MQTT_HISTORY_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include "data/historicDataPoint.hpp"
+
+namespace GrowController {
+
+/**
+ * @brief Único nível de histórico disponível: médias de 30 minutos (DataHistoryManager).
+ */
+static const char* const HISTORY_TIER_30MIN = "30min";
+
+/**
+ * @brief Estado de uma resposta de histórico em andamento (<room>/history/response).
+ */
+struct HistoryStream {
+    bool active = false;
+    char id[33] = {0};     // ID de correlação enviado pelo coletor
+    uint32_t cursor = 0;   // Cursor do último registro já examinado (ver historyCursor.hpp); 0 = início
+    uint32_t from = 0;     // Início do intervalo (inclusive)
+    uint32_t to = 0;       // Fim do intervalo (inclusive)
+    uint32_t seq = 0;      // Número do próximo chunk
+};
+
+/**
+ * @brief ID de correlação aceito: até 32 caracteres de [A-Za-z0-9._-] (vazio é permitido).
+ * Vai para o JSON sem escape, então nada que precise de escape passa daqui.
+ */
+inline bool isValidHistoryId(const char* id) {
+    if (id == nullptr) {
+        return false;
+    }
+    size_t length = 0;
+    for (const char* c = id; *c != '\0'; ++c, ++length) {
+        bool safe = (*c >= 'A' && *c <= 'Z') || (*c >= 'a' && *c <= 'z') || (*c >= '0' && *c <= '9') ||
+                    *c == '.' || *c == '_' || *c == '-';
+        if (!safe || length >= sizeof(HistoryStream::id) - 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace detail {
+// Acrescenta ",<valor>" (ou ",null" para NAN) em out[pos..size)
+inline bool appendHistoryValue(char* out, size_t size, size_t& pos, float value, int decimals) {
+    int len = isnan(value) ? snprintf(out + pos, size - pos, ",null")
+                           : snprintf(out + pos, size - pos, ",%.*f", decimals, (double)value);
+    if (len < 0 || (size_t)len >= size - pos) {
+        return false;
+    }
+    pos += (size_t)len;
+    return true;
+}
+} // namespace detail
+
+/**
+ * @brief Filtra por timestamp, no lugar, registros lidos em ordem de cursor (readSince).
+ * A paginação segue o cursor e não o timestamp: registros gravados antes do NTP podem
+ * estar fora de ordem e vários podem ter o mesmo timestamp, e nenhum deles é pulado.
+ * @param firstCursor Cursor de points[0]; os seguintes são consecutivos.
+ * @param cursors Recebe o cursor de cada registro mantido (mesmo índice em points).
+ * @return size_t Registros mantidos no início de points.
+ */
+inline size_t filterHistoryRange(HistoricDataPoint* points, size_t count, uint32_t firstCursor,
+                                 uint32_t from, uint32_t to, uint32_t* cursors) {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (points[i].timestamp < from || points[i].timestamp > to) {
+            continue;
+        }
+        points[kept] = points[i];
+        cursors[kept] = firstCursor + (uint32_t)i;
+        kept++;
+    }
+    return kept;
+}
+
+/**
+ * @brief Monta um chunk JSON da resposta de histórico em um buffer fixo:
+ * {"id":"..","seq":N,"tier":"30min","records":[[ts,temp,air,soil,vpd],...],"end":false}
+ * Inclui registros enquanto couberem (NAN vira null). O id deve passar em isValidHistoryId().
+ * @param consumed Recebe quantos registros de points entraram no chunk.
+ * @param end Marcador de fim de stream; só é aplicado se todos os registros couberem.
+ * @return size_t Tamanho do JSON, ou 0 se nem o envelope coube.
+ */
+inline size_t formatHistoryChunk(char* out, size_t size, const char* id, uint32_t seq,
+                                 const HistoricDataPoint* points, size_t count, bool end, size_t& consumed) {
+    consumed = 0;
+    static const size_t TRAILER_RESERVE = sizeof("],\"end\":false}");
+    if (out == nullptr || size <= TRAILER_RESERVE || !isValidHistoryId(id)) {
+        return 0;
+    }
+    const size_t limit = size - TRAILER_RESERVE; // Garante espaço para fechar o JSON
+    int len = snprintf(out, limit, "{\"id\":\"%s\",\"seq\":%lu,\"tier\":\"%s\",\"records\":[",
+                       id, (unsigned long)seq, HISTORY_TIER_30MIN);
+    if (len < 0 || (size_t)len >= limit) {
+        return 0;
+    }
+    size_t pos = (size_t)len;
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t start = pos;
+        const HistoricDataPoint& p = points[i];
+        len = snprintf(out + pos, limit - pos, "%s[%lu", i == 0 ? "" : ",", (unsigned long)p.timestamp);
+        bool ok = len >= 0 && (size_t)len < limit - pos;
+        if (ok) {
+            pos += (size_t)len;
+            ok = detail::appendHistoryValue(out, limit, pos, p.avgTemperature, 2) &&
+                 detail::appendHistoryValue(out, limit, pos, p.avgAirHumidity, 2) &&
+                 detail::appendHistoryValue(out, limit, pos, p.avgSoilHumidity, 2) &&
+                 detail::appendHistoryValue(out, limit, pos, p.avgVpd, 3) &&
+                 pos + 1 < limit;
+        }
+        if (!ok) {
+            pos = start; // Registro não coube: fica para o próximo chunk
+            break;
+        }
+        out[pos++] = ']';
+        consumed++;
+    }
+
+    bool isEnd = end && consumed == count;
+    len = snprintf(out + pos, size - pos, "],\"end\":%s}", isEnd ? "true" : "false");
+    if (len < 0 || (size_t)len >= size - pos) {
+        return 0;
+    }
+    return pos + (size_t)len;
+}
+
+} // namespace GrowController
+
+#endif // MQTT_HISTORY_HPP
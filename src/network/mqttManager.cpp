@@ -1,44 +1,62 @@
 // src/network/mqttManager.cpp
 #include "mqttManager.hpp"
-#include "utils/freeRTOSMutex.hpp" // Assumindo que usaremos nosso wrapper
 #include <Arduino.h>
 #include <WiFi.h>
 #include <ArduinoJson.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/select.h>
+#include "esp_vfs_eventfd.h"
+#include "esp_random.h"
+#include "utils/metrics.hpp"
 
 // --- Constantes ---
-const TickType_t MQTT_MUTEX_TIMEOUT = pdMS_TO_TICKS(200); // Timeout para operações MQTT
-const TickType_t MQTT_LOOP_DELAY_MS = pdMS_TO_TICKS(500); // Intervalo do loop principal da tarefa
-const TickType_t MQTT_RECONNECT_DELAY_MS = pdMS_TO_TICKS(5000); // Delay antes de tentar reconectar
-const uint8_t MQTT_CONNECT_RETRIES = 3; // Tentativas antes de um delay maior
+const uint8_t MQTT_MAX_PACKETS_PER_WAKE = 8; // Pacotes recebidos processados antes de voltar à outbox
+const uint32_t MQTT_RECONNECT_DELAY_MS = 5000; // Teto do backoff após a primeira falha (com jitter)
+const uint8_t MQTT_CONNECT_RETRIES = 3; // Falhas em que o teto dobra; depois fica fixo (5s -> 40s)
+const uint32_t MQTT_RECONNECT_MAX_MS = 60000; // Limite absoluto do backoff
+const int32_t MQTT_TCP_CONNECT_TIMEOUT_MS = 3000; // Timeout do connect() TCP
+const uint16_t MQTT_CONNACK_TIMEOUT_S = 3; // Timeout do handshake MQTT (socket timeout do PubSubClient)
+const uint16_t MQTT_BUFFER_SIZE = 600; // Buffer do PubSubClient (chunks de histórico + cabeçalho)
+const size_t MQTT_HISTORY_CHUNK_BYTES = 448; // Tamanho máximo do JSON de um chunk de histórico
+const size_t MQTT_HISTORY_CHUNK_RECORDS = 8; // Registros lidos do armazenamento por chunk
+const TickType_t MQTT_HISTORY_CHUNK_INTERVAL = pdMS_TO_TICKS(250); // Ritmo dos chunks (4/s)
+const TickType_t MQTT_QOS1_ACK_TIMEOUT = pdMS_TO_TICKS(10000); // Sem PUBACK nesse tempo: conexão considerada morta
+const TickType_t MQTT_BACKLOG_DRAIN_INTERVAL = pdMS_TO_TICKS(1000); // Janela entre lotes de reenvio
+const size_t MQTT_BACKLOG_BATCH = 8; // Máximo de leituras reenviadas por janela (8 msg/s)
+const time_t MIN_VALID_EPOCH = 1600000000; // Antes disso o relógio ainda não foi sincronizado
+const size_t MQTT_OUTBOX_BATCH = 16; // Máximo de mensagens da outbox escritas por iteração
+const TickType_t MQTT_STATS_LOG_INTERVAL = pdMS_TO_TICKS(60000); // Intervalo do log de métricas
 
 namespace GrowController {
 // --- Construtor / Destrutor ---
 
-MqttManager::MqttManager(const MQTTConfig& config, TargetDataManager& targetMgr) :
+MqttManager::MqttManager(const MQTTConfig& config, TargetDataManager& targetMgr, DataHistoryManager* historyMgr,
+                         RuntimeSettings* settings) :
     mqttConfig(config),
     targetDataManager(targetMgr),
-    pubSubClient(wifiClient), // Inicializa PubSubClient com WiFiClient
-    clientMutex(nullptr),     // Será criado no setup/initialize
-    taskHandle(nullptr),
+    dataHistoryManager(historyMgr),
+    runtimeSettings(settings),
+    ackClient(wifiClient),
+    pubSubClient(ackClient), // PubSubClient -> MqttAckClient -> WiFiClient
     isSetup(false)
 {
-    // Calcula e armazena os tópicos base e de controle para eficiência
-    baseTopic = String(mqttConfig.roomTopic);
-    controlTopic = baseTopic + "/control";
+    // A tabela de tópicos é montada em setup()
 }
 
 MqttManager::~MqttManager() {
     Serial.println("MqttManager: Destructor called.");
     // Parar a tarefa se estiver rodando
-    if (taskHandle != nullptr) {
+    TaskHandle_t handle = taskHandle.exchange(nullptr);
+    if (handle != nullptr) {
         Serial.println("MqttManager: Stopping MQTT task...");
-        vTaskDelete(taskHandle);
-        taskHandle = nullptr;
+        vTaskDelete(handle);
     }
-    // Deletar o mutex se foi criado
-    if (clientMutex != nullptr) {
-        vSemaphoreDelete(clientMutex);
-        clientMutex = nullptr;
+    if (wakeFd >= 0) {
+        close(wakeFd);
+        wakeFd = -1;
     }
     Serial.println("MqttManager: Destroyed.");
 }
@@ -52,26 +70,66 @@ void MqttManager::setup() {
     }
     Serial.println("MqttManager: Setting up...");
 
-    // 1. Criar Mutex
-    clientMutex = xSemaphoreCreateMutex();
-    if (clientMutex == nullptr) {
-        Serial.println("MqttManager ERROR: Failed to create client mutex!");
+    // 1. Montar a tabela de tópicos (única alocação de tópicos; publish() apenas consulta)
+    //    Não há mutex do cliente: apenas a tarefa MQTT toca no PubSubClient.
+    if (!topics.build(mqttConfig.roomTopic)) {
+        Serial.println("MqttManager ERROR: Failed to build topic table (room topic too long?)");
         return;
     }
-    Serial.println("MqttManager: Mutex created.");
+    Serial.printf("MqttManager: Topic table built for room '%s'.\n", topics.getBase());
+
+    // Fila store-and-forward (LittleFS já montado em main; se não estiver, opera só em RAM)
+    if (!storeForward.initialize()) {
+        Serial.println("MqttManager WARN: Store-and-forward spill file unavailable, buffering in RAM only.");
+    }
+
+    // Canal de despertar: o eventfd entra no mesmo select() do socket MQTT,
+    // então a tarefa dorme até chegar um comando ou uma mensagem na outbox.
+    esp_vfs_eventfd_config_t eventfdConfig = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    esp_err_t eventfdErr = esp_vfs_eventfd_register(&eventfdConfig);
+    if (eventfdErr == ESP_OK || eventfdErr == ESP_ERR_INVALID_STATE) { // INVALID_STATE: já registrado
+        wakeFd = eventfd(0, 0);
+    }
+    if (wakeFd < 0) {
+        Serial.println("MqttManager WARN: eventfd unavailable, MQTT task will wake on timeout/notifications only.");
+    }
+
+    // Filtro do deserializeJson: só as chaves que TargetDataManager entende
+    // são copiadas para o documento; o resto do payload é descartado no parse.
+    controlFilter["airHumidity"] = true;
+    controlFilter["vpd"] = true;
+    controlFilter["soilHumidity"] = true;
+    controlFilter["temperature"] = true;
+    controlFilter["lightOnTime"] = true;
+    controlFilter["lightOffTime"] = true;
+    controlFilter["humidityControl"] = true;
+    controlFilter["irrigationControl"] = true;
+    controlFilter["climateMode"] = true;
+    historyFilter["id"] = true;
+    historyFilter["from"] = true;
+    historyFilter["to"] = true;
+    historyFilter["tier"] = true;
 
     // 2. Configurar Servidor e Porta
     pubSubClient.setServer(mqttConfig.server, mqttConfig.port);
+    pubSubClient.setSocketTimeout(MQTT_CONNACK_TIMEOUT_S);
+    if (!pubSubClient.setBufferSize(MQTT_BUFFER_SIZE)) {
+        Serial.println("MqttManager WARN: Failed to grow PubSubClient buffer, history responses may not fit.");
+    }
     Serial.printf("MqttManager: Server set to %s:%d\n", mqttConfig.server, mqttConfig.port);
 
     // 3. Configurar Callback usando LAMBDA
-    pubSubClient.setClient(wifiClient); // Garante que o client está setado antes do callback
+    pubSubClient.setClient(ackClient); // Garante que o client está setado antes do callback
     pubSubClient.setCallback([this](char* topic, unsigned char* payload, unsigned int length) {
         // O lambda captura 'this' e chama o método de membro diretamente
         this->messageCallback(topic, payload, length);
     });
     Serial.println("MqttManager: Callback set using lambda.");
 
+    Serial.printf("MqttManager: Telemetry codec '%s', QoS %u.\n",
+                  telemetryCodecName(static_cast<TelemetryCodec>(mqttConfig.telemetryCodec)),
+                  (unsigned)mqttConfig.telemetryQos);
+
     // 4. Marcar como configurado
     isSetup = true;
     Serial.println("MqttManager: Setup complete.");
@@ -79,89 +137,426 @@ void MqttManager::setup() {
 
 // --- Callback de Membro (Lógica Real) ---
 void MqttManager::messageCallback(char* topic, unsigned char* payload, unsigned int length) {
-    Serial.println("===================================");
-    Serial.print("MqttManager: Message arrived on topic: ");
-    Serial.println(topic);
-
-    String message;
-    message.reserve(length);
-    for (unsigned int i = 0; i < length; i++) {
-        message += (char)payload[i];
-    }
-    Serial.print("MqttManager: Raw Message: ");
-    Serial.println(message);
-
-    if (String(topic) == this->controlTopic) {
-        Serial.println("MqttManager: Processing control message...");
-        JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, message);
-        if (error) {
-            Serial.print("MqttManager ERROR: JSON deserialization failed: ");
-            Serial.println(error.c_str());
-            return;
-        }
-        Serial.println("MqttManager: Deserialized OK, updating targets via TargetDataManager...");
-        bool updated = targetDataManager.updateTargetsFromJson(doc);
-        if (updated) {
-            Serial.println("MqttManager: Targets updated successfully by callback.");
-        } else {
-            Serial.println("MqttManager WARN: TargetDataManager reported no targets were updated from JSON.");
-        }
+    // topic é terminado em '\0' pelo PubSubClient; payload não, por isso o length é respeitado
+    if (strcmp(topic, topics.get(MqttTopic::HistoryRequest)) == 0) {
+        _handleHistoryRequest(payload, length);
+        return;
+    }
+    if (strcmp(topic, topics.get(MqttTopic::Config)) == 0) {
+        _handleConfigMessage(payload, length);
+        return;
+    }
+    if (strcmp(topic, topics.get(MqttTopic::Control)) != 0) {
+        Serial.printf("MqttManager: Message on '%s' ignored (topic mismatch).\n", topic);
+        return;
+    }
+
+    Serial.printf("MqttManager: Processing control message (%u bytes)...\n", length);
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, (const uint8_t*)payload, length,
+                                                 DeserializationOption::Filter(controlFilter));
+    if (error) {
+        Serial.print("MqttManager ERROR: JSON deserialization failed: ");
+        Serial.println(error.c_str());
+        return;
+    }
+
+    bool updated = targetDataManager.updateTargetsFromJson(doc);
+    if (updated) {
+        Serial.println("MqttManager: Targets updated successfully by callback.");
+    } else {
+        Serial.println("MqttManager WARN: TargetDataManager reported no targets were updated from JSON.");
+    }
+}
+
+
+// --- Ajuste de intervalos em tempo de execução ---
+
+void MqttManager::_handleConfigMessage(const unsigned char* payload, unsigned int length) {
+    if (runtimeSettings == nullptr) {
+        return;
+    }
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, payload, length);
+    if (error) {
+        Serial.print("MqttManager ERROR: Config JSON deserialization failed: ");
+        Serial.println(error.c_str());
+        _publishConfigState("invalid JSON");
+        return;
+    }
+
+    char errorMessage[80] = {0};
+    if (runtimeSettings->updateFromJson(doc, errorMessage, sizeof(errorMessage))) {
+        Serial.println("MqttManager: Runtime rates updated by config message.");
+        _publishConfigState(nullptr);
     } else {
-        Serial.println("MqttManager: Message ignored (topic mismatch).");
+        Serial.printf("MqttManager WARN: Config message rejected: %s\n", errorMessage);
+        _publishConfigState(errorMessage);
+    }
+}
+
+void MqttManager::_publishConfigState(const char* error) {
+    if (runtimeSettings == nullptr) {
+        return;
+    }
+    JsonDocument doc;
+    runtimeSettings->toJson(doc);
+    doc["version"] = runtimeSettings->getVersion();
+    doc["ok"] = (error == nullptr);
+    if (error != nullptr) {
+        doc["error"] = error;
+    }
+    char payload[320];
+    size_t len = serializeJson(doc, payload, sizeof(payload));
+    if (len == 0 || len >= sizeof(payload)) {
+        Serial.println("MqttManager WARN: Config state does not fit the payload buffer.");
+        return;
+    }
+    _sendToBroker(topics.get(MqttTopic::ConfigState), (const uint8_t*)payload, len, true); // Retained
+}
+
+
+// --- Backfill de histórico ---
+
+void MqttManager::_handleHistoryRequest(const unsigned char* payload, unsigned int length) {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, payload, length, DeserializationOption::Filter(historyFilter));
+    if (error) {
+        Serial.print("MqttManager ERROR: History request JSON deserialization failed: ");
+        Serial.println(error.c_str());
+        return;
+    }
+
+    const char* id = doc["id"] | "";
+    if (!isValidHistoryId(id)) {
+        // O id volta sem escape em toda resposta: aspas, '\' ou controle quebrariam o JSON
+        Serial.println("MqttManager WARN: History request id invalid (allowed: A-Z a-z 0-9 . _ -, max 32).");
+        _sendHistoryError("", 0, "invalid id");
+        return;
+    }
+    const char* tier = doc["tier"] | HISTORY_TIER_30MIN;
+    if (strcmp(tier, HISTORY_TIER_30MIN) != 0) {
+        _sendHistoryError(id, 0, "unsupported tier");
+        return;
+    }
+    if (dataHistoryManager == nullptr) {
+        _sendHistoryError(id, 0, "history unavailable");
+        return;
+    }
+    uint32_t from = doc["from"] | 0UL;
+    uint32_t to = doc["to"] | (unsigned long)UINT32_MAX;
+    if (from > to) {
+        _sendHistoryError(id, 0, "invalid range");
+        return;
+    }
+
+    if (historyStream.active) {
+        Serial.printf("MqttManager WARN: History request '%s' supersedes '%s'.\n", id, historyStream.id);
+        _sendHistoryError(historyStream.id, historyStream.seq, "superseded");
+    }
+    historyStream.active = true;
+    snprintf(historyStream.id, sizeof(historyStream.id), "%s", id);
+    historyStream.cursor = 0;
+    historyStream.from = from;
+    historyStream.to = to;
+    historyStream.seq = 0;
+    lastHistoryChunkTick = xTaskGetTickCount() - MQTT_HISTORY_CHUNK_INTERVAL; // Primeiro chunk já no próximo ciclo
+    Serial.printf("MqttManager: History request '%s' accepted (%lu..%lu).\n", id,
+                  (unsigned long)from, (unsigned long)to);
+}
+
+void MqttManager::_serviceHistoryStream() {
+    if (!historyStream.active || !_isMqttConnected() || !outbox.emptyApprox()) {
+        return; // Dados ao vivo têm prioridade sobre o backfill
+    }
+    TickType_t nowTick = xTaskGetTickCount();
+    if (nowTick - lastHistoryChunkTick < MQTT_HISTORY_CHUNK_INTERVAL) {
+        return;
+    }
+    lastHistoryChunkTick = nowTick;
+
+    // Varre o buffer circular pelo cursor até juntar um chunk de registros no intervalo pedido
+    HistoricDataPoint points[MQTT_HISTORY_CHUNK_RECORDS];
+    uint32_t cursors[MQTT_HISTORY_CHUNK_RECORDS];
+    size_t read = 0;
+    uint32_t scanCursor = historyStream.cursor;
+    bool lastChunk = false;
+    while (read < MQTT_HISTORY_CHUNK_RECORDS && !lastChunk) {
+        HistoryWindow window = {0, 0, 0, false};
+        uint32_t lastCursor = scanCursor;
+        size_t got = dataHistoryManager->readSince(scanCursor, points + read, MQTT_HISTORY_CHUNK_RECORDS - read,
+                                                   &lastCursor, &window);
+        read += filterHistoryRange(points + read, got, window.firstCursor, historyStream.from, historyStream.to,
+                                   cursors + read);
+        lastChunk = got == 0 || got == window.count || window.reset; // Chegou ao registro mais novo
+        scanCursor = lastCursor;
+    }
+
+    char chunk[MQTT_HISTORY_CHUNK_BYTES];
+    size_t consumed = 0;
+    size_t length = formatHistoryChunk(chunk, sizeof(chunk), historyStream.id, historyStream.seq,
+                                       points, read, lastChunk, consumed);
+    if (length == 0 || (consumed == 0 && read > 0)) {
+        Serial.println("MqttManager ERROR: History chunk does not fit, aborting stream.");
+        _sendHistoryError(historyStream.id, historyStream.seq, "chunk overflow");
+        historyStream.active = false;
+        return;
+    }
+    if (!_sendToBroker(topics.get(MqttTopic::HistoryResponse), chunk, false)) {
+        return; // Tenta o mesmo chunk de novo no próximo intervalo
+    }
+
+    historyStream.seq++;
+    // Tudo enviado: continua depois do último registro examinado; senão, depois do último que coube
+    historyStream.cursor = consumed == read ? scanCursor : cursors[consumed - 1];
+    if (lastChunk && consumed == read) {
+        Serial.printf("MqttManager: History stream '%s' finished (%lu chunks).\n",
+                      historyStream.id, (unsigned long)historyStream.seq);
+        historyStream.active = false;
+    }
+}
+
+void MqttManager::_sendHistoryError(const char* id, uint32_t seq, const char* error) {
+    if (!isValidHistoryId(id)) {
+        id = ""; // Nunca ecoa um id que precisaria de escape
+    }
+    char payload[96];
+    int len = snprintf(payload, sizeof(payload), "{\"id\":\"%s\",\"seq\":%lu,\"error\":\"%s\",\"end\":true}",
+                       id, (unsigned long)seq, error);
+    if (len < 0 || (size_t)len >= sizeof(payload)) {
+        return;
+    }
+    _sendToBroker(topics.get(MqttTopic::HistoryResponse), payload, false);
+}
+
+// --- Publicação (produtores) ---
+
+bool MqttManager::publish(MqttTopic topic, float value, bool retained) {
+    MqttOutboxItem item;
+    TelemetryCodec codec = static_cast<TelemetryCodec>(mqttConfig.telemetryCodec);
+    if (!encodeTelemetryItem(item, topic, value, codec, mqttConfig.telemetryQos, retained)) {
+        outbox.countDropped();
+        Metrics::mqttOutboxDropped.inc();
+        return false;
+    }
+    return _enqueue(item);
+}
+
+bool MqttManager::publish(MqttTopic topic, const char* payload, bool retained) {
+    if (payload == nullptr) {
+        return false;
+    }
+    MqttOutboxItem item;
+    if (!encodeTextItem(item, topic, payload, retained)) {
+        Serial.printf("MqttManager ERROR: Payload too large for outbox (%u bytes).\n", (unsigned)strlen(payload));
+        outbox.countDropped();
+        Metrics::mqttOutboxDropped.inc();
+        return false;
+    }
+    return _enqueue(item);
+}
+
+bool MqttManager::_enqueue(const MqttOutboxItem& item) {
+    if (!isSetup) {
+        Serial.println("MqttManager ERROR: Cannot publish, not setup.");
+        return false;
     }
-     Serial.println("===================================");
+    if (!outbox.push(item, (uint32_t)micros())) {
+        Metrics::mqttOutboxDropped.inc();
+        return false;
+    }
+    _wakeTask();
+    return true;
 }
 
+MqttOutboxStats MqttManager::getOutboxStats() const {
+    MqttOutboxStats stats;
+    stats.depth = (uint32_t)outbox.sizeApprox();
+    stats.maxDepth = outbox.maxDepth();
+    stats.enqueued = outbox.enqueued();
+    stats.dropped = outbox.dropped();
+    stats.sent = statSent.load(std::memory_order_relaxed);
+    stats.inflight = statInflight.load(std::memory_order_relaxed);
+    stats.acked = statAcked.load(std::memory_order_relaxed);
+    stats.retransmitted = statRetransmits.load(std::memory_order_relaxed);
+    stats.lastLatencyUs = statLastLatencyUs.load(std::memory_order_relaxed);
+    stats.maxLatencyUs = statMaxLatencyUs.load(std::memory_order_relaxed);
+    stats.avgLatencyUs = statAvgLatencyUs.load(std::memory_order_relaxed);
+    return stats;
+}
 
-// --- Publicação ---
-// Função privada que não bloqueia o mutex, assume que já está bloqueado
-bool MqttManager::_publish_nolock(const char* fullTopic, const char* payload, bool retained) {
-    if (pubSubClient.connected()) {
-        if (pubSubClient.publish(fullTopic, payload, retained)) {
-            // Serial.printf("MqttManager (nolock): Published [%s]: %s\n", fullTopic, payload); // Log opcional
+// --- Envio (apenas tarefa MQTT) ---
+
+bool MqttManager::_sendToBroker(const char* fullTopic, const uint8_t* payload, size_t length, bool retained) {
+    if (_isMqttConnected()) {
+        if (pubSubClient.publish(fullTopic, payload, (unsigned int)length, retained)) {
             return true;
         } else {
-            Serial.print("MqttManager ERROR (nolock): Publish Failed! State: ");
+            Serial.print("MqttManager ERROR: Publish Failed! State: ");
             Serial.println(pubSubClient.state());
-            Serial.printf("  Topic: %s, Payload: %s\n", fullTopic, payload);
+            Serial.printf("  Topic: %s, Payload: %u bytes\n", fullTopic, (unsigned)length);
             return false;
         }
     } else {
-        Serial.print("MqttManager WARN (nolock): Cannot publish, client not connected. Topic: ");
+        Serial.print("MqttManager WARN: Cannot publish, client not connected. Topic: ");
         Serial.println(fullTopic);
         return false;
     }
 }
 
-bool MqttManager::publish(const char* subTopic, float value, bool retained) {
-    char messageBuffer[16];
-    snprintf(messageBuffer, sizeof(messageBuffer), "%.2f", value);
-    return publish(subTopic, messageBuffer, retained);
+size_t MqttManager::_drainOutbox() {
+    size_t drained = 0;
+    MqttOutboxItem item;
+    // Escreve o lote inteiro antes de voltar ao loop() do PubSubClient
+    while (drained < MQTT_OUTBOX_BATCH) {
+        bool connected = _isMqttConnected();
+        if (connected && inflight.full()) {
+            break; // Janela QoS 1 cheia: o resto espera na outbox pelos PUBACKs
+        }
+        if (!outbox.tryPop(item)) {
+            break;
+        }
+        drained++;
+
+        bool sent = false;
+        if (connected && item.qos == 1) {
+            auto* entry = inflight.add(item, xTaskGetTickCount());
+            sent = entry != nullptr && _sendQos1(entry->message, entry->packetId, false);
+            if (!sent && entry != nullptr) {
+                inflight.acknowledge(entry->packetId); // Nada saiu inteiro: a leitura vai para o store-and-forward
+            }
+            statInflight.store((uint32_t)inflight.size(), std::memory_order_relaxed);
+        } else if (connected) {
+            sent = _sendToBroker(topics.get(item.topic), (const uint8_t*)item.payload, item.length, item.retained);
+        }
+        if (!sent) {
+            if (connected) Metrics::mqttPublishFailed.inc(); // Offline não é falha: a telemetria vai para o store-and-forward
+            if (item.isTelemetry) {
+                _storeForLater(item.topic, item.value); // Não perde a leitura
+            }
+            continue;
+        }
+
+        Metrics::mqttPublishOk.inc();
+        uint32_t latency = (uint32_t)micros() - item.enqueuedAtUs;
+        statSent.fetch_add(1, std::memory_order_relaxed);
+        statLastLatencyUs.store(latency, std::memory_order_relaxed);
+        if (latency > statMaxLatencyUs.load(std::memory_order_relaxed)) {
+            statMaxLatencyUs.store(latency, std::memory_order_relaxed); // Único escritor: a tarefa MQTT
+        }
+        uint32_t avg = statAvgLatencyUs.load(std::memory_order_relaxed);
+        statAvgLatencyUs.store(avg - (avg >> 3) + (latency >> 3), std::memory_order_relaxed);
+    }
+    return drained;
 }
 
-bool MqttManager::publish(const char* subTopic, const char* payload, bool retained) {
-    if (!isSetup) {
-        Serial.println("MqttManager ERROR: Cannot publish, not setup.");
+// --- QoS 1 ---
+
+bool MqttManager::_sendQos1(const MqttOutboxItem& item, uint16_t packetId, bool dup) {
+    uint8_t packet[5 + 2 + MqttTopicTable::MAX_TOPIC_LENGTH + 2 + sizeof(item.payload)];
+    size_t length = encodeQos1Publish(packet, sizeof(packet), topics.get(item.topic), item.payload,
+                                      item.length, packetId, item.retained, dup);
+    if (length == 0) {
+        Serial.printf("MqttManager ERROR: Failed to encode QoS 1 publish (packet id %u).\n", (unsigned)packetId);
         return false;
     }
-     if (clientMutex == nullptr) {
-         Serial.println("MqttManager ERROR: Cannot publish, mutex is null.");
-         return false;
-     }
-
-    bool success = false;
-    if (xSemaphoreTake(clientMutex, MQTT_MUTEX_TIMEOUT) == pdTRUE) {
-        // A função publish pública agora chama _publish_nolock,
-        // então não há necessidade de verificar pubSubClient.connected() aqui novamente,
-        // pois _publish_nolock já faz isso.
-        String fullTopic = baseTopic + "/" + subTopic;
-        success = _publish_nolock(fullTopic.c_str(), payload, retained); // Usa a versão _nolock
-        xSemaphoreGive(clientMutex);
-    } else {
-        Serial.println("MqttManager WARN: Could not acquire mutex for publish.");
+    if (ackClient.write(packet, length) != length) {
+        Serial.printf("MqttManager ERROR: QoS 1 publish write failed (packet id %u).\n", (unsigned)packetId);
+        return false;
+    }
+    return true;
+}
+
+void MqttManager::_processAcks() {
+    uint16_t packetId;
+    while (ackClient.popAck(packetId)) {
+        if (inflight.acknowledge(packetId)) {
+            statAcked.fetch_add(1, std::memory_order_relaxed);
+        }
+        // PUBACK de um ID que não está em voo: duplicata de uma retransmissão, ignorado
+    }
+    statInflight.store((uint32_t)inflight.size(), std::memory_order_relaxed);
+}
+
+void MqttManager::_retransmitInflight() {
+    if (inflight.empty()) {
+        return;
+    }
+    Serial.printf("MqttManager: Retransmitting %u unacknowledged QoS 1 publishes.\n", (unsigned)inflight.size());
+    TickType_t now = xTaskGetTickCount();
+    inflight.forEachOldestFirst([this, now](MqttInflightWindow<MqttOutboxItem, MQTT_QOS1_WINDOW>::Entry& entry) {
+        // Mesmo packet ID com DUP=1; se a escrita falhar, a próxima reconexão tenta de novo
+        if (_sendQos1(entry.message, entry.packetId, true)) {
+            entry.sentAt = now;
+            statRetransmits.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+}
+
+void MqttManager::_checkAckTimeout() {
+    const auto* oldest = inflight.oldest();
+    if (oldest == nullptr || xTaskGetTickCount() - oldest->sentAt < MQTT_QOS1_ACK_TIMEOUT) {
+        return;
+    }
+    Serial.printf("MqttManager WARN: No PUBACK for packet id %u, dropping connection to retransmit.\n",
+                  (unsigned)oldest->packetId);
+    ackClient.stop(); // ensureConnection() detecta a queda e reconecta com backoff
+}
+
+void MqttManager::_logOutboxStats() {
+    TickType_t nowTick = xTaskGetTickCount();
+    if (nowTick - lastStatsLogTick < MQTT_STATS_LOG_INTERVAL) {
+        return;
+    }
+    lastStatsLogTick = nowTick;
+    MqttOutboxStats stats = getOutboxStats();
+    Serial.printf("MqttManager: Outbox depth=%u max=%u enqueued=%u sent=%u dropped=%u qos1 inflight=%u acked=%u retx=%u latency(us) last=%u avg=%u max=%u backlog=%u\n",
+                  (unsigned)stats.depth, (unsigned)stats.maxDepth, (unsigned)stats.enqueued, (unsigned)stats.sent,
+                  (unsigned)stats.dropped, (unsigned)stats.inflight, (unsigned)stats.acked, (unsigned)stats.retransmitted, (unsigned)stats.lastLatencyUs, (unsigned)stats.avgLatencyUs,
+                  (unsigned)stats.maxLatencyUs, (unsigned)storeForward.size());
+}
+
+// --- Store-and-forward ---
+
+bool MqttManager::_storeForLater(MqttTopic topic, float value) {
+    time_t now = time(nullptr);
+    uint32_t timestamp = (now >= MIN_VALID_EPOCH) ? (uint32_t)now : 0;
+    if (!storeForward.enqueue(topic, value, timestamp)) {
+        Serial.printf("MqttManager WARN: Store-and-forward queue full, oldest reading dropped (total dropped: %u).\n",
+                      (unsigned)storeForward.getDroppedCount());
+        return false;
+    }
+    return true;
+}
+
+void MqttManager::_drainBacklog() {
+    TickType_t nowTick = xTaskGetTickCount();
+    if (nowTick - lastBacklogDrainTick < MQTT_BACKLOG_DRAIN_INTERVAL) {
+        return; // Limita a taxa de reenvio
+    }
+    lastBacklogDrainTick = nowTick;
+    if (storeForward.empty()) {
+        return;
+    }
+
+    size_t sent = storeForward.drain(MQTT_BACKLOG_BATCH, [this](const QueuedReading& reading) {
+        if (!outbox.emptyApprox()) {
+            return false; // Dados ao vivo têm prioridade
+        }
+        char payload[96];
+        int len = snprintf(payload, sizeof(payload), "{\"topic\":\"%s\",\"ts\":%lu,\"value\":%.2f}",
+                           MqttTopicTable::subTopicOf(static_cast<MqttTopic>(reading.topic)),
+                           (unsigned long)reading.timestamp, reading.value);
+        if (len < 0 || (size_t)len >= sizeof(payload)) {
+            return true; // Registro inválido: descarta
+        }
+        return _sendToBroker(topics.get(MqttTopic::SensorsBacklog), payload, false);
+    });
+
+    if (sent > 0) {
+        Serial.printf("MqttManager: Replayed %u stored readings, %u pending.\n",
+                      (unsigned)sent, (unsigned)storeForward.size());
     }
-    return success;
 }
 
 // --- Gerenciamento da Tarefa ---
@@ -184,88 +579,232 @@ void MqttManager::run() {
         return;
     }
 
+    taskHandle.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+    if (runtimeSettings) {
+        runtimeSettings->addListener(xTaskGetCurrentTaskHandle()); // Acorda para aplicar o novo intervalo
+    }
     Serial.println("MqttManager: Task run loop started.");
     while (true) {
         if (WiFi.status() == WL_CONNECTED) {
             ensureConnection(); // Tenta conectar/reconectar se necessário
 
-            // Loop do cliente MQTT (se conectado)
-            if (pubSubClient.connected()) {
-                 if (clientMutex && xSemaphoreTake(clientMutex, MQTT_MUTEX_TIMEOUT) == pdTRUE) {
-                      if(pubSubClient.connected()) { // Double check connection inside mutex
-                         if (!pubSubClient.loop()) { // Processa mensagens recebidas e mantém a conexão
-                            Serial.println("MqttManager WARN: pubSubClient.loop() returned false. Possible disconnection.");
-                         }
-                      }
-                      xSemaphoreGive(clientMutex);
-                 } // else { Serial.println("MqttManager WARN: Failed acquire mutex for loop."); }
+            // Processa mensagens recebidas e mantém a conexão (keepalive)
+            if (_isMqttConnected()) {
+                _serviceSocket();
+                _processAcks();
+                _checkAckTimeout();
             }
-        } else {
-             // Se o WiFi desconectar, desconecta o cliente MQTT também
-             if (pubSubClient.connected()) {
-                 if (clientMutex && xSemaphoreTake(clientMutex, MQTT_MUTEX_TIMEOUT) == pdTRUE) {
-                     Serial.println("MqttManager INFO: WiFi disconnected, disconnecting MQTT client.");
-                     pubSubClient.disconnect();
-                     xSemaphoreGive(clientMutex);
-                 }
-             }
+        } else if (connectionState != MqttConnectionState::WaitingForWiFi) {
+            // Se o WiFi desconectar, desconecta o cliente MQTT também
+            Serial.println("MqttManager INFO: WiFi disconnected, disconnecting MQTT client.");
+            pubSubClient.disconnect();
+            wifiClient.stop();
+            connectionState = MqttConnectionState::WaitingForWiFi;
         }
-        vTaskDelay(MQTT_LOOP_DELAY_MS);
+
+        // Outbox primeiro (dados ao vivo); sem conexão, a telemetria vai para o store-and-forward
+        _drainOutbox();
+        Metrics::mqttOutboxDepth.set((int32_t)outbox.sizeApprox());
+        Metrics::mqttConnected.set(_isMqttConnected() ? 1 : 0);
+
+        // Reenvio paced da telemetria guardada durante a queda, só com a outbox vazia
+        if (_isMqttConnected() && outbox.emptyApprox()) {
+            _drainBacklog();
+        }
+
+        // Backfill de histórico pedido pelo coletor, em chunks espaçados
+        _serviceHistoryStream();
+
+        _logOutboxStats();
+
+        // Dorme até o socket ter dados, a outbox ser alimentada ou o timeout de manutenção
+        // Espera ociosa máxima (keepalive, backlog, métricas) ajustável em <room>/config
+        TickType_t idleWait = pdMS_TO_TICKS(runtimeSettings ? runtimeSettings->getRates().mqttServiceIntervalMs
+                                                            : RuntimeRates().mqttServiceIntervalMs);
+        _waitForWork(historyStream.active ? MQTT_HISTORY_CHUNK_INTERVAL : idleWait);
+    }
+}
+
+void MqttManager::_serviceSocket() {
+    // PubSubClient::loop() lê no máximo um pacote por chamada; esvazia o que já chegou
+    for (uint8_t i = 0; i < MQTT_MAX_PACKETS_PER_WAKE; ++i) {
+        if (!pubSubClient.loop()) {
+            Serial.println("MqttManager WARN: pubSubClient.loop() returned false. Possible disconnection.");
+            return;
+        }
+        if (wifiClient.available() <= 0) {
+            return;
+        }
+    }
+}
+
+void MqttManager::_wakeTask() {
+    if (wakeFd >= 0) {
+        uint64_t one = 1;
+        (void)write(wakeFd, &one, sizeof(one)); // Falha só se já houver despertar pendente
+    }
+    TaskHandle_t handle = taskHandle.load(std::memory_order_acquire);
+    if (handle != nullptr) {
+        xTaskNotifyGive(handle); // Cobre a espera sem socket (desconectado)
     }
 }
 
+void MqttManager::_waitForWork(TickType_t maxWait) {
+    if (!outbox.emptyApprox() && !(inflight.full() && _isMqttConnected())) {
+        return; // Ainda há lote pendente (com a janela cheia, espera o PUBACK no select())
+    }
+
+    int sock = _isMqttConnected() ? wifiClient.fd() : -1;
+    if (sock < 0 || wakeFd < 0) {
+        ulTaskNotifyTake(pdTRUE, maxWait);
+        return;
+    }
+    if (wifiClient.available() > 0) {
+        return; // Bytes já no buffer do WiFiClient não tornam o socket legível
+    }
+
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(sock, &readSet);
+    FD_SET(wakeFd, &readSet);
+    uint32_t waitMs = (uint32_t)maxWait * portTICK_PERIOD_MS;
+    struct timeval timeout;
+    timeout.tv_sec = waitMs / 1000;
+    timeout.tv_usec = (waitMs % 1000) * 1000;
+
+    int ready = select((sock > wakeFd ? sock : wakeFd) + 1, &readSet, nullptr, nullptr, &timeout);
+    if (ready < 0) {
+        Serial.printf("MqttManager WARN: select() failed (errno %d), falling back to timed wait.\n", errno);
+        ulTaskNotifyTake(pdTRUE, maxWait);
+        return;
+    }
+    if (ready > 0 && FD_ISSET(wakeFd, &readSet)) {
+        uint64_t counter;
+        (void)read(wakeFd, &counter, sizeof(counter)); // Zera o contador do eventfd
+    }
+    ulTaskNotifyTake(pdTRUE, 0); // Descarta notificações já cobertas por este despertar
+}
+
 // --- Lógica de Conexão ---
-void MqttManager::ensureConnection() {
-     if (!isSetup || clientMutex == nullptr) {
-         return;
-     }
+bool MqttManager::_isMqttConnected() {
+    // O estado só vira Connected depois de _onConnected() (presença, assinaturas); connected()
+    // confere o socket, que pode ter caído desde a última passada de ensureConnection()
+    return connectionState == MqttConnectionState::Connected && pubSubClient.connected();
+}
 
-    // Se já estiver conectado, não faz nada
-    if (pubSubClient.connected()) {
+void MqttManager::ensureConnection() {
+    if (!isSetup) {
         return;
     }
 
-    // Tenta adquirir o mutex para a operação de conexão
-    if (xSemaphoreTake(clientMutex, MQTT_MUTEX_TIMEOUT) == pdTRUE) {
-        // Double-check a conexão DENTRO do mutex, caso outra tarefa tenha conectado enquanto esperava
-        if (!pubSubClient.connected()) {
-            Serial.print("MqttManager: Attempting MQTT connection to ");
-            Serial.print(mqttConfig.server); Serial.print(":"); Serial.print(mqttConfig.port);
-            Serial.print(" as client '"); Serial.print(mqttConfig.clientId); Serial.println("'...");
-
-            // Tenta conectar
-            if (pubSubClient.connect(mqttConfig.clientId)) {
-                Serial.println("MqttManager: Connection successful!");
-
-                // Publish Presence (usando _publish_nolock pois o mutex já está bloqueado)
-                String presenceSubTopic = "devices"; // Subtópico para presença
-                String fullPresenceTopic = baseTopic + "/" + presenceSubTopic; // Tópico completo: <roomTopic>/devices
-                
-                // O payload da mensagem de presença será o ID do cômodo (baseTopic)
-                if (_publish_nolock(fullPresenceTopic.c_str(), baseTopic.c_str(), true)) { // Retained = true
-                    Serial.printf("MqttManager: Published presence to '%s': %s\n", fullPresenceTopic.c_str(), baseTopic.c_str());
-                } else {
-                    Serial.println("MqttManager WARN: Failed to publish presence message after connect.");
-                }
+    switch (connectionState) {
+        case MqttConnectionState::WaitingForWiFi:
+            // WiFi acabou de voltar: primeira tentativa já com jitter (dispositivos
+            // que perderam o mesmo AP/broker não reconectam todos juntos)
+            connectFailures = 0;
+            _scheduleReconnect();
+            return;
 
-                // Subscribe to Control Topic
-                Serial.print("MqttManager: Subscribing to control topic: ");
-                Serial.println(controlTopic);
-                if (pubSubClient.subscribe(controlTopic.c_str())) {
-                    Serial.println("MqttManager: Subscription successful.");
-                } else {
-                    Serial.println("MqttManager WARN: Failed to subscribe to control topic!");
-                }
+        case MqttConnectionState::Connected:
+            if (pubSubClient.connected()) {
+                return;
+            }
+            Serial.printf("MqttManager WARN: Connection lost, state=%d.\n", pubSubClient.state());
+            wifiClient.stop();
+            connectFailures = 0;
+            _scheduleReconnect();
+            return;
 
+        case MqttConnectionState::Backoff:
+            if ((int32_t)(xTaskGetTickCount() - nextConnectTick) < 0) {
+                return; // Ainda não é hora
+            }
+            if (_attemptConnect()) {
+                connectionState = MqttConnectionState::Connected;
+                connectFailures = 0;
+                _onConnected();
             } else {
-                Serial.print("MqttManager ERROR: Connection Failed, state= ");
-                Serial.print(pubSubClient.state());
-                Serial.println(". Retrying later.");
-                // Não há delay aqui, o loop run() já tem um vTaskDelay
+                if (connectFailures < UINT8_MAX) {
+                    connectFailures++;
+                }
+                _scheduleReconnect();
             }
+            return;
+    }
+}
+
+bool MqttManager::_attemptConnect() {
+    Serial.print("MqttManager: Attempting MQTT connection to ");
+    Serial.print(mqttConfig.server); Serial.print(":"); Serial.print(mqttConfig.port);
+    Serial.print(" as client '"); Serial.print(mqttConfig.clientId); Serial.println("'...");
+
+    // 1. TCP com timeout próprio (o connect() do PubSubClient usaria o padrão do WiFiClient)
+    ackClient.resetStream();
+    if (!wifiClient.connect(mqttConfig.server, mqttConfig.port, MQTT_TCP_CONNECT_TIMEOUT_MS)) {
+        Serial.println("MqttManager ERROR: TCP connect failed or timed out.");
+        wifiClient.stop();
+        return false;
+    }
+
+    // 2. Handshake MQTT: com o socket já aberto, o PubSubClient só envia CONNECT
+    //    e espera o CONNACK por até MQTT_CONNACK_TIMEOUT_S.
+    if (!pubSubClient.connect(mqttConfig.clientId)) {
+        Serial.print("MqttManager ERROR: Connection Failed, state= ");
+        Serial.println(pubSubClient.state());
+        wifiClient.stop();
+        return false;
+    }
+
+    Serial.println("MqttManager: Connection successful!");
+    return true;
+}
+
+void MqttManager::_scheduleReconnect() {
+    uint32_t delayMs = computeBackoffMs(connectFailures, MQTT_RECONNECT_DELAY_MS, MQTT_RECONNECT_MAX_MS,
+                                        MQTT_CONNECT_RETRIES, esp_random());
+    nextConnectTick = xTaskGetTickCount() + pdMS_TO_TICKS(delayMs);
+    connectionState = MqttConnectionState::Backoff;
+    Serial.printf("MqttManager: Next connection attempt in %lu ms (consecutive failures: %u).\n",
+                  (unsigned long)delayMs, (unsigned)connectFailures);
+}
+
+void MqttManager::_onConnected() {
+    // Publish Presence
+    // Tópico: <roomTopic>/devices; o payload da presença é o ID do cômodo (base)
+    const char* presenceTopic = topics.get(MqttTopic::Devices);
+    if (_sendToBroker(presenceTopic, topics.getBase(), true)) { // Retained = true
+        Serial.printf("MqttManager: Published presence to '%s': %s\n", presenceTopic, topics.getBase());
+    } else {
+        Serial.println("MqttManager WARN: Failed to publish presence message after connect.");
+    }
+
+    // Subscribe to Control Topic
+    Serial.print("MqttManager: Subscribing to control topic: ");
+    Serial.println(topics.get(MqttTopic::Control));
+    if (pubSubClient.subscribe(topics.get(MqttTopic::Control))) {
+        Serial.println("MqttManager: Subscription successful.");
+    } else {
+        Serial.println("MqttManager WARN: Failed to subscribe to control topic!");
+    }
+
+    if (pubSubClient.subscribe(topics.get(MqttTopic::HistoryRequest))) {
+        Serial.printf("MqttManager: Subscribed to history requests: %s\n", topics.get(MqttTopic::HistoryRequest));
+    } else {
+        Serial.println("MqttManager WARN: Failed to subscribe to history request topic!");
+    }
+
+    if (runtimeSettings != nullptr) {
+        if (pubSubClient.subscribe(topics.get(MqttTopic::Config))) {
+            Serial.printf("MqttManager: Subscribed to config topic: %s\n", topics.get(MqttTopic::Config));
+        } else {
+            Serial.println("MqttManager WARN: Failed to subscribe to config topic!");
         }
-        xSemaphoreGive(clientMutex); // Libera o mutex
-    } // else { Serial.println("MqttManager WARN: Could not acquire mutex for connection attempt."); }
+        _publishConfigState(nullptr); // Estado atual para quem acabou de conectar
+    }
+
+    // QoS 1 ainda sem PUBACK da sessão anterior (clean session: o broker trata como
+    // nova publicação; entrega "pelo menos uma vez")
+    _retransmitInflight();
 }
 
-} // namespace GrowController
\ No newline at end of file
+} // namespace GrowController
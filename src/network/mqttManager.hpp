@@ -5,17 +5,52 @@
 #include <PubSubClient.h>
 #include "config.hpp"
 #include "data/targetDataManager.hpp" // Dependência para o callback
+#include "data/dataHistoryManager.hpp" // Fonte do backfill de histórico
+#include "data/runtimeSettings.hpp" // Intervalos ajustáveis via <room>/config
+#include "network/mqttTopics.hpp"
+#include "network/mqttStoreForward.hpp"
+#include "network/mqttBackoff.hpp"
+#include "network/mqttAckClient.hpp"
+#include "network/mqttQos1.hpp"
+#include "network/mqttHistory.hpp"
+#include "network/telemetryCodec.hpp"
+#include "network/mqttOutbox.hpp"
 #include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
 #include "freertos/task.h"
 #include <ArduinoJson.h> // Include needed for JsonDocument if used internally
+#include <atomic>
+
+// Publicações QoS 1 aguardando PUBACK ao mesmo tempo. Pode ser sobrescrito via build_flags.
+#ifndef MQTT_QOS1_WINDOW
+#define MQTT_QOS1_WINDOW 4
+#endif
 
 namespace GrowController {
 
+/**
+ * @brief Métricas da outbox MQTT (cópia instantânea).
+ */
+struct MqttOutboxStats {
+    uint32_t depth;          // Itens aguardando envio agora
+    uint32_t maxDepth;       // Maior profundidade observada
+    uint32_t enqueued;       // Total enfileirado
+    uint32_t dropped;        // Descartados por outbox cheia ou payload grande demais
+    uint32_t sent;           // Entregues ao socket
+    uint32_t inflight;       // QoS 1 aguardando PUBACK agora
+    uint32_t acked;          // QoS 1 confirmados pelo broker (PUBACK)
+    uint32_t retransmitted;  // QoS 1 reenviados (DUP) após reconexão
+    uint32_t lastLatencyUs;  // Latência enqueue->socket da última mensagem
+    uint32_t maxLatencyUs;   // Maior latência observada
+    uint32_t avgLatencyUs;   // Média móvel exponencial (1/8) da latência
+};
+
 class MqttManager {
 public:
-    // Passa dependências (config, target manager) pelo construtor (Injeção de Dependência)
-    MqttManager(const MQTTConfig& config, TargetDataManager& targetMgr);
+    // Passa dependências (config, target manager, histórico) pelo construtor (Injeção de Dependência)
+    // historyMgr é opcional: sem ele, pedidos em <room>/history/request recebem erro.
+    // settings é opcional: sem ele, <room>/config não é assinado e a espera ociosa usa o padrão.
+    MqttManager(const MQTTConfig& config, TargetDataManager& targetMgr, DataHistoryManager* historyMgr = nullptr,
+                RuntimeSettings* settings = nullptr);
     ~MqttManager(); // Limpa recursos se necessário
 
     // Desabilitar cópia e atribuição
@@ -30,25 +65,34 @@ public:
     void setup();
 
     /**
-     * @brief Publica uma mensagem float em um tópico específico.
-     * Thread-safe. Assume que o tópico base (room) já está configurado.
-     * @param subTopic O subtópico (ex: "sensors", "temperature"). Será concatenado com o roomTopic.
+     * @brief Publica uma mensagem float em um tópico conhecido.
+     * O payload segue MQTTConfig::telemetryCodec (texto, CBOR ou struct binária).
+     * Thread-safe e não bloqueante: codifica o payload na pilha e o coloca na
+     * outbox lock-free em O(1). A tarefa MQTT, única dona do PubSubClient,
+     * envia a mensagem; se o broker estiver inacessível, a leitura é guardada
+     * na fila store-and-forward e reenviada em <room>/sensors/backlog depois.
+     * @param topic Tópico da tabela (ex: MqttTopic::SensorTemperature).
      * @param value O valor float a ser publicado.
      * @param retained Se a mensagem deve ser retida pelo broker.
-     * @return true Se a publicação foi enfileirada com sucesso (não garante entrega).
-     * @return false Se o cliente não está conectado ou houve erro ao publicar.
+     * @return true Se a mensagem entrou na outbox (não garante entrega).
+     * @return false Se a outbox está cheia (mensagem descartada e contabilizada).
      */
-    bool publish(const char* subTopic, float value, bool retained = false);
+    bool publish(MqttTopic topic, float value, bool retained = false);
      /**
-      * @brief Publica uma mensagem string em um tópico específico.
-      * Thread-safe. Assume que o tópico base (room) já está configurado.
-      * @param subTopic O subtópico (ex: "status", "alerts"). Será concatenado com o roomTopic.
-      * @param payload A string a ser publicada.
+      * @brief Publica uma mensagem string em um tópico conhecido.
+      * Thread-safe e não bloqueante (ver publish(MqttTopic, float)).
+      * @param topic Tópico da tabela (ex: MqttTopic::Devices).
+      * @param payload A string a ser publicada (copiada para a outbox).
       * @param retained Se a mensagem deve ser retida pelo broker.
-      * @return true Se a publicação foi enfileirada com sucesso.
-      * @return false Se o cliente não está conectado ou houve erro ao publicar.
+      * @return true Se a mensagem entrou na outbox.
+      * @return false Se a outbox está cheia ou o payload não cabe no item.
       */
-     bool publish(const char* subTopic, const char* payload, bool retained = false);
+     bool publish(MqttTopic topic, const char* payload, bool retained = false);
+
+    /**
+     * @brief Retorna uma cópia das métricas da outbox (profundidade, descartes, latência).
+     */
+    MqttOutboxStats getOutboxStats() const;
 
 
     /**
@@ -64,11 +108,34 @@ private:
     void run();
 
     /**
-     * @brief Garante que a conexão MQTT esteja ativa se o WiFi estiver conectado.
-     * Tenta reconectar se necessário. Chamado por run().
+     * @brief Avança a máquina de estados da conexão (WiFi -> backoff -> conectado).
+     * Cada tentativa tem timeout próprio de TCP e de CONNACK; entre falhas
+     * consecutivas o intervalo cresce exponencialmente com jitter.
+     * Chamado apenas por run() (tarefa MQTT), sem nenhum mutex.
      */
     void ensureConnection();
 
+    /**
+     * @brief Tenta abrir o TCP e completar o handshake MQTT (bloqueio limitado por timeouts).
+     * @return true Se o broker respondeu com CONNACK.
+     */
+    bool _attemptConnect();
+
+    /**
+     * @brief Agenda a próxima tentativa de conexão conforme o número de falhas.
+     */
+    void _scheduleReconnect();
+
+    /**
+     * @brief Publica presença e assina o tópico de controle após conectar.
+     */
+    void _onConnected();
+
+    /**
+     * @brief true apenas com a sessão MQTT estabelecida (não só o TCP).
+     */
+    bool _isMqttConnected();
+
     /**
      * @brief Processa mensagens MQTT recebidas e mantém a conexão ativa.
      * Chamado por run(). DEPRECATED - loop() is handled in run()
@@ -78,21 +145,146 @@ private:
      /**
      * @brief Callback interno para mensagens MQTT recebidas.
      * Chamado pelo PubSubClient via lambda. Usa targetDataManager para atualizar alvos.
+     * O payload é lido direto do buffer do PubSubClient (limitado por length),
+     * com um filtro que só mantém as chaves de alvo conhecidas.
      * NOTE: Changed byte* to unsigned char* to match PubSubClient's std::function expectation
      */
     void messageCallback(char* topic, unsigned char* payload, unsigned int length);
 
-    bool _publish_nolock(const char* fullTopic, const char* payload, bool retained);
+    /**
+     * @brief Envia uma mensagem ao broker. Apenas a tarefa MQTT chama.
+     */
+    bool _sendToBroker(const char* fullTopic, const uint8_t* payload, size_t length, bool retained);
+    bool _sendToBroker(const char* fullTopic, const char* payload, bool retained) {
+        return _sendToBroker(fullTopic, (const uint8_t*)payload, strlen(payload), retained);
+    }
+
+    /**
+     * @brief Enfileira um item na outbox, contabilizando descartes.
+     */
+    bool _enqueue(const MqttOutboxItem& item);
+
+    /**
+     * @brief Envia em lote até MQTT_OUTBOX_BATCH itens da outbox.
+     * Se desconectado, a telemetria vai para o store-and-forward. Com a janela
+     * QoS 1 cheia, os itens ficam na outbox até chegarem PUBACKs.
+     * @return size_t Número de itens retirados da outbox.
+     */
+    size_t _drainOutbox();
+
+    /**
+     * @brief Trata um pedido {"id","from","to","tier"} de <room>/history/request.
+     * Só registra o stream; os chunks são enviados aos poucos por _serviceHistoryStream().
+     */
+    void _handleHistoryRequest(const unsigned char* payload, unsigned int length);
+
+    /**
+     * @brief Envia o próximo chunk do stream de histórico, respeitando o intervalo entre chunks.
+     * Lê do DataHistoryManager apenas os registros do chunk.
+     */
+    void _serviceHistoryStream();
+
+    /**
+     * @brief Aplica um ajuste de intervalos recebido em <room>/config e responde em <room>/config/state.
+     */
+    void _handleConfigMessage(const unsigned char* payload, unsigned int length);
+
+    /**
+     * @brief Publica (retained) os intervalos em vigor e, se houver, o erro do último ajuste.
+     */
+    void _publishConfigState(const char* error);
+
+    /**
+     * @brief Publica uma resposta de erro (com end=true) para um pedido de histórico.
+     */
+    void _sendHistoryError(const char* id, uint32_t seq, const char* error);
+
+    /**
+     * @brief Escreve um PUBLISH QoS 1 direto no socket (o PubSubClient só faz QoS 0).
+     */
+    bool _sendQos1(const MqttOutboxItem& item, uint16_t packetId, bool dup);
+
+    /**
+     * @brief Libera da janela as publicações confirmadas por PUBACK.
+     */
+    void _processAcks();
+
+    /**
+     * @brief Reenvia (DUP) as publicações ainda sem PUBACK, da mais antiga para a mais nova.
+     * Chamado logo após reconectar.
+     */
+    void _retransmitInflight();
+
+    /**
+     * @brief Derruba a conexão se um PUBACK demorar demais (força reconexão e retransmissão).
+     */
+    void _checkAckTimeout();
+
+    /**
+     * @brief Guarda uma leitura na fila store-and-forward com o timestamp atual.
+     */
+    bool _storeForLater(MqttTopic topic, float value);
+
+    /**
+     * @brief Reenvia um lote limitado de leituras guardadas, se houver.
+     * Chamado por run() apenas quando conectado e com a outbox vazia,
+     * para que dados ao vivo nunca esperem pelo backlog.
+     */
+    void _drainBacklog();
+
+    /**
+     * @brief Registra as métricas periodicamente no log.
+     */
+    void _logOutboxStats();
+
+    /**
+     * @brief Processa os pacotes já recebidos no socket (comandos, PINGRESP).
+     */
+    void _serviceSocket();
+
+    /**
+     * @brief Acorda a tarefa MQTT (eventfd + notificação). Chamado pelos produtores.
+     */
+    void _wakeTask();
+
+    /**
+     * @brief Bloqueia a tarefa até o socket ficar legível, a outbox receber
+     * uma mensagem ou maxWait expirar. Sem conexão, espera só pela outbox.
+     */
+    void _waitForWork(TickType_t maxWait);
 
     
     const MQTTConfig& mqttConfig; // Referência à configuração
     TargetDataManager& targetDataManager; // Referência ao gerenciador de alvos
+    DataHistoryManager* dataHistoryManager; // Pode ser nullptr
+    RuntimeSettings* runtimeSettings; // Pode ser nullptr
     WiFiClient wifiClient;
-    PubSubClient pubSubClient;
-    SemaphoreHandle_t clientMutex; // Mutex para proteger pubSubClient
-    String controlTopic; // Tópico de controle completo (room/control)
-    String baseTopic;    // Tópico base (room)
-    TaskHandle_t taskHandle = NULL;
+    MqttAckClient ackClient; // Repassa ao wifiClient e captura os PUBACKs
+    PubSubClient pubSubClient; // Usado exclusivamente pela tarefa MQTT
+    MqttTopicTable topics; // Tópicos completos (<room>/<subtópico>), montados em setup()
+    JsonDocument controlFilter; // Chaves aceitas em <room>/control, montado em setup()
+    JsonDocument historyFilter; // Chaves aceitas em <room>/history/request
+    HistoryStream historyStream; // Resposta de histórico em andamento (uma por vez)
+    TickType_t lastHistoryChunkTick = 0;
+    MqttStoreForward storeForward; // Telemetria guardada enquanto o broker está inacessível
+    MqttOutbox<32> outbox; // Produtores -> tarefa MQTT, lock-free (enfileirados/descartes/pico contados nela)
+    MqttInflightWindow<MqttOutboxItem, MQTT_QOS1_WINDOW> inflight; // QoS 1 sem PUBACK (tarefa MQTT)
+    MqttConnectionState connectionState = MqttConnectionState::WaitingForWiFi;
+    uint8_t connectFailures = 0; // Falhas consecutivas desde a última conexão
+    TickType_t nextConnectTick = 0;
+    TickType_t lastBacklogDrainTick = 0;
+    TickType_t lastStatsLogTick = 0;
+
+    // Métricas da outbox (atualizadas com atomics relaxados)
+    std::atomic<uint32_t> statSent{0};
+    std::atomic<uint32_t> statInflight{0};
+    std::atomic<uint32_t> statAcked{0};
+    std::atomic<uint32_t> statRetransmits{0};
+    std::atomic<uint32_t> statLastLatencyUs{0};
+    std::atomic<uint32_t> statMaxLatencyUs{0};
+    std::atomic<uint32_t> statAvgLatencyUs{0};
+    std::atomic<TaskHandle_t> taskHandle{nullptr}; // Definido pela própria tarefa em run()
+    int wakeFd = -1; // eventfd observado junto com o socket no select()
     bool isSetup = false;
 };
 
@@ -0,0 +1,120 @@
+// src/network/mqttOutbox.hpp
+#ifndef MQTT_OUTBOX_HPP
+#define MQTT_OUTBOX_HPP
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include "network/mqttTopics.hpp"
+#include "network/telemetryCodec.hpp"
+#include "utils/mpscQueue.hpp"
+
+namespace GrowController {
+
+/**
+ * @brief Mensagem aguardando envio na outbox do MqttManager.
+ * Copiada por valor para a fila; não referencia memória do produtor.
+ */
+struct MqttOutboxItem {
+    uint32_t enqueuedAtUs; // micros() no momento do enqueue (latência até o socket)
+    float value;           // Valor original, para guardar no store-and-forward
+    MqttTopic topic;
+    bool retained;
+    bool isTelemetry;      // Leituras de sensor vão para o store-and-forward se desconectado
+    uint8_t qos;           // 0 ou 1
+    uint8_t length;        // Tamanho do payload em bytes
+    char payload[40];      // Payload: texto terminado em '\0' ou bytes do codec binário (usar length)
+};
+
+/**
+ * @brief Monta o item de uma leitura de sensor, codificada direto no payload do item.
+ * @return false Se o codec não conseguiu codificar o valor no espaço do item.
+ */
+inline bool encodeTelemetryItem(MqttOutboxItem& item, MqttTopic topic, float value, TelemetryCodec codec,
+                                uint8_t qos, bool retained) {
+    size_t len = encodeTelemetry(codec, value, (uint8_t*)item.payload, sizeof(item.payload));
+    if (len == 0) {
+        return false;
+    }
+    item.length = (uint8_t)len;
+    item.value = value;
+    item.topic = topic;
+    item.retained = retained;
+    item.isTelemetry = true;
+    item.qos = qos > 0 ? 1 : 0;
+    return true;
+}
+
+/**
+ * @brief Monta o item de uma mensagem de texto (status, resposta de config), sempre QoS 0.
+ * @return false Se o payload for nulo ou não couber no item (com o terminador).
+ */
+inline bool encodeTextItem(MqttOutboxItem& item, MqttTopic topic, const char* payload, bool retained) {
+    if (payload == nullptr) {
+        return false;
+    }
+    size_t len = strlen(payload);
+    if (len >= sizeof(item.payload)) {
+        return false;
+    }
+    memcpy(item.payload, payload, len + 1);
+    item.length = (uint8_t)len;
+    item.value = NAN;
+    item.topic = topic;
+    item.retained = retained;
+    item.isTelemetry = false;
+    item.qos = 0;
+    return true;
+}
+
+/**
+ * @brief Fila da outbox com as métricas do lado produtor (enfileirados, descartes, pico).
+ * push() é chamado de qualquer tarefa e nunca aloca nem bloqueia; tryPop() só pela tarefa MQTT.
+ * @tparam N Capacidade; potência de 2 (ver MpscQueue).
+ */
+template <size_t N>
+class MqttOutbox {
+public:
+    /**
+     * @brief Carimba o item com nowUs e enfileira.
+     * @return false Se a fila está cheia (descarte contabilizado).
+     */
+    bool push(const MqttOutboxItem& item, uint32_t nowUs) {
+        MqttOutboxItem stamped = item;
+        stamped.enqueuedAtUs = nowUs;
+        if (!queue_.tryPush(stamped)) {
+            countDropped();
+            return false;
+        }
+        enqueued_.fetch_add(1, std::memory_order_relaxed);
+
+        uint32_t depth = (uint32_t)queue_.sizeApprox();
+        uint32_t maxDepth = maxDepth_.load(std::memory_order_relaxed);
+        while (depth > maxDepth && !maxDepth_.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed)) {
+        }
+        return true;
+    }
+
+    bool tryPop(MqttOutboxItem& out) { return queue_.tryPop(out); }
+
+    /// Descarte antes de chegar à fila (payload que não coube no item).
+    void countDropped() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+
+    size_t sizeApprox() const { return queue_.sizeApprox(); }
+    bool emptyApprox() const { return queue_.emptyApprox(); }
+    uint32_t enqueued() const { return enqueued_.load(std::memory_order_relaxed); }
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint32_t maxDepth() const { return maxDepth_.load(std::memory_order_relaxed); }
+
+private:
+    MpscQueue<MqttOutboxItem, N> queue_;
+    std::atomic<uint32_t> enqueued_{0};
+    std::atomic<uint32_t> dropped_{0};
+    std::atomic<uint32_t> maxDepth_{0};
+};
+
+} // namespace GrowController
+
+#endif // MQTT_OUTBOX_HPP
@@ -0,0 +1,267 @@
+// src/network/mqttQos1.hpp
+#ifndef MQTT_QOS1_HPP
+#define MQTT_QOS1_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace GrowController {
+
+/**
+ * @brief Monta um pacote PUBLISH QoS 1 (MQTT 3.1.1) em um buffer fixo.
+ * O PubSubClient só publica com QoS 0, então o pacote é escrito direto no socket.
+ * @param dup Marca o pacote como retransmissão (flag DUP).
+ * @return size_t Tamanho do pacote, ou 0 se não coube no buffer / packetId inválido.
+ */
+inline size_t encodeQos1Publish(uint8_t* out, size_t size, const char* topic, const char* payload,
+                                size_t payloadLength, uint16_t packetId, bool retained, bool dup) {
+    if (out == nullptr || topic == nullptr || packetId == 0) {
+        return 0;
+    }
+    size_t topicLength = strlen(topic);
+    if (topicLength > 0xFFFF) {
+        return 0;
+    }
+    size_t remaining = 2 + topicLength + 2 + payloadLength;
+    if (remaining > 268435455UL) {
+        return 0;
+    }
+
+    uint8_t lengthBytes[4];
+    size_t lengthCount = 0;
+    size_t value = remaining;
+    do {
+        uint8_t encoded = value % 128;
+        value /= 128;
+        if (value > 0) {
+            encoded |= 0x80;
+        }
+        lengthBytes[lengthCount++] = encoded;
+    } while (value > 0);
+
+    size_t total = 1 + lengthCount + remaining;
+    if (total > size) {
+        return 0;
+    }
+
+    size_t pos = 0;
+    out[pos++] = 0x30 | 0x02 | (dup ? 0x08 : 0x00) | (retained ? 0x01 : 0x00);
+    memcpy(out + pos, lengthBytes, lengthCount);
+    pos += lengthCount;
+    out[pos++] = (uint8_t)(topicLength >> 8);
+    out[pos++] = (uint8_t)(topicLength & 0xFF);
+    memcpy(out + pos, topic, topicLength);
+    pos += topicLength;
+    out[pos++] = (uint8_t)(packetId >> 8);
+    out[pos++] = (uint8_t)(packetId & 0xFF);
+    if (payloadLength > 0) {
+        memcpy(out + pos, payload, payloadLength);
+        pos += payloadLength;
+    }
+    return pos;
+}
+
+/**
+ * @brief Parser incremental do fluxo recebido do broker que reconhece PUBACKs.
+ * Recebe byte a byte o mesmo fluxo que o PubSubClient lê (que descarta PUBACKs)
+ * e devolve o packet ID de cada PUBACK completo. Os demais pacotes são pulados.
+ */
+class MqttPacketSniffer {
+public:
+    /**
+     * @brief Processa um byte do fluxo.
+     * @param ackId Recebe o packet ID quando um PUBACK termina neste byte.
+     * @return true Se um PUBACK foi completado.
+     */
+    bool feed(uint8_t byte, uint16_t& ackId) {
+        switch (state) {
+            case State::Header:
+                header = byte;
+                remaining = 0;
+                multiplier = 1;
+                lengthBytes = 0;
+                bodyRead = 0;
+                state = State::Length;
+                return false;
+
+            case State::Length:
+                remaining += (uint32_t)(byte & 0x7F) * multiplier;
+                multiplier *= 128;
+                lengthBytes++;
+                if (byte & 0x80) {
+                    if (lengthBytes >= 4) {
+                        state = State::Header; // Comprimento inválido: ressincroniza
+                    }
+                    return false;
+                }
+                if (remaining == 0) {
+                    state = State::Header;
+                    return false;
+                }
+                state = State::Body;
+                return false;
+
+            case State::Body:
+                if (bodyRead < sizeof(body)) {
+                    body[bodyRead] = byte;
+                }
+                bodyRead++;
+                if (bodyRead < remaining) {
+                    return false;
+                }
+                state = State::Header;
+                if ((header & 0xF0) == 0x40 && remaining == 2) {
+                    ackId = (uint16_t)((body[0] << 8) | body[1]);
+                    return true;
+                }
+                return false;
+        }
+        return false;
+    }
+
+    void reset() {
+        state = State::Header;
+    }
+
+private:
+    enum class State : uint8_t { Header, Length, Body };
+    State state = State::Header;
+    uint8_t header = 0;
+    uint32_t remaining = 0;
+    uint32_t multiplier = 1;
+    uint8_t lengthBytes = 0;
+    uint32_t bodyRead = 0;
+    uint8_t body[2] = {0, 0};
+};
+
+/**
+ * @brief Janela de publicações QoS 1 aguardando PUBACK, de tamanho fixo.
+ * Atribui packet IDs (nunca 0, nunca repetidos dentro da janela) e libera a
+ * entrada quando o PUBACK correspondente chega. Não é thread-safe: apenas a
+ * tarefa MQTT a usa.
+ * @tparam T Mensagem guardada para retransmissão.
+ * @tparam N Número máximo de publicações em voo.
+ */
+template <typename T, size_t N>
+class MqttInflightWindow {
+public:
+    static_assert(N > 0 && N < 0xFFFF, "MqttInflightWindow size must be between 1 and 65534");
+
+    struct Entry {
+        uint16_t packetId;
+        uint32_t sentAt; // Instante do último envio (ticks ou ms, a critério do chamador)
+        T message;
+    };
+
+    /**
+     * @brief Reserva uma entrada para a mensagem e atribui um packet ID.
+     * @return Entry* Entrada reservada, ou nullptr se a janela está cheia.
+     */
+    Entry* add(const T& message, uint32_t now) {
+        if (count == N) {
+            return nullptr;
+        }
+        for (size_t i = 0; i < N; ++i) {
+            if (!inUse[i]) {
+                inUse[i] = true;
+                entries[i].packetId = _nextPacketId();
+                entries[i].sentAt = now;
+                entries[i].message = message;
+                count++;
+                return &entries[i];
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Libera a entrada do PUBACK recebido.
+     * @return true Se o packet ID estava em voo (PUBACKs duplicados retornam false).
+     */
+    bool acknowledge(uint16_t packetId) {
+        for (size_t i = 0; i < N; ++i) {
+            if (inUse[i] && entries[i].packetId == packetId) {
+                inUse[i] = false;
+                count--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Chama fn(Entry&) para cada entrada em voo, da mais antiga para a mais nova.
+     */
+    template <typename Fn>
+    void forEachOldestFirst(Fn fn) {
+        bool visited[N] = {false};
+        for (size_t n = 0; n < count; ++n) {
+            size_t oldest = N;
+            for (size_t i = 0; i < N; ++i) {
+                if (inUse[i] && !visited[i] &&
+                    (oldest == N || (int32_t)(entries[i].sentAt - entries[oldest].sentAt) < 0 ||
+                     (entries[i].sentAt == entries[oldest].sentAt && _idBefore(entries[i].packetId, entries[oldest].packetId)))) {
+                    oldest = i;
+                }
+            }
+            if (oldest == N) {
+                return;
+            }
+            visited[oldest] = true;
+            fn(entries[oldest]);
+        }
+    }
+
+    /**
+     * @brief Entrada enviada há mais tempo, ou nullptr se a janela está vazia.
+     */
+    const Entry* oldest() const {
+        const Entry* result = nullptr;
+        for (size_t i = 0; i < N; ++i) {
+            if (inUse[i] && (result == nullptr || (int32_t)(entries[i].sentAt - result->sentAt) < 0)) {
+                result = &entries[i];
+            }
+        }
+        return result;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    uint16_t _nextPacketId() {
+        for (;;) {
+            lastPacketId++;
+            if (lastPacketId == 0) {
+                lastPacketId = 1; // 0 é inválido no MQTT
+            }
+            bool taken = false;
+            for (size_t i = 0; i < N; ++i) {
+                if (inUse[i] && entries[i].packetId == lastPacketId) {
+                    taken = true;
+                    break;
+                }
+            }
+            if (!taken) {
+                return lastPacketId;
+            }
+        }
+    }
+
+    // Ordem de atribuição dos IDs, tolerando a volta de 65535 para 1
+    bool _idBefore(uint16_t a, uint16_t b) const {
+        return (int16_t)(a - b) < 0;
+    }
+
+    Entry entries[N] = {};
+    bool inUse[N] = {false};
+    size_t count = 0;
+    uint16_t lastPacketId = 0;
+};
+
+} // namespace GrowController
+
+#endif // MQTT_QOS1_HPP
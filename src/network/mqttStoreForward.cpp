@@ -0,0 +1,202 @@
+// src/network/mqttStoreForward.cpp
+#include "mqttStoreForward.hpp"
+#include <LittleFS.h>
+#include "utils/logger.hpp"
+#include "utils/metrics.hpp"
+
+namespace GrowController {
+
+const char* MqttStoreForward::SPILL_FILE_NAME = "/mqtt_spool.dat";
+const TickType_t MqttStoreForward::MUTEX_TIMEOUT = pdMS_TO_TICKS(100);
+
+MqttStoreForward::MqttStoreForward() :
+    spillAvailable(false)
+{
+    queue.resetSpill(SPILL_MAGIC);
+}
+
+bool MqttStoreForward::initialize() {
+    if (!queueMutex) {
+        Logger::error("MqttStoreForward: Failed to create queue mutex!");
+        return false;
+    }
+    if (xSemaphoreTake(queueMutex.get(), MUTEX_TIMEOUT) != pdTRUE) {
+        Logger::error("MqttStoreForward: Timed out acquiring mutex for initialization.");
+        return false;
+    }
+
+    bool headerOk = false;
+    if (LittleFS.exists(SPILL_FILE_NAME)) {
+        File file = LittleFS.open(SPILL_FILE_NAME, "r");
+        if (file && file.size() >= sizeof(SpillHeader)) {
+            SpillHeader stored;
+            headerOk = file.read((uint8_t*)&stored, sizeof(stored)) == sizeof(stored) &&
+                       queue.restore(stored, SPILL_MAGIC);
+        }
+        if (file) file.close();
+    }
+
+    if (!headerOk) {
+        queue.resetSpill(SPILL_MAGIC);
+        File file = LittleFS.open(SPILL_FILE_NAME, "w");
+        if (!file) {
+            Logger::error("MqttStoreForward: Failed to create spill file '%s'. Running RAM-only.", SPILL_FILE_NAME);
+            xSemaphoreGive(queueMutex.get());
+            return false;
+        }
+        bool written = file.write((const uint8_t*)&queue.header(), sizeof(SpillHeader)) == sizeof(SpillHeader);
+        file.close();
+        if (!written) {
+            Logger::error("MqttStoreForward: Failed to write spill header. Running RAM-only.");
+            xSemaphoreGive(queueMutex.get());
+            return false;
+        }
+    }
+
+    spillAvailable = true;
+    Logger::info("MqttStoreForward: Spill file ready, %u readings pending from previous outage.",
+                 (unsigned)queue.spilled());
+    xSemaphoreGive(queueMutex.get());
+    return true;
+}
+
+bool MqttStoreForward::enqueue(MqttTopic topic, float value, uint32_t timestamp) {
+    if (xSemaphoreTake(queueMutex.get(), MUTEX_TIMEOUT) != pdTRUE) {
+        Metrics::mutexTimeoutsMqttStore.inc();
+        lockTimeoutDrops.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // RAM cheia: despeja a RAM inteira de uma vez (menos escritas na flash do que registro a registro).
+    // Sem arquivo, ou se a escrita falhar, push() descarta a leitura mais antiga da RAM.
+    if (queue.ramFull() && spillAvailable) {
+        _spillRamToFile();
+    }
+
+    QueuedReading reading = {};
+    reading.timestamp = timestamp;
+    reading.value = value;
+    reading.topic = static_cast<uint8_t>(topic);
+    bool stored = queue.push(reading);
+
+    xSemaphoreGive(queueMutex.get());
+    return stored;
+}
+
+size_t MqttStoreForward::drain(size_t maxCount, const DrainFunction& fn) {
+    using Queue = StoreForwardQueue<RAM_CAPACITY, SPILL_CAPACITY>;
+    size_t delivered = 0;
+    bool headerDirty = false;
+    // Um handle por lote, aberto na primeira leitura do arquivo. Reaberto só se um despejo da RAM
+    // escreveu no arquivo desde então (outro handle do LittleFS não enxerga essas escritas).
+    File replayFile;
+    uint32_t replayTail = 0;
+    auto readSpilled = [this, &replayFile, &replayTail](size_t offset, QueuedReading& out) {
+        if (replayFile && replayTail != queue.header().tail) {
+            replayFile.close();
+        }
+        if (!replayFile) {
+            replayFile = LittleFS.open(SPILL_FILE_NAME, "r");
+            if (!replayFile) return false;
+            replayTail = queue.header().tail;
+        }
+        return replayFile.seek(offset) && replayFile.read((uint8_t*)&out, sizeof(out)) == sizeof(out);
+    };
+
+    while (delivered < maxCount) {
+        QueuedReading reading;
+        uint32_t versionBefore;
+
+        // 1. Lê o mais antigo sob o mutex
+        if (xSemaphoreTake(queueMutex.get(), MUTEX_TIMEOUT) != pdTRUE) {
+            Metrics::mutexTimeoutsMqttStore.inc();
+            break;
+        }
+        Queue::FrontStatus status = queue.front(reading, &versionBefore, readSpilled);
+        if (status == Queue::FrontStatus::Unreadable) {
+            // Registro ilegível no arquivo: já descartado para não travar a drenagem
+            Logger::warn("MqttStoreForward: Unreadable spilled reading %u discarded.", (unsigned)(queue.header().head - 1));
+            headerDirty = true;
+            xSemaphoreGive(queueMutex.get());
+            continue;
+        }
+        xSemaphoreGive(queueMutex.get());
+        if (status == Queue::FrontStatus::Empty) {
+            break;
+        }
+
+        // 2. Entrega sem segurar o mutex (a publicação faz I/O de rede)
+        if (!fn(reading)) {
+            break; // Backpressure: tenta de novo na próxima janela
+        }
+
+        // 3. Remove o item entregue, a menos que a frente da fila tenha mudado nesse meio tempo.
+        if (xSemaphoreTake(queueMutex.get(), MUTEX_TIMEOUT) != pdTRUE) {
+            Metrics::mutexTimeoutsMqttStore.inc();
+            break;
+        }
+        headerDirty |= queue.popFront(versionBefore);
+        xSemaphoreGive(queueMutex.get());
+        delivered++;
+    }
+    if (replayFile) {
+        replayFile.close();
+    }
+
+    if (headerDirty && xSemaphoreTake(queueMutex.get(), MUTEX_TIMEOUT) == pdTRUE) {
+        _writeHeader(); // Uma escrita do cabeçalho por lote drenado
+        xSemaphoreGive(queueMutex.get());
+    }
+    return delivered;
+}
+
+size_t MqttStoreForward::size() const {
+    size_t pending = 0;
+    if (xSemaphoreTake(queueMutex.get(), MUTEX_TIMEOUT) == pdTRUE) {
+        pending = queue.size();
+        xSemaphoreGive(queueMutex.get());
+    }
+    return pending;
+}
+
+uint32_t MqttStoreForward::getDroppedCount() const {
+    return queue.droppedCount() + lockTimeoutDrops.load(std::memory_order_relaxed);
+}
+
+// --- Helpers privados (mutex já obtido) ---
+
+bool MqttStoreForward::_spillRamToFile() {
+    File file = LittleFS.open(SPILL_FILE_NAME, "r+");
+    if (!file) {
+        Logger::error("MqttStoreForward: Failed to open spill file for writing.");
+        return false;
+    }
+
+    bool spilled = queue.spillRam([&file](size_t offset, const QueuedReading& reading) {
+        return file.seek(offset) && file.write((const uint8_t*)&reading, sizeof(reading)) == sizeof(reading);
+    });
+    if (!spilled) {
+        Logger::error("MqttStoreForward: Failed to write spilled reading at slot %u.",
+                      (unsigned)(queue.header().tail % SPILL_CAPACITY));
+    }
+
+    bool headerOk = file.seek(0) &&
+                    file.write((const uint8_t*)&queue.header(), sizeof(SpillHeader)) == sizeof(SpillHeader);
+    file.close();
+    if (!headerOk) {
+        Logger::error("MqttStoreForward: Failed to update spill header.");
+    }
+    return spilled;
+}
+
+bool MqttStoreForward::_writeHeader() {
+    File file = LittleFS.open(SPILL_FILE_NAME, "r+");
+    if (!file) {
+        return false;
+    }
+    bool ok = file.seek(0) && file.write((const uint8_t*)&queue.header(), sizeof(SpillHeader)) == sizeof(SpillHeader);
+    file.close();
+    return ok;
+}
+
+} // namespace GrowController
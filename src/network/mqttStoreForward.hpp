@@ -0,0 +1,90 @@
+// src/network/mqttStoreForward.hpp
+#ifndef MQTT_STORE_FORWARD_HPP
+#define MQTT_STORE_FORWARD_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <functional>
+#include "network/mqttTopics.hpp"
+#include "network/storeForwardQueue.hpp"
+#include "utils/freeRTOSMutex.hpp"
+#include "freertos/FreeRTOS.h"
+
+namespace GrowController {
+
+/**
+ * @brief Fila store-and-forward limitada para telemetria MQTT.
+ *
+ * As leituras ficam primeiro em um buffer circular em RAM. Quando ele enche,
+ * seu conteúdo é despejado em um arquivo de segmento circular no LittleFS.
+ * A drenagem entrega sempre o mais antigo primeiro (arquivo, depois RAM).
+ * Quando o arquivo também enche, os registros mais antigos são descartados.
+ * A lógica de índices fica em StoreForwardQueue; aqui ficam o mutex e o LittleFS.
+ * Thread-safe.
+ */
+class MqttStoreForward {
+public:
+    static const size_t RAM_CAPACITY = 32;
+    static const uint32_t SPILL_CAPACITY = 4096;
+
+    /**
+     * @brief Função chamada para cada leitura drenada.
+     * @return false para interromper a drenagem (ex: falha de publicação);
+     *         a leitura permanece na fila.
+     */
+    using DrainFunction = std::function<bool(const QueuedReading&)>;
+
+    MqttStoreForward();
+
+    MqttStoreForward(const MqttStoreForward&) = delete;
+    MqttStoreForward& operator=(const MqttStoreForward&) = delete;
+
+    /**
+     * @brief Abre (ou cria) o arquivo de segmento. LittleFS deve estar montado.
+     * Se falhar, a fila continua funcionando apenas em RAM.
+     * @return true Se o arquivo de segmento está disponível.
+     */
+    bool initialize();
+
+    /**
+     * @brief Enfileira uma leitura. Nunca bloqueia por I/O de rede.
+     * @return false Se o mutex não pôde ser obtido ou a leitura teve que ser descartada.
+     */
+    bool enqueue(MqttTopic topic, float value, uint32_t timestamp);
+
+    /**
+     * @brief Entrega até maxCount leituras, da mais antiga para a mais nova.
+     * @return size_t Número de leituras entregues e removidas da fila.
+     */
+    size_t drain(size_t maxCount, const DrainFunction& fn);
+
+    /**
+     * @brief Número total de leituras pendentes (RAM + arquivo).
+     */
+    size_t size() const;
+
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Número de leituras descartadas por falta de espaço desde o boot.
+     */
+    uint32_t getDroppedCount() const;
+
+private:
+    bool _spillRamToFile();
+    bool _writeHeader();
+
+    static const char* SPILL_FILE_NAME;
+    static const uint32_t SPILL_MAGIC = 0x53465131; // "SFQ1"
+    static const TickType_t MUTEX_TIMEOUT;
+
+    StoreForwardQueue<RAM_CAPACITY, SPILL_CAPACITY> queue;
+    bool spillAvailable;
+    std::atomic<uint32_t> lockTimeoutDrops{0}; // Descartes por timeout do mutex (fora da fila)
+    mutable FreeRTOSMutex queueMutex;
+};
+
+} // namespace GrowController
+
+#endif // MQTT_STORE_FORWARD_HPP
@@ -0,0 +1,130 @@
+// src/network/mqttTopics.hpp
+#ifndef MQTT_TOPICS_HPP
+#define MQTT_TOPICS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+namespace GrowController {
+
+/**
+ * @brief Subtópicos MQTT conhecidos pelo dispositivo.
+ * Cada valor indexa a tabela de tópicos completos montada uma única vez
+ * em MqttManager::setup(), evitando concatenação de Strings a cada publicação.
+ */
+enum class MqttTopic : uint8_t {
+    Devices = 0,        ///< <room>/devices (presença, retained)
+    Control,            ///< <room>/control (assinado para receber alvos)
+    SensorTemperature,  ///< <room>/sensors/temperature
+    SensorAirHumidity,  ///< <room>/sensors/air_humidity
+    SensorSoilHumidity, ///< <room>/sensors/soil_humidity
+    SensorVpd,          ///< <room>/sensors/vpd
+    SensorsBacklog,     ///< <room>/sensors/backlog (leituras guardadas durante quedas do broker)
+    HistoryRequest,     ///< <room>/history/request (assinado; pedidos de backfill do coletor)
+    HistoryResponse,    ///< <room>/history/response (chunks de histórico com ID de correlação)
+    Config,             ///< <room>/config (assinado; ajuste dos intervalos em tempo de execução)
+    ConfigState,        ///< <room>/config/state (intervalos em vigor + resultado do último ajuste, retained)
+    ActuatorUsage,      ///< <room>/actuators/usage (tempo ligado, trocas e energia do dia, uma linha por atuador)
+    Count               ///< Número de tópicos (não é um tópico válido)
+};
+
+/**
+ * @brief Tabela de tópicos completos (<room>/<subtópico>) em buffers fixos.
+ * Construída uma vez; as consultas posteriores não alocam memória.
+ */
+class MqttTopicTable {
+public:
+    static const size_t MAX_TOPIC_LENGTH = 64;
+    static const size_t TOPIC_COUNT = static_cast<size_t>(MqttTopic::Count);
+
+    /**
+     * @brief Monta todos os tópicos a partir do tópico base (room).
+     * @param baseTopic Identificador do cômodo (ex: "01").
+     * @return true Se todos os tópicos couberam nos buffers.
+     * @return false Se o tópico base é nulo ou algum tópico seria truncado.
+     */
+    bool build(const char* baseTopic) {
+        built = false;
+        if (baseTopic == nullptr) {
+            return false;
+        }
+        int baseLen = snprintf(base, sizeof(base), "%s", baseTopic);
+        if (baseLen < 0 || (size_t)baseLen >= sizeof(base)) {
+            return false;
+        }
+        for (size_t i = 0; i < TOPIC_COUNT; ++i) {
+            int len = snprintf(topics[i], MAX_TOPIC_LENGTH, "%s/%s", base, subTopicOf(static_cast<MqttTopic>(i)));
+            if (len < 0 || (size_t)len >= MAX_TOPIC_LENGTH) {
+                return false;
+            }
+        }
+        built = true;
+        return true;
+    }
+
+    /**
+     * @brief Retorna o tópico completo já montado.
+     * @return const char* Tópico completo, ou "" se a tabela não foi montada ou o índice é inválido.
+     */
+    const char* get(MqttTopic topic) const {
+        size_t index = static_cast<size_t>(topic);
+        if (!built || index >= TOPIC_COUNT) {
+            return "";
+        }
+        return topics[index];
+    }
+
+    /**
+     * @brief Retorna o tópico base (room).
+     */
+    const char* getBase() const {
+        return base;
+    }
+
+    bool isBuilt() const {
+        return built;
+    }
+
+    /**
+     * @brief Subtópico relativo de cada entrada da tabela.
+     */
+    static const char* subTopicOf(MqttTopic topic) {
+        switch (topic) {
+            case MqttTopic::Devices:            return "devices";
+            case MqttTopic::Control:            return "control";
+            case MqttTopic::SensorTemperature:  return "sensors/temperature";
+            case MqttTopic::SensorAirHumidity:  return "sensors/air_humidity";
+            case MqttTopic::SensorSoilHumidity: return "sensors/soil_humidity";
+            case MqttTopic::SensorVpd:          return "sensors/vpd";
+            case MqttTopic::SensorsBacklog:     return "sensors/backlog";
+            case MqttTopic::HistoryRequest:     return "history/request";
+            case MqttTopic::HistoryResponse:    return "history/response";
+            case MqttTopic::Config:             return "config";
+            case MqttTopic::ConfigState:        return "config/state";
+            case MqttTopic::ActuatorUsage:      return "actuators/usage";
+            default:                            return "";
+        }
+    }
+
+private:
+    char base[MAX_TOPIC_LENGTH] = {0};
+    char topics[TOPIC_COUNT][MAX_TOPIC_LENGTH] = {{0}};
+    bool built = false;
+};
+
+/**
+ * @brief Formata um valor float como payload texto ("%.2f") em um buffer da pilha.
+ * @return int Número de caracteres escritos (sem o terminador), ou -1 se não coube.
+ */
+inline int formatFloatPayload(char* out, size_t size, float value) {
+    int len = snprintf(out, size, "%.2f", value);
+    if (len < 0 || (size_t)len >= size) {
+        return -1;
+    }
+    return len;
+}
+
+} // namespace GrowController
+
+#endif // MQTT_TOPICS_HPP
@@ -0,0 +1,140 @@
+// src/network/requestBodyPool.hpp
+#ifndef REQUEST_BODY_POOL_HPP
+#define REQUEST_BODY_POOL_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+namespace GrowController {
+
+/**
+ * @brief Pool fixo de buffers para corpos de POST, um slot por requisição em andamento.
+ *
+ * O slot é identificado pelo ponteiro da requisição (owner). Não usamos
+ * AsyncWebServerRequest::_tempObject porque a biblioteca libera esse ponteiro
+ * com free() ao destruir a requisição. Corpos maiores que SlotSize são recusados
+ * já no primeiro chunk (o chamador responde 413), sem alocar nada.
+ * @tparam SlotCount Requisições com corpo simultâneas.
+ * @tparam SlotSize Tamanho máximo do corpo em bytes.
+ */
+template <size_t SlotCount, size_t SlotSize>
+class RequestBodyPool {
+public:
+    static_assert(SlotCount > 0 && SlotSize > 0, "RequestBodyPool needs at least one non-empty slot");
+
+    enum class Status : uint8_t {
+        Incomplete, ///< Chunk guardado, aguardando o restante
+        Complete,   ///< Corpo inteiro em data()/length(); chame release() depois de usar
+        TooLarge,   ///< total > SlotSize (responder 413)
+        Busy,       ///< Todos os slots ocupados (responder 503)
+        Invalid,    ///< Chunk fora de ordem, sem slot ou além de total (responder 400)
+    };
+
+    struct Body {
+        const uint8_t* data;
+        size_t length;
+    };
+
+    /**
+     * @brief Recebe um chunk como entregue por onRequestBody.
+     * Em qualquer status diferente de Incomplete/Complete o slot (se havia) já foi liberado.
+     * @param body Preenchido quando o status é Complete.
+     */
+    Status append(const void* owner, const uint8_t* data, size_t len, size_t index, size_t total, Body* body = nullptr) {
+        Slot* slot = nullptr;
+        if (index == 0) {
+            if (total > SlotSize) {
+                release(owner); // Reenvio com o mesmo owner: descarta o anterior
+                return Status::TooLarge;
+            }
+            slot = _find(owner);
+            if (slot == nullptr) {
+                slot = _claim(owner);
+                if (slot == nullptr) return Status::Busy;
+            }
+            slot->length = 0;
+            slot->expected = total;
+        } else {
+            slot = _find(owner);
+            if (slot == nullptr) {
+                return Status::Invalid; // Já recusado (413/503) ou liberado: ignora o resto do corpo
+            }
+        }
+
+        if (index != slot->length || total != slot->expected || len > slot->expected - slot->length) {
+            _free(*slot);
+            return Status::Invalid;
+        }
+        memcpy(slot->data + slot->length, data, len);
+        slot->length += len;
+        if (slot->length < slot->expected) {
+            return Status::Incomplete;
+        }
+        if (body) {
+            body->data = slot->data;
+            body->length = slot->length;
+        }
+        return Status::Complete;
+    }
+
+    /**
+     * @brief Libera o slot do owner (idempotente; seguro chamar no onDisconnect).
+     */
+    void release(const void* owner) {
+        Slot* slot = _find(owner);
+        if (slot) _free(*slot);
+    }
+
+    size_t inUse() const {
+        size_t count = 0;
+        for (const auto& slot : slots) {
+            if (slot.owner.load(std::memory_order_acquire) != nullptr) count++;
+        }
+        return count;
+    }
+
+    static constexpr size_t maxBodySize() {
+        return SlotSize;
+    }
+
+private:
+    struct Slot {
+        std::atomic<const void*> owner{nullptr};
+        size_t length = 0;
+        size_t expected = 0;
+        uint8_t data[SlotSize];
+    };
+
+    Slot* _find(const void* owner) {
+        if (owner == nullptr) return nullptr;
+        for (auto& slot : slots) {
+            if (slot.owner.load(std::memory_order_acquire) == owner) return &slot;
+        }
+        return nullptr;
+    }
+
+    Slot* _claim(const void* owner) {
+        if (owner == nullptr) return nullptr;
+        for (auto& slot : slots) {
+            const void* expectedOwner = nullptr;
+            if (slot.owner.compare_exchange_strong(expectedOwner, owner, std::memory_order_acq_rel)) {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    static void _free(Slot& slot) {
+        slot.length = 0;
+        slot.expected = 0;
+        slot.owner.store(nullptr, std::memory_order_release);
+    }
+
+    Slot slots[SlotCount];
+};
+
+} // namespace GrowController
+
+#endif // REQUEST_BODY_POOL_HPP
@@ -0,0 +1,71 @@
+// src/network/stateFields.hpp
+#ifndef STATE_FIELDS_HPP
+#define STATE_FIELDS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace GrowController {
+
+/**
+ * @brief Seções selecionáveis em GET /api/state?fields=a,b,c.
+ */
+enum StateField : uint8_t {
+    STATE_FIELD_SENSORS = 1u << 0, ///< Mesmo conteúdo de /api/sensors
+    STATE_FIELD_STATUS  = 1u << 1, ///< Mesmo conteúdo de /api/status
+    STATE_FIELD_TARGETS = 1u << 2, ///< Todos os alvos do TargetDataManager
+    STATE_FIELD_SYSTEM  = 1u << 3, ///< Uptime, heap, RSSI, registros de histórico
+    STATE_FIELD_HISTORY = 1u << 4, ///< Registros mais recentes do histórico (opt-in)
+};
+
+/// Sem fields=: tudo menos o histórico, que é o maior e só a aba de gráficos usa.
+static const uint8_t STATE_FIELDS_DEFAULT = STATE_FIELD_SENSORS | STATE_FIELD_STATUS |
+                                            STATE_FIELD_TARGETS | STATE_FIELD_SYSTEM;
+
+inline uint8_t stateFieldFromName(const char* name, size_t length) {
+    static const struct { const char* name; uint8_t bit; } FIELDS[] = {
+        {"sensors", STATE_FIELD_SENSORS}, {"status", STATE_FIELD_STATUS}, {"targets", STATE_FIELD_TARGETS},
+        {"system", STATE_FIELD_SYSTEM},   {"history", STATE_FIELD_HISTORY},
+    };
+    for (const auto& field : FIELDS) {
+        if (strlen(field.name) == length && strncmp(field.name, name, length) == 0) {
+            return field.bit;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Converte a lista separada por vírgulas em máscara de StateField.
+ * Espaços e itens vazios são ignorados; lista vazia ou nula resulta em STATE_FIELDS_DEFAULT.
+ * @param unknown Recebe o início do primeiro nome desconhecido (opcional).
+ * @return 0 Se algum nome é desconhecido.
+ */
+inline uint8_t parseStateFields(const char* csv, const char** unknown = nullptr) {
+    if (csv == nullptr) {
+        return STATE_FIELDS_DEFAULT;
+    }
+    uint8_t mask = 0;
+    const char* cursor = csv;
+    while (*cursor != '\0') {
+        while (*cursor == ',' || *cursor == ' ') ++cursor;
+        const char* start = cursor;
+        while (*cursor != '\0' && *cursor != ',' && *cursor != ' ') ++cursor;
+        size_t length = (size_t)(cursor - start);
+        if (length == 0) {
+            continue;
+        }
+        uint8_t bit = stateFieldFromName(start, length);
+        if (bit == 0) {
+            if (unknown) *unknown = start;
+            return 0;
+        }
+        mask |= bit;
+    }
+    return mask == 0 ? STATE_FIELDS_DEFAULT : mask;
+}
+
+} // namespace GrowController
+
+#endif // STATE_FIELDS_HPP
@@ -0,0 +1,115 @@
+#include "staticAssetHandler.hpp"
+#include <Arduino.h>
+#include "utils/logger.hpp"
+
+namespace GrowController {
+
+static const char* CACHE_IMMUTABLE = "public, max-age=31536000, immutable";
+static const char* CACHE_REVALIDATE = "no-cache"; // Pode guardar, mas sempre revalida (304 se igual)
+
+static const char* contentTypeFor(const char* path) {
+    const char* dot = strrchr(path, '.');
+    if (dot == nullptr) return "application/octet-stream";
+    if (strcmp(dot, ".html") == 0 || strcmp(dot, ".htm") == 0) return "text/html";
+    if (strcmp(dot, ".js") == 0) return "application/javascript";
+    if (strcmp(dot, ".css") == 0) return "text/css";
+    if (strcmp(dot, ".json") == 0) return "application/json";
+    if (strcmp(dot, ".svg") == 0) return "image/svg+xml";
+    if (strcmp(dot, ".ico") == 0) return "image/x-icon";
+    if (strcmp(dot, ".png") == 0) return "image/png";
+    return "application/octet-stream";
+}
+
+size_t StaticAssetHandler::loadManifest(const char* manifestPath) {
+    assetCount_ = 0;
+    if (!fs_.exists(manifestPath)) {
+        Logger::warn("StaticAssetHandler: %s not found, serving uncompressed files only.", manifestPath);
+        return 0;
+    }
+    File file = fs_.open(manifestPath, "r");
+    if (!file) {
+        Logger::error("StaticAssetHandler: Failed to open %s.", manifestPath);
+        return 0;
+    }
+
+    char line[80];
+    size_t lineLen = 0;
+    while (true) {
+        int c = file.read();
+        if (c < 0 || c == '\n') {
+            line[lineLen] = '\0';
+            if (lineLen > 0 && assetCount_ < MAX_ASSETS) {
+                if (parseStaticAssetLine(line, assets_[assetCount_])) {
+                    assetCount_++;
+                } else {
+                    Logger::warn("StaticAssetHandler: Ignoring malformed manifest line '%s'.", line);
+                }
+            }
+            lineLen = 0;
+            if (c < 0) break;
+        } else if (c != '\r' && lineLen < sizeof(line) - 1) {
+            line[lineLen++] = (char)c;
+        }
+    }
+    file.close();
+
+    Logger::info("StaticAssetHandler: %u gzipped assets registered.", (unsigned)assetCount_);
+    return assetCount_;
+}
+
+const StaticAsset* StaticAssetHandler::_find(const String& url) const {
+    // "/" é a página inicial; url() não inclui a query string (?v=<hash>)
+    const char* path = (url == "/") ? "/index.html" : url.c_str();
+    for (size_t i = 0; i < assetCount_; ++i) {
+        if (strcmp(assets_[i].path, path) == 0) {
+            return &assets_[i];
+        }
+    }
+    return nullptr;
+}
+
+bool StaticAssetHandler::canHandle(AsyncWebServerRequest* request) {
+    if (request->method() != HTTP_GET && request->method() != HTTP_HEAD) {
+        return false;
+    }
+    if (_find(request->url()) == nullptr) {
+        return false;
+    }
+    // ESPAsyncWebServer 1.2.x descarta cabeçalhos não registrados depois que um handler assume o pedido
+    request->addInterestingHeader("If-None-Match");
+    return true;
+}
+
+void StaticAssetHandler::handleRequest(AsyncWebServerRequest* request) {
+    const StaticAsset* asset = _find(request->url());
+    if (asset == nullptr) {
+        request->send(404);
+        return;
+    }
+    const char* cacheControl = asset->immutable ? CACHE_IMMUTABLE : CACHE_REVALIDATE;
+
+    // Validação pelo hash do conteúdo: nenhum acesso ao LittleFS
+    if (request->hasHeader("If-None-Match") && etagMatches(request->header("If-None-Match").c_str(), asset->etag)) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", asset->etag);
+        response->addHeader("Cache-Control", cacheControl);
+        request->send(response);
+        return;
+    }
+
+    char gzPath[StaticAsset::MAX_PATH + 4];
+    snprintf(gzPath, sizeof(gzPath), "%s.gz", asset->path);
+    if (!fs_.exists(gzPath)) {
+        Logger::error("StaticAssetHandler: %s listed in manifest but missing.", gzPath);
+        request->send(404);
+        return;
+    }
+    AsyncWebServerResponse* response = request->beginResponse(fs_, gzPath, contentTypeFor(asset->path));
+    response->addHeader("Content-Encoding", "gzip");
+    response->addHeader("ETag", asset->etag);
+    response->addHeader("Cache-Control", cacheControl);
+    response->addHeader("Vary", "Accept-Encoding");
+    request->send(response);
+}
+
+} // namespace GrowController
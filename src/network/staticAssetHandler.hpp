@@ -0,0 +1,48 @@
+// src/network/staticAssetHandler.hpp
+#ifndef STATIC_ASSET_HANDLER_HPP
+#define STATIC_ASSET_HANDLER_HPP
+
+#include <ESPAsyncWebServer.h>
+#include <FS.h>
+#include "network/staticAssetManifest.hpp"
+
+namespace GrowController
+{
+
+  /**
+   * @brief Serves the pre-gzipped web assets listed in /assets.manifest.
+   *
+   * The manifest and the <asset>.gz files are produced at build time by
+   * scripts/build_web_assets.py. Each response carries Content-Encoding: gzip
+   * and a content-hash ETag; a matching If-None-Match gets 304 without touching
+   * the filesystem. Versioned assets (referenced as ?v=<hash>) are cached for a
+   * year, pages are revalidated on every load. Requests for paths not in the
+   * manifest fall through to the next handler (serveStatic).
+   */
+  class StaticAssetHandler : public AsyncWebHandler
+  {
+  public:
+    static const size_t MAX_ASSETS = 8;
+
+    explicit StaticAssetHandler(fs::FS &fs) : fs_(fs) {}
+
+    /**
+     * @brief Loads the manifest from the filesystem.
+     * @return Number of assets loaded (0 if the image was built without the asset script).
+     */
+    size_t loadManifest(const char *manifestPath = "/assets.manifest");
+
+    bool canHandle(AsyncWebServerRequest *request) override;
+    void handleRequest(AsyncWebServerRequest *request) override;
+
+  private:
+    const StaticAsset *_find(const String &url) const;
+
+    fs::FS &fs_;
+    StaticAsset assets_[MAX_ASSETS];
+    size_t assetCount_ = 0;
+  };
+
+} // namespace GrowController
+
+#endif // STATIC_ASSET_HANDLER_HPP
@@ -0,0 +1,86 @@
+// src/network/staticAssetManifest.hpp
+#ifndef STATIC_ASSET_MANIFEST_HPP
+#define STATIC_ASSET_MANIFEST_HPP
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace GrowController {
+
+/**
+ * @brief Uma entrada de /assets.manifest, gerado por scripts/build_web_assets.py.
+ * Linha: "<caminho> <etag> <immutable|revalidate>", ex: "/scripts.js 710d8bc33080091a immutable".
+ */
+struct StaticAsset {
+    static const size_t MAX_PATH = 32;
+    static const size_t HASH_LENGTH = 16;             // Hex do SHA-256 truncado (build_web_assets.py)
+    static const size_t MAX_ETAG = HASH_LENGTH + 3;   // Hash + aspas + '\0'
+
+    char path[MAX_PATH];   ///< Caminho da URL (o arquivo no LittleFS é path + ".gz")
+    char etag[MAX_ETAG];   ///< ETag já entre aspas, pronto para o cabeçalho
+    bool immutable;        ///< true: cache longo (referenciado com ?v=hash); false: revalidar sempre
+};
+
+/**
+ * @brief Interpreta uma linha do manifesto.
+ * @return false Se a linha está malformada ou algum campo não cabe nos buffers.
+ */
+inline bool parseStaticAssetLine(const char* line, StaticAsset& out) {
+    char path[StaticAsset::MAX_PATH];
+    char hash[StaticAsset::HASH_LENGTH + 1];
+    char cache[16];
+    int hashEnd = 0;
+    // Larguras fixas: sscanf nunca escreve além dos buffers (%n não conta no retorno)
+    if (line == nullptr || sscanf(line, "%31s %16s%n %15s", path, hash, &hashEnd, cache) != 3) {
+        return false;
+    }
+    // Exatamente HASH_LENGTH dígitos hex: um hash mais longo pararia no meio do campo
+    if (path[0] != '/' || strlen(hash) != StaticAsset::HASH_LENGTH || (line[hashEnd] != ' ' && line[hashEnd] != '\t')) {
+        return false;
+    }
+    for (size_t i = 0; i < StaticAsset::HASH_LENGTH; ++i) {
+        char c = hash[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))) {
+            return false;
+        }
+    }
+    bool immutable = strcmp(cache, "immutable") == 0;
+    if (!immutable && strcmp(cache, "revalidate") != 0) {
+        return false;
+    }
+    memcpy(out.path, path, sizeof(out.path));
+    snprintf(out.etag, sizeof(out.etag), "\"%.16s\"", hash);
+    out.immutable = immutable;
+    return true;
+}
+
+/**
+ * @brief Verifica se o If-None-Match do cliente contém o ETag (lista separada por vírgulas,
+ * aceita "*" e validadores fracos W/"...").
+ */
+inline bool etagMatches(const char* ifNoneMatch, const char* etag) {
+    if (ifNoneMatch == nullptr || etag == nullptr || etag[0] == '\0') {
+        return false;
+    }
+    size_t etagLen = strlen(etag);
+    const char* cursor = ifNoneMatch;
+    while (*cursor != '\0') {
+        while (*cursor == ' ' || *cursor == ',') ++cursor;
+        if (*cursor == '*') return true;
+        if (cursor[0] == 'W' && cursor[1] == '/') cursor += 2;
+        const char* end = cursor;
+        while (*end != '\0' && *end != ',') ++end;
+        const char* trimmed = end;
+        while (trimmed > cursor && trimmed[-1] == ' ') --trimmed;
+        if ((size_t)(trimmed - cursor) == etagLen && strncmp(cursor, etag, etagLen) == 0) {
+            return true;
+        }
+        cursor = end;
+    }
+    return false;
+}
+
+} // namespace GrowController
+
+#endif // STATIC_ASSET_MANIFEST_HPP
@@ -0,0 +1,157 @@
+// src/network/storeForwardQueue.hpp
+#ifndef STORE_FORWARD_QUEUE_HPP
+#define STORE_FORWARD_QUEUE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include "utils/ringBuffer.hpp"
+
+namespace GrowController {
+
+/**
+ * @brief Leitura de telemetria guardada enquanto o broker está inacessível.
+ */
+struct QueuedReading {
+    uint32_t timestamp; // Unix timestamp UTC (0 se o relógio não estava sincronizado)
+    float value;
+    uint8_t topic;      // MqttTopic
+    uint8_t reserved[3];
+};
+
+/**
+ * @brief Cabeçalho do arquivo de segmento. head/tail são contadores monotônicos;
+ * o slot físico de um registro é o contador módulo a capacidade.
+ */
+struct SpillHeader {
+    uint32_t magic;
+    uint32_t head; // Total de registros já consumidos
+    uint32_t tail; // Total de registros já escritos
+};
+
+/**
+ * @brief Lógica do store-and-forward sem E/S nem mutex (testável no host).
+ *
+ * RAM primeiro; quando ela enche, spillRam() move tudo para o segmento circular
+ * (escrita pelo chamador via callback). A frente da fila é sempre o registro mais
+ * antigo do segmento e, com ele vazio, o da RAM. Descartes por falta de espaço
+ * avançam version(): quem leu a frente antes de um descarte não remove o item
+ * errado (popFront() só remove se a versão ainda for a mesma).
+ * Quem usa segura o próprio mutex em volta de cada chamada.
+ */
+template <size_t RamCapacity, uint32_t SpillCapacity>
+class StoreForwardQueue {
+public:
+    enum class FrontStatus : uint8_t { Empty, Ready, Unreadable };
+
+    static size_t spillOffset(uint32_t logicalIndex) {
+        return sizeof(SpillHeader) + (size_t)(logicalIndex % SpillCapacity) * sizeof(QueuedReading);
+    }
+
+    /**
+     * @brief Adota um cabeçalho lido do arquivo, se for coerente com a capacidade.
+     */
+    bool restore(const SpillHeader& stored, uint32_t magic) {
+        if (stored.magic != magic || stored.tail - stored.head > SpillCapacity) {
+            return false;
+        }
+        spill_ = stored;
+        return true;
+    }
+
+    void resetSpill(uint32_t magic) { spill_ = {magic, 0, 0}; }
+
+    bool ramFull() const { return ram_.full(); }
+
+    /**
+     * @brief Guarda uma leitura na RAM. Com a RAM cheia, descarta a mais antiga dela antes.
+     * @return false Se houve descarte.
+     */
+    bool push(const QueuedReading& reading) {
+        bool stored = true;
+        if (ram_.full()) {
+            ram_.dropOldest();
+            _countDrop();
+            stored = false;
+        }
+        ram_.push(reading);
+        return stored;
+    }
+
+    /**
+     * @brief Move a RAM inteira para o segmento, na ordem. Segmento cheio descarta o mais antigo dele.
+     * @param write bool(size_t offset, const QueuedReading&): grava um registro no arquivo.
+     * @return false Se uma escrita falhou (o que já foi escrito continua valendo).
+     */
+    template <typename WriteFn>
+    bool spillRam(WriteFn write) {
+        QueuedReading reading;
+        while (ram_.peek(reading)) {
+            if (spill_.tail - spill_.head >= SpillCapacity) {
+                spill_.head++;
+                _countDrop();
+            }
+            if (!write(spillOffset(spill_.tail), reading)) {
+                return false;
+            }
+            spill_.tail++;
+            ram_.dropOldest();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Lê o mais antigo sem remover. Registro ilegível no segmento é descartado
+     * (para não travar a drenagem) e reportado como Unreadable.
+     * @param read bool(size_t offset, QueuedReading&): lê um registro do arquivo.
+     */
+    template <typename ReadFn>
+    FrontStatus front(QueuedReading& out, uint32_t* version, ReadFn read) {
+        *version = frontVersion_;
+        if (spill_.tail != spill_.head) {
+            if (read(spillOffset(spill_.head), out)) {
+                return FrontStatus::Ready;
+            }
+            spill_.head++;
+            _countDrop();
+            return FrontStatus::Unreadable;
+        }
+        return ram_.peek(out) ? FrontStatus::Ready : FrontStatus::Empty;
+    }
+
+    /**
+     * @brief Remove a frente lida com front(), se ela não mudou desde então.
+     * @return true Se o cabeçalho do segmento mudou (precisa ser regravado).
+     */
+    bool popFront(uint32_t versionSeen) {
+        if (frontVersion_ != versionSeen) {
+            return false; // A frente foi descartada: o item pode ser reentregue (duplicata é melhor que perda)
+        }
+        if (spill_.tail != spill_.head) {
+            spill_.head++;
+            return true;
+        }
+        ram_.dropOldest();
+        return false;
+    }
+
+    size_t size() const { return ram_.size() + (spill_.tail - spill_.head); }
+    size_t spilled() const { return spill_.tail - spill_.head; }
+    uint32_t droppedCount() const { return dropped_; }
+    uint32_t version() const { return frontVersion_; }
+    const SpillHeader& header() const { return spill_; }
+
+private:
+    void _countDrop() {
+        dropped_++;
+        frontVersion_++;
+    }
+
+    RingBuffer<QueuedReading, RamCapacity> ram_;
+    SpillHeader spill_ = {0, 0, 0};
+    uint32_t dropped_ = 0;
+    uint32_t frontVersion_ = 0; // Incrementado quando o item mais antigo é descartado por falta de espaço
+};
+
+} // namespace GrowController
+
+#endif // STORE_FORWARD_QUEUE_HPP
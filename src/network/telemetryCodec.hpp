@@ -0,0 +1,216 @@
+// src/network/telemetryCodec.hpp
+#ifndef TELEMETRY_CODEC_HPP
+#define TELEMETRY_CODEC_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "network/mqttTopics.hpp" // formatFloatPayload
+
+namespace GrowController {
+
+/**
+ * @brief Codificação do payload das leituras de sensor publicadas via MQTT.
+ * Selecionada em MQTTConfig::telemetryCodec (MQTT_TELEMETRY_CODEC).
+ */
+enum class TelemetryCodec : uint8_t {
+    Text = 0,   ///< "%.2f" (padrão, compatível com dashboards existentes)
+    Cbor = 1,   ///< Um float CBOR: meia precisão quando exato, senão float32
+    Binary = 2  ///< Struct little-endian com byte de versão (ver TELEMETRY_BINARY_*)
+};
+
+/**
+ * @brief Versões da struct binária. O primeiro byte do payload é sempre a versão.
+ * v1: { uint8 version; int16 LE valor*100 }   (3 bytes, |valor| <= 327.67)
+ * v2: { uint8 version; float32 LE valor }     (5 bytes, qualquer outro valor, inclusive NAN)
+ */
+static const uint8_t TELEMETRY_BINARY_V1_CENTI = 1;
+static const uint8_t TELEMETRY_BINARY_V2_FLOAT = 2;
+
+inline const char* telemetryCodecName(TelemetryCodec codec) {
+    switch (codec) {
+        case TelemetryCodec::Text:   return "text";
+        case TelemetryCodec::Cbor:   return "cbor";
+        case TelemetryCodec::Binary: return "binary";
+        default:                     return "unknown";
+    }
+}
+
+namespace detail {
+
+inline uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float floatFromBits(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Converte para meia precisão apenas se a conversão for exata (normais, zero, inf, NaN)
+inline bool floatToHalfExact(float value, uint16_t& half) {
+    uint32_t bits = floatBits(value);
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    int32_t exponent = (int32_t)((bits >> 23) & 0xFF);
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent == 0xFF) {
+        half = sign | 0x7C00 | (mantissa ? 0x0200 : 0); // NaN canônico ou infinito
+        return true;
+    }
+    if (exponent == 0 && mantissa == 0) {
+        half = sign; // +-0
+        return true;
+    }
+    int32_t halfExponent = exponent - 127 + 15;
+    if (halfExponent < 1 || halfExponent > 30 || (mantissa & 0x1FFF) != 0) {
+        return false; // Fora do alcance normal da meia precisão ou perderia bits
+    }
+    half = sign | (uint16_t)(halfExponent << 10) | (uint16_t)(mantissa >> 13);
+    return true;
+}
+
+inline float halfToFloat(uint16_t half) {
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    if (exponent == 0) {
+        float magnitude = ldexpf((float)mantissa, -24); // Subnormal
+        return sign ? -magnitude : magnitude;
+    }
+    if (exponent == 0x1F) {
+        return floatFromBits(sign | 0x7F800000 | (mantissa << 13));
+    }
+    return floatFromBits(sign | ((exponent - 15 + 127) << 23) | (mantissa << 13));
+}
+
+} // namespace detail
+
+/**
+ * @brief Codifica uma leitura no buffer de saída.
+ * @return size_t Bytes escritos, ou 0 se não coube / codec inválido.
+ */
+inline size_t encodeTelemetry(TelemetryCodec codec, float value, uint8_t* out, size_t size) {
+    if (out == nullptr) {
+        return 0;
+    }
+    switch (codec) {
+        case TelemetryCodec::Text: {
+            int len = formatFloatPayload((char*)out, size, value);
+            return len < 0 ? 0 : (size_t)len;
+        }
+        case TelemetryCodec::Cbor: {
+            uint16_t half;
+            if (detail::floatToHalfExact(value, half)) {
+                if (size < 3) return 0;
+                out[0] = 0xF9; // major 7, float16
+                out[1] = (uint8_t)(half >> 8);
+                out[2] = (uint8_t)(half & 0xFF);
+                return 3;
+            }
+            if (size < 5) return 0;
+            uint32_t bits = detail::floatBits(value);
+            out[0] = 0xFA; // major 7, float32 (big-endian)
+            out[1] = (uint8_t)(bits >> 24);
+            out[2] = (uint8_t)(bits >> 16);
+            out[3] = (uint8_t)(bits >> 8);
+            out[4] = (uint8_t)(bits & 0xFF);
+            return 5;
+        }
+        case TelemetryCodec::Binary: {
+            if (!isnan(value) && fabsf(value) <= 327.67f) {
+                if (size < 3) return 0;
+                int16_t centi = (int16_t)lroundf(value * 100.0f);
+                out[0] = TELEMETRY_BINARY_V1_CENTI;
+                out[1] = (uint8_t)((uint16_t)centi & 0xFF);
+                out[2] = (uint8_t)((uint16_t)centi >> 8);
+                return 3;
+            }
+            if (size < 5) return 0;
+            uint32_t bits = detail::floatBits(value);
+            out[0] = TELEMETRY_BINARY_V2_FLOAT;
+            out[1] = (uint8_t)(bits & 0xFF);
+            out[2] = (uint8_t)(bits >> 8);
+            out[3] = (uint8_t)(bits >> 16);
+            out[4] = (uint8_t)(bits >> 24);
+            return 5;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Decodifica um payload produzido por encodeTelemetry (uso no host/coletor e nos testes).
+ * Para CBOR também aceita float64 e inteiros, que outros produtores podem gerar.
+ * @return false Se o payload é malformado ou a versão é desconhecida.
+ */
+inline bool decodeTelemetry(TelemetryCodec codec, const uint8_t* in, size_t length, float& value) {
+    if (in == nullptr || length == 0) {
+        return false;
+    }
+    switch (codec) {
+        case TelemetryCodec::Text: {
+            char buffer[32];
+            if (length >= sizeof(buffer)) return false;
+            memcpy(buffer, in, length);
+            buffer[length] = '\0';
+            char* end = nullptr;
+            value = strtof(buffer, &end);
+            return end == buffer + length;
+        }
+        case TelemetryCodec::Cbor: {
+            uint8_t initial = in[0];
+            if (initial == 0xF9 && length == 3) {
+                value = detail::halfToFloat((uint16_t)((in[1] << 8) | in[2]));
+                return true;
+            }
+            if (initial == 0xFA && length == 5) {
+                value = detail::floatFromBits(((uint32_t)in[1] << 24) | ((uint32_t)in[2] << 16) |
+                                              ((uint32_t)in[3] << 8) | in[4]);
+                return true;
+            }
+            if (initial == 0xFB && length == 9) {
+                uint64_t bits = 0;
+                for (int i = 1; i <= 8; ++i) bits = (bits << 8) | in[i];
+                double wide;
+                memcpy(&wide, &bits, sizeof(wide));
+                value = (float)wide;
+                return true;
+            }
+            uint8_t major = initial >> 5;
+            uint8_t info = initial & 0x1F;
+            if (major > 1) return false;
+            uint32_t magnitude;
+            if (info < 24 && length == 1) magnitude = info;
+            else if (info == 24 && length == 2) magnitude = in[1];
+            else if (info == 25 && length == 3) magnitude = (uint32_t)((in[1] << 8) | in[2]);
+            else if (info == 26 && length == 5) magnitude = ((uint32_t)in[1] << 24) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 8) | in[4];
+            else return false;
+            value = major == 0 ? (float)magnitude : -1.0f - (float)magnitude;
+            return true;
+        }
+        case TelemetryCodec::Binary: {
+            if (in[0] == TELEMETRY_BINARY_V1_CENTI && length == 3) {
+                int16_t centi = (int16_t)(uint16_t)(in[1] | (in[2] << 8));
+                value = centi / 100.0f;
+                return true;
+            }
+            if (in[0] == TELEMETRY_BINARY_V2_FLOAT && length == 5) {
+                value = detail::floatFromBits((uint32_t)in[1] | ((uint32_t)in[2] << 8) |
+                                              ((uint32_t)in[3] << 16) | ((uint32_t)in[4] << 24));
+                return true;
+            }
+            return false;
+        }
+    }
+    return false;
+}
+
+} // namespace GrowController
+
+#endif // TELEMETRY_CODEC_HPP
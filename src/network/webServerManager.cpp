@@ -1,21 +1,33 @@
 #include "webServerManager.hpp"
 #include <LittleFS.h>
 #include <Arduino.h>    // Para String, etc.
+#include <WiFi.h>       // Para RSSI em /api/state
 #include "utils/logger.hpp"
+#include "utils/metrics.hpp"
 
 namespace GrowController {
 
+const TickType_t WebServerManager::SSE_COALESCE_WINDOW = pdMS_TO_TICKS(50);
+const TickType_t WebServerManager::LIVE_TICK = pdMS_TO_TICKS(50);
+
 WebServerManager::WebServerManager(uint16_t port,
                                    SensorManager* sensorMgr,
                                    TargetDataManager* targetMgr,
                                    ActuatorManager* actuatorMgr,
-                                   DataHistoryManager* historyMgr) :
+                                   DataHistoryManager* historyMgr,
+                                   RuntimeSettings* settings,
+                                   ChangeNotifier* notifier) :
     sensorManager_(sensorMgr),
     targetDataManager_(targetMgr),
     actuatorManager_(actuatorMgr),
     dataHistoryManager_(historyMgr), // << INICIALIZA NOVO MEMBRO
+    runtimeSettings_(settings),
+    changeNotifier_(notifier),
     server_(port),
     events_("/events"), // Define o endpoint para SSE
+    ws_("/ws"),
+    admissionHandler_(admission_, events_, ws_),
+    staticAssets_(LittleFS),
     port_(port)
 {
     if (!sensorManager_ || !targetDataManager_ || !actuatorManager_ || !dataHistoryManager_) {
@@ -25,138 +37,181 @@ WebServerManager::WebServerManager(uint16_t port,
 }
 
 WebServerManager::~WebServerManager() {
+    if (eventTaskHandle_ != nullptr) {
+        if (changeNotifier_) changeNotifier_->unsubscribe(eventTaskHandle_);
+        vTaskDelete(eventTaskHandle_);
+        eventTaskHandle_ = nullptr;
+    }
+    if (liveTaskHandle_ != nullptr) {
+        vTaskDelete(liveTaskHandle_);
+        liveTaskHandle_ = nullptr;
+    }
     server_.end();
     events_.close(); // Fecha todos os clientes SSE
+    ws_.closeAll();
 }
 
 void WebServerManager::begin() {
     // LittleFS.begin() é chamado no main.cpp
-    if (!LittleFS.exists("/index.html")) {
+    if (!LittleFS.exists("/index.html") && !LittleFS.exists("/index.html.gz")) {
         Logger::warn("WebServerManager: index.html not found in LittleFS. Web UI might not work.");
     }
 
+    // Controle de admissão antes de todos os outros handlers; ao fim de cada requisição admitida
+    // libera também o slot de corpo de POST (cobre uploads abortados)
+    admissionHandler_.onFinished([this](AsyncWebServerRequest *request) { bodyPool_.release(request); });
+    server_.addHandler(&admissionHandler_);
+
+    // Assets pré-comprimidos com ETag/304 primeiro; o serveStatic cobre imagens sem manifesto
+    staticAssets_.loadManifest();
+    server_.addHandler(&staticAssets_);
     server_.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
 
-    server_.on("/api/sensors", HTTP_GET, [this](AsyncWebServerRequest *request){
+    _onApiGet("/api/sensors", [this](AsyncWebServerRequest *request){
         if (!sensorManager_) {
             request->send(500, "application/json", "{\"error\":\"SensorManager not available\"}");
             return;
         }
-        JsonDocument doc;
-        float temp = sensorManager_->getTemperature();
-        float airHum = sensorManager_->getHumidity();
-        float soilHum = sensorManager_->getSoilHumidity();
-        float vpd = sensorManager_->getVpd();
-
-        if (!isnan(temp)) doc["temperature"] = temp;
-        if (!isnan(airHum)) doc["airHumidity"] = airHum;
-        if (!isnan(soilHum)) doc["soilHumidity"] = soilHum;
-        if (!isnan(vpd)) doc["vpd"] = vpd;
-
-        String jsonResponse;
-        serializeJson(doc, jsonResponse);
-        request->send(200, "application/json", jsonResponse);
+        _refreshSensorSnapshot();
+        char json[SENSOR_SNAPSHOT_SIZE];
+        if (sensorSnapshot_.read(json, sizeof(json)) == 0) {
+            request->send(503, "application/json", "{\"error\":\"Sensor snapshot unavailable\"}");
+            return;
+        }
+        request->send(200, "application/json", json);
     });
 
-    server_.on("/api/status", HTTP_GET, [this](AsyncWebServerRequest *request){
+    _onApiGet("/api/status", [this](AsyncWebServerRequest *request){
         if (!targetDataManager_ || !actuatorManager_) {
             request->send(500, "application/json", "{\"error\":\"DataManager or ActuatorManager not available\"}");
             return;
         }
-        JsonDocument doc;
-        JsonObject light = doc["light"].to<JsonObject>();
-        light["isOn"] = actuatorManager_->isLightRelayOn();
-        struct tm lightOn = targetDataManager_->getLightOnTime();
-        struct tm lightOff = targetDataManager_->getLightOffTime();
-        char timeBuf[6];
-        sprintf(timeBuf, "%02d:%02d", lightOn.tm_hour, lightOn.tm_min);
-        light["onTime"] = String(timeBuf);
-        sprintf(timeBuf, "%02d:%02d", lightOff.tm_hour, lightOff.tm_min);
-        light["offTime"] = String(timeBuf);
-
-        JsonObject humidifier = doc["humidifier"].to<JsonObject>();
-        humidifier["isOn"] = actuatorManager_->isHumidifierRelayOn();
-        float targetAirHum = targetDataManager_->getTargetAirHumidity();
-        if (!isnan(targetAirHum)) humidifier["targetAirHumidity"] = targetAirHum;
+        _refreshStatusSnapshot();
+        char json[STATUS_SNAPSHOT_SIZE];
+        if (statusSnapshot_.read(json, sizeof(json)) == 0) {
+            request->send(503, "application/json", "{\"error\":\"Status snapshot unavailable\"}");
+            return;
+        }
+        request->send(200, "application/json", json);
+    });
 
-        String jsonResponse;
-        serializeJson(doc, jsonResponse);
-        request->send(200, "application/json", jsonResponse);
+    // Estado completo do dashboard em uma única requisição (?fields=sensors,status,targets,system,history)
+    _onApiGet("/api/state", [this](AsyncWebServerRequest *request){
+        _handleState(request);
     });
 
     // >>> NOVO ENDPOINT: /api/history
-    server_.on("/api/history", HTTP_GET, [this](AsyncWebServerRequest *request){
+    _onApiGet("/api/history", [this](AsyncWebServerRequest *request){
         if (!dataHistoryManager_) {
             request->send(500, "application/json", "{\"error\":\"DataHistoryManager not available\"}");
             return;
         }
 
-        std::vector<HistoricDataPoint> history = dataHistoryManager_->getAllDataPointsSorted();
-        
-        // Capacidade para JSON: N objetos * ( overhead_obj + N_campos * overhead_campo_valor) + overhead_array
-        // Estimativa: 48 * (2 + 5 * (15+5)) + 2 = 48 * (2 + 100) + 2 ~ 4.9KB. Usar 8KB para segurança.
-        JsonDocument doc;
-        JsonArray array = doc.to<JsonArray>();
+        // ETag = cursor do registro mais recente: 304 até o próximo addDataPoint (um a cada ~30 min)
+        char etag[16];
+        formatHistoryEtag(etag, sizeof(etag), dataHistoryManager_->getCursor());
+        if (request->hasHeader("If-None-Match") && etagMatches(request->header("If-None-Match").c_str(), etag)) {
+            AsyncWebServerResponse *notModified = request->beginResponse(304);
+            notModified->addHeader("ETag", etag);
+            notModified->addHeader("Cache-Control", "no-cache");
+            request->send(notModified);
+            return;
+        }
 
-        for (const auto& point : history) {
-            JsonObject obj = array.add<JsonObject>();
-            obj["timestamp"] = point.timestamp;
-            
-            if (!isnan(point.avgTemperature)) obj["avgTemperature"] = point.avgTemperature;
-            if (!isnan(point.avgAirHumidity)) obj["avgAirHumidity"] = point.avgAirHumidity;
-            if (!isnan(point.avgSoilHumidity)) obj["avgSoilHumidity"] = point.avgSoilHumidity;
-            if (!isnan(point.avgVpd)) obj["avgVpd"] = point.avgVpd;
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        response->addHeader("ETag", etag);
+        response->addHeader("Cache-Control", "no-cache");
+        if (request->hasParam("since")) {
+            // Incremental: {"records":[...mais novos que since...],"cursor":N,"reset":false}
+            uint32_t since = strtoul(request->getParam("since")->value().c_str(), nullptr, 10);
+            HistoryWindow window = {0, 0, 0, false};
+            response->print("{\"records\":");
+            uint32_t cursor = _writeHistoryJson(*response, since, &window);
+            response->printf(",\"cursor\":%lu,\"reset\":%s}", (unsigned long)cursor, window.reset ? "true" : "false");
+        } else {
+            _writeHistoryJson(*response, 0); // Array completo, como antes
         }
+        request->send(response);
+    });
 
+    // Uso dos atuadores: contadores ao vivo + totais diários (?days=N, padrão 7, máx. 31)
+    _onApiGet("/api/actuators", [this](AsyncWebServerRequest *request){
+        if (!actuatorManager_) {
+            request->send(500, "application/json", "{\"error\":\"ActuatorManager not available\"}");
+            return;
+        }
+        _handleActuators(request);
+    });
+
+    // Intervalos ajustáveis em tempo de execução (mesmo conteúdo de <room>/config/state)
+    _onApiGet("/api/config", [this](AsyncWebServerRequest *request){
+        if (!runtimeSettings_) {
+            request->send(503, "application/json", "{\"error\":\"RuntimeSettings not available\"}");
+            return;
+        }
+        JsonDocument doc;
+        runtimeSettings_->toJson(doc);
+        doc["version"] = runtimeSettings_->getVersion();
         String jsonResponse;
         serializeJson(doc, jsonResponse);
-        // Logger::debug("Sending /api/history response, length: %d", jsonResponse.length());
-        // if (jsonResponse.length() < 500) Logger::debug("History JSON: %s", jsonResponse.c_str());
         request->send(200, "application/json", jsonResponse);
     });
 
-    // Handler para POST /api/targets (atualizado para usar buffer estático)
-    // Para evitar alocação dinâmica excessiva em onRequestBody, pode-se usar um buffer estático
-    // ou uma abordagem de streaming se o payload for muito grande.
-    // Aqui, vamos manter a lógica de acumular no `requestBodyBuffer` (que é static).
+    // Métricas no formato texto do Prometheus, escritas linha a linha no stream
+    server_.on("/metrics", HTTP_GET, [this](AsyncWebServerRequest *request){
+        Metrics::heapFreeBytes.set((int32_t)ESP.getFreeHeap());
+        Metrics::heapMinFreeBytes.set((int32_t)ESP.getMinFreeHeap());
+        Metrics::uptimeSeconds.set((int32_t)(millis() / 1000));
+        Metrics::wifiRssi.set(WiFi.RSSI());
+        Metrics::sseClients.set((int32_t)events_.count());
+        Metrics::wsClients.set((int32_t)ws_.count());
+        Metrics::httpActiveRequests.set((int32_t)admission_.active());
+        AsyncResponseStream *response = request->beginResponseStream("text/plain; version=0.0.4");
+        MetricRegistry::global().writePrometheus(*response);
+        request->send(response);
+    });
+
+    // Corpos de POST: cada requisição recebe seu próprio slot do bodyPool_ (tamanho fixo,
+    // 413 já no primeiro chunk se total passar do limite). Todos os callbacks rodam no async_tcp.
     server_.onRequestBody([this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-        if (request->url() == "/api/targets" && request->method() == HTTP_POST) {
-            static std::vector<uint8_t> requestBodyBuffer; // static para persistir entre chamadas parciais
-            
-            if (index == 0) { // Primeira parte do corpo
-                requestBodyBuffer.assign(data, data + len); // Começa novo buffer
-            } else { // Partes subsequentes
-                requestBodyBuffer.insert(requestBodyBuffer.end(), data, data + len);
+        bool isTargets = request->url() == "/api/targets";
+        if (request->method() != HTTP_POST || (!isTargets && request->url() != "/api/config")) {
+            return;
+        }
+        BodyPool::Body body;
+        switch (bodyPool_.append(request, data, len, index, total, &body)) {
+            case BodyPool::Status::Incomplete:
+                return;
+            case BodyPool::Status::TooLarge:
+                Metrics::httpRejectedTooLarge.inc();
+                Logger::warn("WebServerManager: %s body of %u bytes rejected (max %u).",
+                             request->url().c_str(), (unsigned)total, (unsigned)MAX_BODY_SIZE);
+                request->send(413, "application/json", "{\"success\":false, \"message\":\"Payload too large\"}");
+                return;
+            case BodyPool::Status::Busy: {
+                Metrics::httpRejectedBusy.inc();
+                AsyncWebServerResponse *response = request->beginResponse(503, "application/json",
+                    "{\"success\":false, \"message\":\"Too many concurrent uploads\"}");
+                response->addHeader("Retry-After", "1");
+                request->send(response);
+                return;
             }
-
-            if (index + len == total) { // Corpo completo recebido
-                // Logger::debug("POST /api/targets body (%d bytes): %.*s", total, total, (const char*)requestBodyBuffer.data());
-                JsonDocument doc;
-                DeserializationError error = deserializeJson(doc, requestBodyBuffer.data(), requestBodyBuffer.size());
-                
-                // Limpar o buffer estático para a próxima requisição
-                // requestBodyBuffer.clear(); // Não precisa mais se assign é usado no início
-
-                if (error) {
-                    Logger::error("deserializeJson() failed for /api/targets: %s", error.c_str());
-                    request->send(400, "application/json", "{\"success\":false, \"message\":\"Invalid JSON format\"}");
-                    return;
-                }
-
-                if (!targetDataManager_) {
-                    request->send(500, "application/json", "{\"success\":false, \"message\":\"TargetDataManager not available\"}");
-                    return;
+            case BodyPool::Status::Invalid:
+                if (index == 0) { // Em index > 0 a requisição já foi respondida
+                    request->send(400, "application/json", "{\"success\":false, \"message\":\"Malformed body\"}");
                 }
+                return;
+            case BodyPool::Status::Complete:
+                break;
+        }
 
-                bool success = targetDataManager_->updateTargetsFromJson(doc);
-                if (success) {
-                    request->send(200, "application/json", "{\"success\":true, \"message\":\"Targets updated successfully.\"}");
-                    this->sendStatusUpdateEvent(); // Notificar clientes SSE
-                } else {
-                    request->send(400, "application/json", "{\"success\":false, \"message\":\"Error updating targets or no valid data.\"}");
-                }
-            }
+        Metrics::httpRequests.inc();
+        if (isTargets) {
+            _handleTargetsBody(request, body.data, body.length);
+        } else {
+            _handleConfigBody(request, body.data, body.length);
         }
+        bodyPool_.release(request);
     });
 
     // Configuração do Server-Sent Events
@@ -166,12 +221,26 @@ void WebServerManager::begin() {
         } else {
             // Logger::info("SSE Client connected");
         }
-        // Enviar estado inicial imediatamente após a conexão
-        sendSensorUpdateEvent();
-        sendStatusUpdateEvent();
+        // Enviar estado inicial só para este cliente (os demais já têm a versão atual)
+        char json[STATUS_SNAPSHOT_SIZE > SENSOR_SNAPSHOT_SIZE ? STATUS_SNAPSHOT_SIZE : SENSOR_SNAPSHOT_SIZE];
+        if (sensorManager_) {
+            _refreshSensorSnapshot();
+            if (sensorSnapshot_.read(json, sizeof(json)) > 0) client->send(json, "sensor_update", millis());
+        }
+        if (targetDataManager_ && actuatorManager_) {
+            _refreshStatusSnapshot();
+            if (statusSnapshot_.read(json, sizeof(json)) > 0) client->send(json, "status_update", millis());
+        }
     });
     server_.addHandler(&events_);
 
+    // Stream binário (frames em network/liveFrame.hpp)
+    ws_.onEvent([this](AsyncWebSocket * /*server*/, AsyncWebSocketClient *client, AwsEventType type,
+                       void *arg, uint8_t *data, size_t len) {
+        _onLiveEvent(client, type, arg, data, len);
+    });
+    server_.addHandler(&ws_);
+
     server_.onNotFound([](AsyncWebServerRequest *request){
         // Logger::warn("WebServer: Resource Not Found - %s", request->url().c_str());
         if (request->url().startsWith("/api/")) {
@@ -188,16 +257,9 @@ void WebServerManager::begin() {
     Logger::info("WebServerManager: HTTP server started on port %d.", port_);
 }
 
-// Envio de eventos SSE
-void WebServerManager::sendSensorUpdateEvent() {
-    if (!sensorManager_ || events_.count() == 0) { // Só envia se houver clientes SSE conectados
-        return;
-    }
-    // Controle de frequência (opcional, mas bom para não sobrecarregar)
-    if (millis() - lastSensorEventTime_ < eventIntervalMs_ && lastSensorEventTime_ != 0) {
-        return;
-    }
-    
+// --- Snapshots JSON ---
+
+size_t WebServerManager::_serializeSensorJson(char* out, size_t size) {
     JsonDocument doc;
     float temp = sensorManager_->getTemperature();
     float airHum = sensorManager_->getHumidity();
@@ -207,42 +269,521 @@ void WebServerManager::sendSensorUpdateEvent() {
     if (!isnan(airHum)) doc["airHumidity"] = airHum;
     if (!isnan(soilHum)) doc["soilHumidity"] = soilHum;
     if (!isnan(vpd)) doc["vpd"] = vpd;
+    if (doc.isNull()) {
+        doc.to<JsonObject>(); // Sem leituras válidas ainda: "{}"
+    }
+    return serializeJson(doc, out, size);
+}
 
-    String jsonString;
-    serializeJson(doc, jsonString);
-    events_.send(jsonString.c_str(), "sensor_update", millis());
-    lastSensorEventTime_ = millis();
+size_t WebServerManager::_serializeStatusJson(char* out, size_t size) {
+    JsonDocument doc;
+    TargetValues targets = targetDataManager_->getTargets(); // Um único lock para todos os alvos
+    JsonObject light = doc["light"].to<JsonObject>();
+    light["isOn"] = actuatorManager_->isLightRelayOn();
+    char timeBuf[6];
+    snprintf(timeBuf, sizeof(timeBuf), "%02d:%02d", targets.lightOnTime.tm_hour, targets.lightOnTime.tm_min);
+    light["onTime"] = timeBuf;
+    snprintf(timeBuf, sizeof(timeBuf), "%02d:%02d", targets.lightOffTime.tm_hour, targets.lightOffTime.tm_min);
+    light["offTime"] = timeBuf;
+
+    JsonObject humidifier = doc["humidifier"].to<JsonObject>();
+    humidifier["isOn"] = actuatorManager_->isHumidifierRelayOn();
+    if (isnan(targets.airHumidity)) humidifier["targetAirHumidity"] = nullptr;
+    else humidifier["targetAirHumidity"] = targets.airHumidity;
+    humidifier["mode"] = humidityControlModeName(targets.humidityControl.mode);
+    humidifier["climate"] = climateModeName(targets.climateMode);
+    // Alvo em uso: no modo VPD, a UR derivada da temperatura atual
+    float effective = actuatorManager_->getActuatorTarget(ActuatorManager::ACTUATOR_HUMIDIFIER);
+    if (isnan(effective)) humidifier["effectiveTarget"] = nullptr;
+    else humidifier["effectiveTarget"] = roundf(effective * 10.0f) / 10.0f;
+
+    if (actuatorManager_->getActuatorCount() > ActuatorManager::ACTUATOR_IRRIGATION) {
+        JsonObject irrigation = doc["irrigation"].to<JsonObject>();
+        irrigation["isOn"] = actuatorManager_->isActuatorOn(ActuatorManager::ACTUATOR_IRRIGATION);
+        if (isnan(targets.soilHumidity)) irrigation["targetSoilHumidity"] = nullptr;
+        else irrigation["targetSoilHumidity"] = targets.soilHumidity;
+    }
+
+    return serializeJson(doc, out, size);
 }
 
-void WebServerManager::sendStatusUpdateEvent() {
-    if (!targetDataManager_ || !actuatorManager_ || events_.count() == 0) {
+void WebServerManager::_refreshSensorSnapshot() {
+    uint32_t source = sensorManager_->getDataVersion();
+    if (sensorSnapshot_.version() != 0 && source == sensorSnapshotSource_) {
+        return; // Nada mudou desde o último snapshot
+    }
+    if (xSemaphoreTake(snapshotMutex_.get(), 0) != pdTRUE) {
+        return; // Outro task já está montando; usa o snapshot publicado
+    }
+    source = sensorManager_->getDataVersion(); // Relê: leituras feitas depois daqui geram novo snapshot
+    if (sensorSnapshot_.write([this](char* out, size_t size) { return _serializeSensorJson(out, size); })) {
+        sensorSnapshotSource_ = source;
+    } else {
+        Logger::warn("WebServerManager: Sensor JSON does not fit the snapshot buffer.");
+    }
+    xSemaphoreGive(snapshotMutex_.get());
+}
+
+void WebServerManager::_refreshStatusSnapshot() {
+    // Alvos e relés são monotônicos: a soma muda sempre que qualquer um muda
+    uint32_t source = targetDataManager_->getDataVersion() + actuatorManager_->getStateVersion();
+    if (statusSnapshot_.version() != 0 && source == statusSnapshotSource_) {
         return;
     }
-    if (millis() - lastStatusEventTime_ < eventIntervalMs_ && lastStatusEventTime_ != 0) {
+    if (xSemaphoreTake(snapshotMutex_.get(), 0) != pdTRUE) {
         return;
     }
+    source = targetDataManager_->getDataVersion() + actuatorManager_->getStateVersion();
+    if (statusSnapshot_.write([this](char* out, size_t size) { return _serializeStatusJson(out, size); })) {
+        statusSnapshotSource_ = source;
+    } else {
+        Logger::warn("WebServerManager: Status JSON does not fit the snapshot buffer.");
+    }
+    xSemaphoreGive(snapshotMutex_.get());
+}
+
+void WebServerManager::_onApiGet(const char* uri, ArRequestHandlerFunction handler) {
+    server_.on(uri, HTTP_GET, [handler](AsyncWebServerRequest *request) {
+        uint32_t startUs = micros();
+        Metrics::httpRequests.inc();
+        handler(request);
+        Metrics::httpHandlerDuration.observe(micros() - startUs);
+    });
+}
 
+// --- Corpos de POST ---
+
+void WebServerManager::_handleTargetsBody(AsyncWebServerRequest* request, const uint8_t* data, size_t length) {
     JsonDocument doc;
-    JsonObject light = doc["light"].to<JsonObject>();
-    light["isOn"] = actuatorManager_->isLightRelayOn();
-    struct tm lightOn = targetDataManager_->getLightOnTime();
-    struct tm lightOff = targetDataManager_->getLightOffTime();
-    char timeBuf[6];
-    sprintf(timeBuf, "%02d:%02d", lightOn.tm_hour, lightOn.tm_min);
-    light["onTime"] = String(timeBuf);
-    sprintf(timeBuf, "%02d:%02d", lightOff.tm_hour, lightOff.tm_min);
-    light["offTime"] = String(timeBuf);
+    DeserializationError error = deserializeJson(doc, data, length);
+    if (error) {
+        Logger::error("deserializeJson() failed for /api/targets: %s", error.c_str());
+        request->send(400, "application/json", "{\"success\":false, \"message\":\"Invalid JSON format\"}");
+        return;
+    }
 
-    JsonObject humidifier = doc["humidifier"].to<JsonObject>();
-    humidifier["isOn"] = actuatorManager_->isHumidifierRelayOn();
-    float targetAirHum = targetDataManager_->getTargetAirHumidity();
-    if (isnan(targetAirHum)) humidifier["targetAirHumidity"] = nullptr;
-    else humidifier["targetAirHumidity"] = targetAirHum;
+    if (!targetDataManager_) {
+        request->send(500, "application/json", "{\"success\":false, \"message\":\"TargetDataManager not available\"}");
+        return;
+    }
+
+    bool success = targetDataManager_->updateTargetsFromJson(doc);
+    if (success) {
+        // Os clientes SSE são avisados pelo ChangeNotifier do TargetDataManager
+        request->send(200, "application/json", "{\"success\":true, \"message\":\"Targets updated successfully.\"}");
+    } else {
+        request->send(400, "application/json", "{\"success\":false, \"message\":\"Error updating targets or no valid data.\"}");
+    }
+}
+
+void WebServerManager::_handleConfigBody(AsyncWebServerRequest* request, const uint8_t* data, size_t length) {
+    if (!runtimeSettings_) {
+        request->send(503, "application/json", "{\"success\":false, \"message\":\"RuntimeSettings not available\"}");
+        return;
+    }
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, data, length);
+    if (error) {
+        Logger::error("deserializeJson() failed for /api/config: %s", error.c_str());
+        request->send(400, "application/json", "{\"success\":false, \"message\":\"Invalid JSON format\"}");
+        return;
+    }
 
-    String jsonString;
-    serializeJson(doc, jsonString);
-    events_.send(jsonString.c_str(), "status_update", millis());
-    lastStatusEventTime_ = millis();
+    char message[80] = {0};
+    JsonDocument response;
+    bool success = runtimeSettings_->updateFromJson(doc, message, sizeof(message));
+    response["success"] = success;
+    if (success) {
+        runtimeSettings_->toJson(response);
+        response["version"] = runtimeSettings_->getVersion();
+    } else {
+        response["message"] = message;
+    }
+    String jsonResponse;
+    serializeJson(response, jsonResponse);
+    request->send(success ? 200 : 400, "application/json", jsonResponse);
+}
+
+// --- /api/state ---
+
+void WebServerManager::_handleActuators(AsyncWebServerRequest* request) {
+    size_t days = ACTUATOR_DAYS_DEFAULT;
+    if (request->hasParam("days")) {
+        days = strtoul(request->getParam("days")->value().c_str(), nullptr, 10);
+        if (days > (size_t)DataHistoryManager::MAX_USAGE_DAYS) days = DataHistoryManager::MAX_USAGE_DAYS;
+    }
+
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    response->addHeader("Cache-Control", "no-cache");
+    response->printf("{\"day\":%lu,\"actuators\":[", (unsigned long)actuatorManager_->getUsageDay());
+    size_t count = actuatorManager_->getActuatorCount();
+    for (size_t i = 0; i < count; ++i) {
+        const ActuatorDescriptor& actuator = actuatorManager_->getActuatorDescriptor(i);
+        ActuatorUsageSnapshot usage;
+        if (!actuatorManager_->getActuatorUsage(i, &usage)) {
+            usage = ActuatorUsageSnapshot();
+        }
+        uint32_t todayOnSeconds = usage.todayOnMs / 1000;
+        response->printf("%s{\"name\":\"%s\",\"pin\":%d,\"on\":%s,\"stateSeconds\":%lu,"
+                         "\"onSeconds\":%llu,\"switches\":%lu,\"todayOnSeconds\":%lu,\"todaySwitches\":%lu,"
+                         "\"duty1h\":%.3f,\"duty24h\":%.3f,\"watts\":%.1f,\"todayWh\":%.1f}",
+                         i > 0 ? "," : "", actuator.name, actuator.pin, usage.on ? "true" : "false",
+                         (unsigned long)(usage.onForMs / 1000), (unsigned long long)(usage.totalOnMs / 1000),
+                         (unsigned long)usage.totalSwitches, (unsigned long)todayOnSeconds,
+                         (unsigned long)usage.todaySwitches, usage.duty1h, usage.duty24h, actuator.ratedWatts,
+                         energyWh(todayOnSeconds, actuator.ratedWatts));
+    }
+
+    // Dias fechados (e o checkpoint de hoje), do mais antigo ao mais recente
+    response->print("],\"daily\":[");
+    ActuatorDailyUsage records[DataHistoryManager::MAX_USAGE_DAYS]; // ~870 bytes na pilha no pior caso
+    size_t read = (dataHistoryManager_ && days > 0) ? dataHistoryManager_->readDailyUsage(records, days) : 0;
+    for (size_t r = 0; r < read; ++r) {
+        response->printf("%s{\"day\":%lu,\"actuators\":[", r > 0 ? "," : "", (unsigned long)records[r].day);
+        for (size_t i = 0; i < records[r].count && i < count; ++i) {
+            const ActuatorDescriptor& actuator = actuatorManager_->getActuatorDescriptor(i);
+            response->printf("%s{\"name\":\"%s\",\"onSeconds\":%lu,\"switches\":%u,\"wh\":%.1f}",
+                             i > 0 ? "," : "", actuator.name, (unsigned long)records[r].onSeconds[i],
+                             (unsigned)records[r].switches[i],
+                             energyWh(records[r].onSeconds[i], actuator.ratedWatts));
+        }
+        response->print("]}");
+    }
+    response->print("]}");
+    request->send(response);
+}
+
+void WebServerManager::_handleState(AsyncWebServerRequest* request) {
+    const char* unknown = nullptr;
+    uint8_t fields = parseStateFields(request->hasParam("fields") ? request->getParam("fields")->value().c_str() : nullptr,
+                                      &unknown);
+    if (fields == 0) {
+        request->send(400, "application/json", "{\"error\":\"Unknown field in 'fields'\"}");
+        return;
+    }
+    size_t historyLimit = STATE_HISTORY_DEFAULT;
+    if (request->hasParam("historyLimit")) {
+        long limit = atol(request->getParam("historyLimit")->value().c_str());
+        historyLimit = (limit < 1) ? 1 : (size_t)limit;
+    }
+
+    // Sem documento JSON do estado inteiro: cada seção é escrita direto no stream
+    AsyncResponseStream* response = request->beginResponseStream("application/json");
+    response->print('{');
+    bool first = true;
+    auto section = [&](const char* name) {
+        response->printf("%s\"%s\":", first ? "" : ",", name);
+        first = false;
+    };
+
+    if ((fields & STATE_FIELD_SENSORS) && sensorManager_) {
+        _refreshSensorSnapshot();
+        char json[SENSOR_SNAPSHOT_SIZE];
+        if (sensorSnapshot_.read(json, sizeof(json)) > 0) {
+            section("sensors");
+            response->print(json);
+        }
+    }
+    if ((fields & STATE_FIELD_STATUS) && targetDataManager_ && actuatorManager_) {
+        _refreshStatusSnapshot();
+        char json[STATUS_SNAPSHOT_SIZE];
+        if (statusSnapshot_.read(json, sizeof(json)) > 0) {
+            section("status");
+            response->print(json);
+        }
+    }
+    if ((fields & STATE_FIELD_TARGETS) && targetDataManager_) {
+        TargetValues targets = targetDataManager_->getTargets();
+        JsonDocument doc;
+        char timeBuf[6];
+        if (!isnan(targets.airHumidity)) doc["airHumidity"] = targets.airHumidity; else doc["airHumidity"] = nullptr;
+        if (!isnan(targets.vpd)) doc["vpd"] = targets.vpd; else doc["vpd"] = nullptr;
+        if (!isnan(targets.soilHumidity)) doc["soilHumidity"] = targets.soilHumidity; else doc["soilHumidity"] = nullptr;
+        if (!isnan(targets.temperature)) doc["temperature"] = targets.temperature; else doc["temperature"] = nullptr;
+        snprintf(timeBuf, sizeof(timeBuf), "%02d:%02d", targets.lightOnTime.tm_hour, targets.lightOnTime.tm_min);
+        doc["lightOnTime"] = timeBuf;
+        snprintf(timeBuf, sizeof(timeBuf), "%02d:%02d", targets.lightOffTime.tm_hour, targets.lightOffTime.tm_min);
+        doc["lightOffTime"] = timeBuf;
+        doc["climateMode"] = climateModeName(targets.climateMode);
+        auto writeControl = [&doc](const char* key, const HumidityControlParams& params) {
+            JsonObject control = doc[key].to<JsonObject>();
+            control["mode"] = humidityControlModeName(params.mode);
+            control["band"] = params.band;
+            control["minOnS"] = params.minOnMs / 1000;
+            control["minOffS"] = params.minOffMs / 1000;
+            control["kp"] = params.kp;
+            control["ki"] = params.ki;
+            control["kd"] = params.kd;
+            control["windowS"] = params.windowMs / 1000;
+        };
+        writeControl("humidityControl", targets.humidityControl);
+        writeControl("irrigationControl", targets.irrigationControl);
+        section("targets");
+        serializeJson(doc, *response);
+    }
+    if (fields & STATE_FIELD_SYSTEM) {
+        section("system");
+        response->printf("{\"uptimeS\":%lu,\"freeHeap\":%lu,\"minFreeHeap\":%lu,\"rssi\":%d,\"historyRecords\":%u}",
+                         (unsigned long)(millis() / 1000), (unsigned long)ESP.getFreeHeap(),
+                         (unsigned long)ESP.getMinFreeHeap(), (int)WiFi.RSSI(),
+                         dataHistoryManager_ ? (unsigned)dataHistoryManager_->getRecordCount() : 0u);
+    }
+    if ((fields & STATE_FIELD_HISTORY) && dataHistoryManager_) {
+        section("history");
+        uint32_t latest = dataHistoryManager_->getCursor();
+        _writeHistoryJson(*response, latest > historyLimit ? latest - historyLimit : 0);
+    }
+    response->print('}');
+    request->send(response);
+}
+
+uint32_t WebServerManager::_writeHistoryJson(Print& out, uint32_t since, HistoryWindow* window) {
+    // Registros com cursor > since, lidos do LittleFS em blocos (mesmo formato de objeto de sempre)
+    HistoricDataPoint chunk[STATE_HISTORY_CHUNK];
+    uint32_t cursor = since;
+    bool firstPoint = true;
+    out.print('[');
+    while (true) {
+        HistoryWindow range = {0, 0, 0, false};
+        size_t count = dataHistoryManager_->readSince(cursor, chunk, STATE_HISTORY_CHUNK, &cursor, &range);
+        if (firstPoint && window) {
+            *window = range;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const HistoricDataPoint& point = chunk[i];
+            out.printf("%s{\"timestamp\":%lu", firstPoint ? "" : ",", (unsigned long)point.timestamp);
+            if (!isnan(point.avgTemperature)) out.printf(",\"avgTemperature\":%.2f", point.avgTemperature);
+            if (!isnan(point.avgAirHumidity)) out.printf(",\"avgAirHumidity\":%.2f", point.avgAirHumidity);
+            if (!isnan(point.avgSoilHumidity)) out.printf(",\"avgSoilHumidity\":%.2f", point.avgSoilHumidity);
+            if (!isnan(point.avgVpd)) out.printf(",\"avgVpd\":%.2f", point.avgVpd);
+            out.print('}');
+            firstPoint = false;
+        }
+        if (count < STATE_HISTORY_CHUNK) {
+            break;
+        }
+    }
+    out.print(']');
+    return cursor;
+}
+
+// --- Tarefa de push SSE ---
+
+bool WebServerManager::startEventTask(UBaseType_t priority, uint32_t stackSize) {
+    if (!changeNotifier_) {
+        Logger::warn("WebServerManager: No ChangeNotifier, SSE events only sent on connect.");
+        return true;
+    }
+    if (eventTaskHandle_ != nullptr) {
+        return true;
+    }
+    BaseType_t result = xTaskCreate(eventTaskWrapper, "SseTask", stackSize, this, priority, &eventTaskHandle_);
+    if (result != pdPASS) {
+        eventTaskHandle_ = nullptr;
+        Logger::error("WebServerManager: Failed to create SSE task! Error code: %d", result);
+        return false;
+    }
+    return true;
+}
+
+void WebServerManager::eventTaskWrapper(void* pvParameters) {
+    WebServerManager* instance = static_cast<WebServerManager*>(pvParameters);
+    if (instance) {
+        instance->runEventTask();
+    }
+    vTaskDelete(NULL);
+}
+
+void WebServerManager::runEventTask() {
+    if (!changeNotifier_->subscribe(xTaskGetCurrentTaskHandle(), CHANGE_SENSORS | CHANGE_STATUS)) {
+        Logger::error("WebServerManager: ChangeNotifier subscriber table full, SSE push disabled.");
+    }
+    Logger::info("WebServerManager: SSE push task started.");
+    while (true) {
+        uint32_t changes = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &changes, portMAX_DELAY); // Dorme até algo mudar
+
+        // Rajadas (ex: alvo novo + relé reagindo) viram um único evento de cada tipo
+        vTaskDelay(SSE_COALESCE_WINDOW);
+        uint32_t more = 0;
+        if (xTaskNotifyWait(0, UINT32_MAX, &more, 0) == pdTRUE) {
+            changes |= more;
+        }
+
+        if (changes & CHANGE_SENSORS) sendSensorUpdateEvent();
+        if (changes & CHANGE_STATUS) sendStatusUpdateEvent();
+    }
+}
+
+// --- Stream binário /ws ---
+
+bool WebServerManager::startLiveTask(UBaseType_t priority, uint32_t stackSize) {
+    if (liveTaskHandle_ != nullptr) {
+        return true;
+    }
+    BaseType_t result = xTaskCreate(liveTaskWrapper, "LiveTask", stackSize, this, priority, &liveTaskHandle_);
+    if (result != pdPASS) {
+        liveTaskHandle_ = nullptr;
+        Logger::error("WebServerManager: Failed to create live stream task! Error code: %d", result);
+        return false;
+    }
+    return true;
+}
+
+void WebServerManager::liveTaskWrapper(void* pvParameters) {
+    WebServerManager* instance = static_cast<WebServerManager*>(pvParameters);
+    if (instance) {
+        instance->runLiveTask();
+    }
+    vTaskDelete(NULL);
+}
+
+void WebServerManager::_onLiveEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg,
+                                    uint8_t* data, size_t len) {
+    // Desconexão espera o mutex o quanto for preciso: o cliente é liberado pela biblioteca logo
+    // depois deste evento, e o slot precisa estar limpo antes disso (a LiveTask o usaria)
+    TickType_t wait = (type == WS_EVT_DISCONNECT) ? portMAX_DELAY : pdMS_TO_TICKS(20);
+    if (xSemaphoreTake(liveMutex_.get(), wait) != pdTRUE) {
+        if (type == WS_EVT_CONNECT) client->close(1013, "Busy");
+        return;
+    }
+    LiveClient* slot = nullptr;
+    for (auto& entry : liveClients_) {
+        if (entry.id == client->id()) slot = &entry;
+    }
+
+    if (type == WS_EVT_CONNECT) {
+        for (auto& entry : liveClients_) {
+            if (slot == nullptr && entry.id == 0) slot = &entry;
+        }
+        if (slot == nullptr) {
+            Logger::warn("WebServerManager: /ws full (%u clients), rejecting client %u.",
+                         (unsigned)MAX_LIVE_CLIENTS, (unsigned)client->id());
+            client->close(1013, "Too many clients");
+        } else {
+            *slot = LiveClient();
+            slot->id = client->id();
+            if (liveTaskHandle_) xTaskNotifyGive(liveTaskHandle_); // Acorda a LiveTask
+        }
+    } else if (type == WS_EVT_DISCONNECT) {
+        if (slot) {
+            if (slot->dropped > 0) {
+                Logger::debug("WebServerManager: /ws client %u dropped %u stale frames.",
+                              (unsigned)slot->id, (unsigned)slot->dropped);
+            }
+            *slot = LiveClient();
+        }
+    } else if (type == WS_EVT_DATA && slot) {
+        // Comandos de texto curtos chegam num único frame
+        AwsFrameInfo* info = static_cast<AwsFrameInfo*>(arg);
+        uint16_t rateMs;
+        if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT &&
+            parseLiveRateCommand(reinterpret_cast<const char*>(data), len, rateMs)) {
+            slot->rateMs = rateMs;
+            slot->lastSensorMs = 0; // Primeiro frame na nova taxa sai já
+        }
+    }
+    xSemaphoreGive(liveMutex_.get());
+}
+
+void WebServerManager::runLiveTask() {
+    Logger::info("WebServerManager: Live stream task started.");
+    uint16_t sequence = 0;
+    while (true) {
+        if (ws_.count() == 0) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Sem clientes: dorme até um WS_EVT_CONNECT
+            continue;
+        }
+        vTaskDelay(LIVE_TICK);
+        ws_.cleanupClients(MAX_LIVE_CLIENTS);
+
+        uint32_t now = millis();
+        uint8_t relays = 0;
+        if (actuatorManager_) {
+            if (actuatorManager_->isLightRelayOn()) relays |= LIVE_RELAY_LIGHT;
+            if (actuatorManager_->isHumidifierRelayOn()) relays |= LIVE_RELAY_HUMIDIFIER;
+            if (actuatorManager_->isActuatorOn(ActuatorManager::ACTUATOR_IRRIGATION)) relays |= LIVE_RELAY_IRRIGATION;
+        }
+        // Leituras fora do mutex: os getters podem esperar o mutex do SensorManager, e o
+        // evento de desconexão (task do AsyncTCP) não pode ficar preso atrás disso
+        LiveSensorSample sample;
+        if (sensorManager_) {
+            sample.temperature = sensorManager_->getTemperature();
+            sample.airHumidity = sensorManager_->getHumidity();
+            sample.soilHumidity = sensorManager_->getSoilHumidity();
+            sample.vpd = sensorManager_->getVpd();
+            sample.soilAdc = sensorManager_->readSoilAdcNow();
+        }
+        uint8_t sensorFrame[LIVE_FRAME_SENSORS_SIZE];
+        size_t sensorFrameLength = 0; // Montado no máximo uma vez por tick, só se algum cliente estiver no prazo
+
+        if (xSemaphoreTake(liveMutex_.get(), LIVE_TICK) != pdTRUE) {
+            continue;
+        }
+        for (auto& entry : liveClients_) {
+            if (entry.id == 0) continue;
+            AsyncWebSocketClient* client = ws_.client(entry.id);
+            if (client == nullptr || client->status() != WS_CONNECTED) {
+                entry = LiveClient();
+                continue;
+            }
+            bool sensorDue = sensorManager_ && (entry.lastSensorMs == 0 || now - entry.lastSensorMs >= entry.rateMs);
+            bool relaysDue = actuatorManager_ && relays != entry.sentRelays;
+            if (!sensorDue && !relaysDue) continue;
+
+            // Buffer TCP cheio: descarta em vez de enfileirar; o próximo tick manda dados mais novos
+            if (client->queueIsFull() || !client->client()->canSend()) {
+                entry.dropped++;
+                continue;
+            }
+            if (relaysDue) {
+                uint8_t frame[LIVE_FRAME_ACTUATORS_SIZE];
+                uint8_t changed = (entry.sentRelays == 0xFF)
+                                      ? (uint8_t)(LIVE_RELAY_LIGHT | LIVE_RELAY_HUMIDIFIER | LIVE_RELAY_IRRIGATION)
+                                      : (uint8_t)(relays ^ entry.sentRelays);
+                size_t length = encodeLiveActuatorFrame(relays, changed, sequence++, now, frame, sizeof(frame));
+                client->binary(frame, length);
+                entry.sentRelays = relays;
+            }
+            if (sensorDue) {
+                if (sensorFrameLength == 0) {
+                    sensorFrameLength = encodeLiveSensorFrame(sample, sequence++, now, sensorFrame, sizeof(sensorFrame));
+                }
+                client->binary(sensorFrame, sensorFrameLength);
+                entry.lastSensorMs = now;
+            }
+        }
+        xSemaphoreGive(liveMutex_.get());
+    }
+}
+
+// Envio de eventos SSE
+void WebServerManager::sendSensorUpdateEvent() {
+    if (!sensorManager_ || events_.count() == 0) { // Só envia se houver clientes SSE conectados
+        return;
+    }
+    _refreshSensorSnapshot();
+    char json[SENSOR_SNAPSHOT_SIZE];
+    uint32_t version = 0;
+    if (sensorSnapshot_.read(json, sizeof(json), &version) == 0 || version == lastSentSensorVersion_) {
+        return; // Sem snapshot ou os clientes já têm esta versão
+    }
+    events_.send(json, "sensor_update", millis());
+    lastSentSensorVersion_ = version;
+}
+
+void WebServerManager::sendStatusUpdateEvent() {
+    if (!targetDataManager_ || !actuatorManager_ || events_.count() == 0) {
+        return;
+    }
+    _refreshStatusSnapshot();
+    char json[STATUS_SNAPSHOT_SIZE];
+    uint32_t version = 0;
+    if (statusSnapshot_.read(json, sizeof(json), &version) == 0 || version == lastSentStatusVersion_) {
+        return;
+    }
+    events_.send(json, "status_update", millis());
+    lastSentStatusVersion_ = version;
 }
 
-} // namespace GrowController
\ No newline at end of file
+} // namespace GrowController
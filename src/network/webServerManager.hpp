@@ -9,6 +9,15 @@
 #include "actuators/actuatorManager.hpp"
 #include "data/dataHistoryManager.hpp"
 #include "data/historicDataPoint.hpp"
+#include "data/runtimeSettings.hpp"
+#include "network/staticAssetHandler.hpp"
+#include "utils/snapshotBuffer.hpp"
+#include "utils/freeRTOSMutex.hpp"
+#include "utils/changeNotifier.hpp"
+#include "network/stateFields.hpp"
+#include "network/liveFrame.hpp"
+#include "network/requestBodyPool.hpp"
+#include "network/admissionHandler.hpp"
 
 namespace GrowController
 {
@@ -31,12 +40,16 @@ namespace GrowController
      * @param targetMgr Pointer to the TargetDataManager for accessing target data.
      * @param actuatorMgr Pointer to the ActuatorManager for accessing actuator status.
      * @param historyMgr Pointer to the DataHistoryManager for accessing historical data.
+     * @param settings Pointer to the RuntimeSettings exposed at /api/config (optional).
+     * @param notifier Change notifier the SSE task subscribes to (optional; without it SSE only sends on connect).
      */
     WebServerManager(uint16_t port,
                      SensorManager *sensorMgr,
                      TargetDataManager *targetMgr,
                      ActuatorManager *actuatorMgr,
-                     DataHistoryManager *historyMgr);
+                     DataHistoryManager *historyMgr,
+                     RuntimeSettings *settings = nullptr,
+                     ChangeNotifier *notifier = nullptr);
 
     /**
      * @brief Destroys the WebServerManager instance.
@@ -52,34 +65,142 @@ namespace GrowController
      */
     void begin();
 
+    /**
+     * @brief Starts the task that pushes SSE events when the ChangeNotifier reports a change.
+     * Bursts within SSE_COALESCE_WINDOW are merged into a single event per kind.
+     * @return true if the task is running (or no notifier was given, so there is nothing to push).
+     */
+    bool startEventTask(UBaseType_t priority = 1, uint32_t stackSize = 3072);
+
+    /**
+     * @brief Starts the task that streams binary frames (see liveFrame.hpp) to /ws clients.
+     * Each client picks its sensor frame interval by sending "rate=<ms>"; relay changes are sent as they happen.
+     * @return true if the task is running.
+     */
+    bool startLiveTask(UBaseType_t priority = 1, uint32_t stackSize = 3072);
+
     /**
      * @brief Sends an SSE event with the current sensor readings.
-     * This method is typically called periodically or when sensor data changes significantly.
-     * It respects the `eventIntervalMs_` to avoid flooding clients.
+     * Skipped when there are no clients or they already have this snapshot version.
      */
     void sendSensorUpdateEvent();
 
     /**
      * @brief Sends an SSE event with the current status of actuators and target values.
-     * This method is typically called periodically or when status/target data changes.
-     * It respects the `eventIntervalMs_` to avoid flooding clients.
+     * Skipped when there are no clients or they already have this snapshot version.
      */
     void sendStatusUpdateEvent();
 
   private:
+    static const TickType_t SSE_COALESCE_WINDOW; // Espera após a 1ª mudança para juntar rajadas
+    static const size_t STATE_HISTORY_DEFAULT = 12; // Registros de histórico em /api/state sem historyLimit
+    static const size_t STATE_HISTORY_CHUNK = 8;    // Registros lidos do LittleFS por vez
+
+    /**
+     * @brief GET /api/state: writes the selected sections straight into a response stream.
+     * Sensor/status come from the cached snapshots; history is read in small chunks.
+     */
+    void _handleState(AsyncWebServerRequest *request);
+
+    static const size_t ACTUATOR_DAYS_DEFAULT = 7; // Dias em /api/actuators sem ?days
+
+    /**
+     * @brief GET /api/actuators: live usage counters per actuator plus the last daily totals.
+     */
+    void _handleActuators(AsyncWebServerRequest *request);
+
+    /**
+     * @brief Writes the JSON array of history records newer than since (cursor), chunk by chunk.
+     * @param window Receives the window of the first read (reset flag), optional.
+     * @return Cursor of the last record written (since if none).
+     */
+    uint32_t _writeHistoryJson(Print &out, uint32_t since, HistoryWindow *window = nullptr);
+
+    /**
+     * @brief SSE task loop: waits for change bits, coalesces, pushes events.
+     */
+    void runEventTask();
+    static void eventTaskWrapper(void *pvParameters);
+
+    /**
+     * @brief Registers a GET API route that counts requests and times the handler (see /metrics).
+     */
+    void _onApiGet(const char *uri, ArRequestHandlerFunction handler);
+
+    static const size_t MAX_BODY_SIZE = 512;      // Maior corpo aceito em POST /api/targets e /api/config
+    static const size_t MAX_PENDING_BODIES = 2;   // Uploads simultâneos; o próximo recebe 503
+    typedef RequestBodyPool<MAX_PENDING_BODIES, MAX_BODY_SIZE> BodyPool;
+
+    /**
+     * @brief Handle a complete POST body (the buffer belongs to bodyPool_ until released by the caller).
+     */
+    void _handleTargetsBody(AsyncWebServerRequest *request, const uint8_t *data, size_t length);
+    void _handleConfigBody(AsyncWebServerRequest *request, const uint8_t *data, size_t length);
+
+    static const size_t MAX_LIVE_CLIENTS = 4;
+    static const TickType_t LIVE_TICK; // Resolução do agendamento por cliente (<= LIVE_RATE_MIN_MS)
+
+    /**
+     * @brief Per-client stream state. A frame is only queued when the client's TCP buffer
+     * can take it; otherwise it is dropped and the next tick sends fresher data instead.
+     */
+    struct LiveClient {
+        uint32_t id = 0; // 0 = slot livre
+        uint16_t rateMs = LIVE_RATE_DEFAULT_MS;
+        uint32_t lastSensorMs = 0;
+        uint8_t sentRelays = 0xFF; // Nenhum estado enviado ainda
+        uint32_t dropped = 0;
+    };
+
+    void _onLiveEvent(AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
+    void runLiveTask();
+    static void liveTaskWrapper(void *pvParameters);
+
+    static const size_t SENSOR_SNAPSHOT_SIZE = 128; // {"temperature":..,"airHumidity":..,"soilHumidity":..,"vpd":..}
+    static const size_t STATUS_SNAPSHOT_SIZE = 288; // {"light":{..},"humidifier":{..},"irrigation":{..}}
+
+    /**
+     * @brief Re-serializes the sensor/status JSON only if the source data changed since the last build.
+     * Safe from any task: a concurrent caller just uses the snapshot already published.
+     */
+    void _refreshSensorSnapshot();
+    void _refreshStatusSnapshot();
+
+    /**
+     * @brief Serializes the current readings/status into out.
+     * @return Bytes written (0 on failure).
+     */
+    size_t _serializeSensorJson(char *out, size_t size);
+    size_t _serializeStatusJson(char *out, size_t size);
+
     SensorManager *sensorManager_;
     TargetDataManager *targetDataManager_;
     ActuatorManager *actuatorManager_;
     DataHistoryManager *dataHistoryManager_;
+    RuntimeSettings *runtimeSettings_;
+    ChangeNotifier *changeNotifier_;
+    TaskHandle_t eventTaskHandle_ = nullptr;
+    TaskHandle_t liveTaskHandle_ = nullptr;
 
     AsyncWebServer server_;
     AsyncEventSource events_; // Para Server-Sent Events (SSE)
+    AsyncWebSocket ws_;       // Stream binário para painéis de alta taxa
+    LiveClient liveClients_[MAX_LIVE_CLIENTS];
+    BodyPool bodyPool_;       // Corpos de POST por requisição (ver requestBodyPool.hpp)
+    FreeRTOSMutex liveMutex_; // liveClients_ é alterado pelo async_tcp e lido pela LiveTask
+    AdmissionController admission_;   // Limites de requisições/streams e descarte por heap
+    AdmissionHandler admissionHandler_; // Primeiro handler: 503 antes de alocar qualquer coisa
+    StaticAssetHandler staticAssets_; // Assets gzip + ETag gerados por scripts/build_web_assets.py
     uint16_t port_;
 
-    // Controle de frequência para eventos SSE (opcional, mas bom para evitar sobrecarga)
-    unsigned long lastSensorEventTime_ = 0;
-    unsigned long lastStatusEventTime_ = 0;
-    const unsigned long eventIntervalMs_ = 2000;
+    // JSON pré-serializado, refeito só quando os dados mudam (HTTP e SSE enviam os mesmos bytes)
+    SnapshotBuffer<SENSOR_SNAPSHOT_SIZE> sensorSnapshot_;
+    SnapshotBuffer<STATUS_SNAPSHOT_SIZE> statusSnapshot_;
+    FreeRTOSMutex snapshotMutex_;        // Garante um único escritor por snapshot
+    uint32_t sensorSnapshotSource_ = 0;  // Versão dos dados usada no último snapshot
+    uint32_t statusSnapshotSource_ = 0;
+    uint32_t lastSentSensorVersion_ = 0; // Última versão enviada via SSE
+    uint32_t lastSentStatusVersion_ = 0;
   };
 
 } // namespace GrowController
@@ -3,6 +3,8 @@
 #include "ui/displayManager.hpp"
 #include "network/mqttManager.hpp"
 #include "data/dataHistoryManager.hpp"
+#include "data/runtimeSettings.hpp"
+#include "utils/psychrometrics.hpp"
 #include <Arduino.h>
 #include <math.h>
 #include <vector>
@@ -10,12 +12,12 @@
 #include <ArduinoJson.h>
 #include "config.hpp"
 #include "utils/logger.hpp"
+#include "utils/metrics.hpp"
 #include "utils/timeService.hpp"
 #include "data/historicDataPoint.hpp"
 
 namespace GrowController {
 
-const TickType_t SensorManager::SENSOR_READ_INTERVAL_MS = pdMS_TO_TICKS(10000);
 const TickType_t SensorManager::MUTEX_TIMEOUT = pdMS_TO_TICKS(500);
 
 // --- Construtor e Destrutor ---
@@ -24,12 +26,16 @@ SensorManager::SensorManager(const SensorConfig& config,
                              TimeService& timeSvc,
                              DataHistoryManager* historyMgr,
                              DisplayManager* displayMgr,
-                             MqttManager* mqttMgr) :
+                             MqttManager* mqttMgr,
+                             RuntimeSettings* settings,
+                             ChangeNotifier* notifier) :
     sensorConfig(config),
     timeServiceRef(timeSvc),                  
     dataHistoryManagerPtr(historyMgr),        
     displayManager(displayMgr),
     mqttManager(mqttMgr),
+    runtimeSettings(settings),
+    changeNotifier(notifier),
     dhtSensor(nullptr),
     cachedTemperature(NAN),
     cachedHumidity(NAN),
@@ -103,8 +109,13 @@ bool SensorManager::initialize() {
 
 // Modificar runSensorTask
 void SensorManager::runSensorTask() {
+    RuntimeRates rates = runtimeSettings ? runtimeSettings->getRates() : RuntimeRates();
     Logger::info("SensorManager: runSensorTask loop entered. Read interval: %lu ms, Save interval: %lu ms.",
-                 (unsigned long)SENSOR_READ_INTERVAL_MS / portTICK_PERIOD_MS, SAVE_INTERVAL_MILLIS);
+                 (unsigned long)rates.sensorReadIntervalMs, (unsigned long)rates.historySaveIntervalMs);
+    if (runtimeSettings) {
+        runtimeSettings->addListener(xTaskGetCurrentTaskHandle());
+        runtimeSettings->setPersistTask(xTaskGetCurrentTaskHandle()); // Grava os intervalos na NVS (fora do timer)
+    }
 
     // Inicializa lastSaveToFlashMillis para que o primeiro salvamento ocorra após o primeiro intervalo
     lastSaveToFlashMillis = millis();
@@ -116,12 +127,21 @@ void SensorManager::runSensorTask() {
         }
 
         unsigned long currentMillisCycle = millis(); // Obter millis uma vez por ciclo
+        TickType_t cycleStartTick = xTaskGetTickCount();
+        rates = runtimeSettings ? runtimeSettings->getRates() : RuntimeRates();
 
         // --- 1. Ler Sensores ---
+        uint32_t readStartUs = micros();
         float currentTemperature = _readTemperatureFromSensor();
         float currentAirHumidity = _readHumidityFromSensor();
         float currentSoilHumidity = _readSoilHumidityFromSensor();
         float currentVpd = _calculateVpd(currentTemperature, currentAirHumidity);
+        Metrics::sensorReadDuration.observe(micros() - readStartUs);
+        if (isnan(currentTemperature) || isnan(currentAirHumidity)) {
+            Metrics::sensorReadsFailed.inc();
+        } else {
+            Metrics::sensorReadsOk.inc();
+        }
 
         // Logger::debug("[SensorTask] Raw - T:%.1f, AH:%.1f, SH:%.1f, VPD:%.2f",
         //             currentTemperature, currentAirHumidity, currentSoilHumidity, currentVpd);
@@ -148,8 +168,13 @@ void SensorManager::runSensorTask() {
             if (!isnan(currentSoilHumidity)) { this->cachedSoilHumidity = currentSoilHumidity; }
             if (!isnan(currentVpd)) { this->cachedVpd = currentVpd; }
             xSemaphoreGive(sensorDataMutex.get());
+            dataVersion.fetch_add(1, std::memory_order_release);
+            if (changeNotifier) {
+                changeNotifier->notify(CHANGE_SENSORS);
+            }
         } else {
              // Logger::warn("SensorTask WARN: Failed acquire mutex to update cache.");
+             Metrics::mutexTimeoutsSensor.inc();
         }
 
         // --- 4. Processar/Publicar leituras instantâneas (MQTT, Display) ---
@@ -157,10 +182,10 @@ void SensorManager::runSensorTask() {
                                   // SoilHumidity e VPD podem ser NAN e ainda assim T/AH serem válidos.
 
         if (this->mqttManager != nullptr ) { // Publicar mesmo se alguns forem NAN, o broker/cliente trata
-            if(!isnan(currentTemperature)) this->mqttManager->publish("sensors/temperature", currentTemperature);
-            if(!isnan(currentAirHumidity)) this->mqttManager->publish("sensors/air_humidity", currentAirHumidity);
-            if(!isnan(currentSoilHumidity)) this->mqttManager->publish("sensors/soil_humidity", currentSoilHumidity);
-            if(!isnan(currentVpd)) this->mqttManager->publish("sensors/vpd", currentVpd);
+            if(!isnan(currentTemperature)) this->mqttManager->publish(MqttTopic::SensorTemperature, currentTemperature);
+            if(!isnan(currentAirHumidity)) this->mqttManager->publish(MqttTopic::SensorAirHumidity, currentAirHumidity);
+            if(!isnan(currentSoilHumidity)) this->mqttManager->publish(MqttTopic::SensorSoilHumidity, currentSoilHumidity);
+            if(!isnan(currentVpd)) this->mqttManager->publish(MqttTopic::SensorVpd, currentVpd);
         }
 
         if (this->displayManager != nullptr && this->displayManager->isInitialized()) {
@@ -168,7 +193,7 @@ void SensorManager::runSensorTask() {
         }
 
         // --- 5. Verificar se é hora de salvar a média na Flash ---
-        if (currentMillisCycle - lastSaveToFlashMillis >= SAVE_INTERVAL_MILLIS) {
+        if (currentMillisCycle - lastSaveToFlashMillis >= rates.historySaveIntervalMs) {
             Logger::info("SensorTask: Save interval reached. Calculating and saving averages.");
             HistoricDataPoint dp;
             struct tm timeinfo; // struct tm para mktime
@@ -199,9 +224,14 @@ void SensorManager::runSensorTask() {
 
             // Salvar ponto de dado histórico
             if (dataHistoryManagerPtr) {
-                if (dataHistoryManagerPtr->addDataPoint(dp)) {
+                uint32_t writeStartUs = micros();
+                bool saved = dataHistoryManagerPtr->addDataPoint(dp);
+                Metrics::historyWriteDuration.observe(micros() - writeStartUs);
+                if (saved) {
+                    Metrics::historyWritesOk.inc();
                     Logger::info("SensorTask: Historic data point saved successfully.");
                 } else {
+                    Metrics::historyWritesFailed.inc();
                     Logger::error("SensorTask: Failed to save historic data point.");
                 }
             } else {
@@ -220,8 +250,8 @@ void SensorManager::runSensorTask() {
             lastSaveToFlashMillis = currentMillisCycle; // Atualiza o tempo do último salvamento
         }
 
-        // --- 6. Aguardar próximo ciclo de leitura ---
-        vTaskDelay(SENSOR_READ_INTERVAL_MS);
+        // --- 6. Aguardar próximo ciclo de leitura (intervalo pode mudar durante a espera) ---
+        RuntimeSettings::waitForNextCycle(runtimeSettings, &RuntimeRates::sensorReadIntervalMs, cycleStartTick);
     }
 }
 
@@ -275,21 +305,16 @@ float SensorManager::_readSoilHumidityFromSensor() const {
     return percentage;
 }
 
-float SensorManager::_calculateVpd(float temp, float hum) {
-    if (isnan(temp) || isnan(hum) || hum < 0.0f || hum > 100.0f || temp < -20.0f || temp > 70.0f ) {
-        return NAN;
+uint16_t SensorManager::readSoilAdcNow() const {
+    if (!initialized) {
+        return 0xFFFF;
     }
-    // Pressão de vapor de saturação (SVP) em kPa usando a fórmula de Tetens ou similar.
-    // SVP(Pa) = 610.78 * exp((17.27 * T_celsius) / (T_celsius + 237.3))
-    // Para kPa, dividir por 1000
-    float svp_kpa = 0.61078f * expf((17.27f * temp) / (temp + 237.3f));
-
-    // Pressão de vapor atual (AVP) em kPa
-    float avp_kpa = svp_kpa * (hum / 100.0f);
+    return (uint16_t)analogRead(this->sensorConfig.soilHumiditySensorPin);
+}
 
-    // Déficit de Pressão de Vapor (VPD)
-    float vpd = svp_kpa - avp_kpa;
-    return (vpd >= 0.0f ? vpd : 0.0f); // VPD não deve ser negativo
+float SensorManager::_calculateVpd(float temp, float hum) {
+    // Tetens + UR (ver utils/psychrometrics.hpp; o controle por VPD usa o inverso da mesma fórmula)
+    return vpdKpa(temp, hum);
 }
 
 float SensorManager::getTemperature() const {
@@ -298,6 +323,8 @@ float SensorManager::getTemperature() const {
     if (sensorDataMutex && xSemaphoreTake(sensorDataMutex.get(), MUTEX_TIMEOUT) == pdTRUE) {
         temp = this->cachedTemperature;
         xSemaphoreGive(sensorDataMutex.get());
+    } else if (sensorDataMutex) {
+        Metrics::mutexTimeoutsSensor.inc();
     }
     return temp;
 }
@@ -308,6 +335,8 @@ float SensorManager::getHumidity() const {
     if (sensorDataMutex && xSemaphoreTake(sensorDataMutex.get(), MUTEX_TIMEOUT) == pdTRUE) {
         hum = this->cachedHumidity;
         xSemaphoreGive(sensorDataMutex.get());
+    } else if (sensorDataMutex) {
+        Metrics::mutexTimeoutsSensor.inc();
     }
     return hum;
 }
@@ -318,6 +347,8 @@ float SensorManager::getSoilHumidity() const {
     if (sensorDataMutex && xSemaphoreTake(sensorDataMutex.get(), MUTEX_TIMEOUT) == pdTRUE) {
         soilHum = this->cachedSoilHumidity;
         xSemaphoreGive(sensorDataMutex.get());
+    } else if (sensorDataMutex) {
+        Metrics::mutexTimeoutsSensor.inc();
     }
     return soilHum;
 }
@@ -328,6 +359,8 @@ float SensorManager::getVpd() const {
     if (sensorDataMutex && xSemaphoreTake(sensorDataMutex.get(), MUTEX_TIMEOUT) == pdTRUE) {
         vpd_val = this->cachedVpd;
         xSemaphoreGive(sensorDataMutex.get());
+    } else if (sensorDataMutex) {
+        Metrics::mutexTimeoutsSensor.inc();
     }
     return vpd_val;
 }
@@ -7,16 +7,19 @@
 #include <DHT.h>                 // Biblioteca DHT
 #include <vector>                // Para leitura do sensor de solo
 #include <numeric>               // Para std::accumulate
+#include <atomic>
 #include "utils/freeRTOSMutex.hpp" // Wrapper RAII do Mutex
 #include "freertos/FreeRTOS.h"   // Para tipos FreeRTOS
 #include "freertos/task.h"       // Para TaskHandle_t
 #include "utils/timeService.hpp"
+#include "utils/changeNotifier.hpp"
 
 // Forward declaration para dependências
 namespace GrowController {
     class DisplayManager;
     class MqttManager;
     class DataHistoryManager;
+    class RuntimeSettings;
 }
 
 namespace GrowController {
@@ -36,12 +39,16 @@ public:
      * @param historyMgr Ponteiro para o DataHistoryManager (opcional, para armazenamento em cache).
      * @param displayMgr Ponteiro para o DisplayManager (opcional, para atualização direta).
      * @param mqttMgr Ponteiro para o MqttManager (opcional, para publicação direta).
+     * @param settings Intervalos ajustáveis em tempo de execução (opcional, usa os padrões se nulo).
+     * @param notifier Avisado (CHANGE_SENSORS) a cada atualização do cache (opcional).
      */
     SensorManager(const SensorConfig& config,
                   TimeService& timeSvc,
                   DataHistoryManager* historyMgr,
                   DisplayManager* displayMgr = nullptr,
-                  MqttManager* mqttMgr = nullptr);
+                  MqttManager* mqttMgr = nullptr,
+                  RuntimeSettings* settings = nullptr,
+                  ChangeNotifier* notifier = nullptr);
 
     /**
      * @brief Destrutor. Para a tarefa e libera recursos (automático via RAII).
@@ -92,12 +99,24 @@ public:
      */
     float getVpd() const; // NOVO GETTER
 
+    /**
+     * @brief Lê o ADC do sensor de solo na hora (uma amostra, sem média nem cache).
+     * Usado pelo stream /ws para traços sub-segundo; não substitui getSoilHumidity().
+     * @return uint16_t Valor cru 0-4095, ou 0xFFFF se não inicializado.
+     */
+    uint16_t readSoilAdcNow() const;
+
     /**
      * @brief Verifica se o manager foi inicializado.
      * @return true se inicializado, false caso contrário.
      */
     bool isInitialized() const;
 
+    /**
+     * @brief Contador incrementado a cada ciclo que atualiza o cache de leituras.
+     */
+    uint32_t getDataVersion() const { return dataVersion.load(std::memory_order_acquire); }
+
 
 private:
     /**
@@ -145,12 +164,15 @@ private:
     DataHistoryManager* dataHistoryManagerPtr;
     DisplayManager* displayManager = nullptr;
     MqttManager* mqttManager = nullptr;
+    RuntimeSettings* runtimeSettings = nullptr;
+    ChangeNotifier* changeNotifier = nullptr;
     std::unique_ptr<DHT> dhtSensor = nullptr;
     FreeRTOSMutex sensorDataMutex;
     float cachedTemperature = NAN;
     float cachedHumidity = NAN;
     float cachedSoilHumidity = NAN;
     float cachedVpd = NAN;
+    std::atomic<uint32_t> dataVersion{0}; // Ver getDataVersion()
     TaskHandle_t readTaskHandle = nullptr;
     bool initialized = false;
 
@@ -163,10 +185,8 @@ private:
     int validSoilHumReadings = 0;
 
     unsigned long lastSaveToFlashMillis = 0;
-    static const unsigned long SAVE_INTERVAL_MILLIS = 30UL * 60UL * 1000UL;
 
-    // Constantes internas
-    static const TickType_t SENSOR_READ_INTERVAL_MS;
+    // Constantes internas (intervalos de leitura/gravação vêm de RuntimeSettings)
     static const TickType_t MUTEX_TIMEOUT;
 };
 
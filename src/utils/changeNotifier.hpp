@@ -0,0 +1,91 @@
+// src/utils/changeNotifier.hpp
+#ifndef CHANGE_NOTIFIER_HPP
+#define CHANGE_NOTIFIER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace GrowController {
+
+/**
+ * @brief Bits de mudança entregues às tarefas assinantes (xTaskNotify com eSetBits).
+ */
+enum ChangeEvent : uint32_t {
+    CHANGE_SENSORS = 1u << 0, ///< Cache de leituras do SensorManager atualizado (amostra nova)
+    CHANGE_STATUS  = 1u << 1, ///< Relé mudou de estado ou alvos foram atualizados
+    CHANGE_TARGETS = 1u << 2, ///< Alvos foram atualizados (sempre junto com CHANGE_STATUS)
+    CHANGE_TIME    = 1u << 3, ///< Relógio ajustado pelo SNTP
+    CHANGE_ALL     = 0xFFFFFFFFu,
+};
+
+/**
+ * @brief Avisa as tarefas assinantes de que dados mudaram.
+ * Cada assinante tem uma máscara e só é acordado pelos bits que pediu.
+ * Notificações repetidas antes da tarefa acordar se juntam nos mesmos bits,
+ * então produtores podem chamar notify() livremente: custo O(MAX_SUBSCRIBERS), sem bloquear.
+ * Sem assinantes, notify() não faz nada.
+ */
+class ChangeNotifier {
+public:
+    static constexpr size_t MAX_SUBSCRIBERS = 4;
+
+    /**
+     * @brief Registra a tarefa para receber os bits de mask (repetir só atualiza a máscara).
+     * @return false se a tabela estiver cheia.
+     */
+    bool subscribe(TaskHandle_t task, uint32_t mask = CHANGE_ALL) {
+        if (task == nullptr) {
+            return false;
+        }
+        for (auto& slot : slots) {
+            if (slot.task.load(std::memory_order_acquire) == task) {
+                slot.mask.store(mask, std::memory_order_release);
+                return true;
+            }
+        }
+        for (auto& slot : slots) {
+            TaskHandle_t expected = nullptr;
+            if (slot.task.compare_exchange_strong(expected, task, std::memory_order_acq_rel)) {
+                slot.mask.store(mask, std::memory_order_release);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void unsubscribe(TaskHandle_t task) {
+        if (task == nullptr) {
+            return;
+        }
+        for (auto& slot : slots) {
+            if (slot.task.load(std::memory_order_acquire) == task) {
+                slot.mask.store(0, std::memory_order_release);
+                slot.task.store(nullptr, std::memory_order_release);
+            }
+        }
+    }
+
+    void notify(uint32_t events) {
+        for (auto& slot : slots) {
+            TaskHandle_t task = slot.task.load(std::memory_order_acquire);
+            uint32_t wanted = events & slot.mask.load(std::memory_order_acquire);
+            if (task != nullptr && wanted != 0) {
+                xTaskNotify(task, wanted, eSetBits);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        std::atomic<TaskHandle_t> task{nullptr};
+        std::atomic<uint32_t> mask{0};
+    };
+    Slot slots[MAX_SUBSCRIBERS];
+};
+
+} // namespace GrowController
+
+#endif // CHANGE_NOTIFIER_HPP
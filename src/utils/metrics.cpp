@@ -0,0 +1,65 @@
+#include "metrics.hpp"
+
+namespace GrowController {
+
+MetricRegistry& MetricRegistry::global() {
+    static MetricRegistry registry; // Construído no primeiro uso: independe da ordem de inicialização estática
+    return registry;
+}
+
+namespace Metrics {
+
+// Limites em microssegundos
+static const uint32_t SENSOR_READ_BOUNDS[6] = {10000, 50000, 100000, 250000, 500000, 1000000};
+static const uint32_t HISTORY_WRITE_BOUNDS[6] = {1000, 5000, 10000, 50000, 100000, 500000};
+static const uint32_t HTTP_HANDLER_BOUNDS[6] = {250, 1000, 5000, 10000, 50000, 250000};
+
+// Mesmo nome com labels diferentes: manter em sequência (HELP/TYPE uma vez)
+Counter sensorReadsOk(MetricRegistry::global(), "growctl_sensor_reads_total",
+                      "Sensor read cycles by result.", "result=\"ok\"");
+Counter sensorReadsFailed(MetricRegistry::global(), "growctl_sensor_reads_total", nullptr, "result=\"error\"");
+Histogram<6> sensorReadDuration(MetricRegistry::global(), "growctl_sensor_read_duration_seconds",
+                                "Time to read DHT and soil sensors in one cycle.", SENSOR_READ_BOUNDS);
+
+Counter mqttPublishOk(MetricRegistry::global(), "growctl_mqtt_publishes_total",
+                      "Outbox messages written to the broker socket by result.", "result=\"ok\"");
+Counter mqttPublishFailed(MetricRegistry::global(), "growctl_mqtt_publishes_total", nullptr, "result=\"error\"");
+Counter mqttOutboxDropped(MetricRegistry::global(), "growctl_mqtt_outbox_dropped_total",
+                          "Messages dropped because the outbox was full or the payload too large.");
+Gauge mqttOutboxDepth(MetricRegistry::global(), "growctl_mqtt_outbox_depth", "Messages waiting in the MQTT outbox.");
+Gauge mqttConnected(MetricRegistry::global(), "growctl_mqtt_connected", "1 if connected to the MQTT broker.");
+
+Counter historyWritesOk(MetricRegistry::global(), "growctl_history_writes_total",
+                        "History records written to LittleFS by result.", "result=\"ok\"");
+Counter historyWritesFailed(MetricRegistry::global(), "growctl_history_writes_total", nullptr, "result=\"error\"");
+Histogram<6> historyWriteDuration(MetricRegistry::global(), "growctl_history_write_duration_seconds",
+                                  "Time to write one history record (file + NVS index).", HISTORY_WRITE_BOUNDS);
+
+Counter httpRequests(MetricRegistry::global(), "growctl_http_requests_total", "API requests handled.");
+Counter httpRejectedTooLarge(MetricRegistry::global(), "growctl_http_rejected_total",
+                             "Request bodies rejected before parsing.", "reason=\"too_large\"");
+Counter httpRejectedBusy(MetricRegistry::global(), "growctl_http_rejected_total", nullptr, "reason=\"busy\"");
+Histogram<6> httpHandlerDuration(MetricRegistry::global(), "growctl_http_handler_duration_seconds",
+                                 "Time spent in API GET handlers.", HTTP_HANDLER_BOUNDS);
+Counter httpShedBusy(MetricRegistry::global(), "growctl_http_shed_total",
+                     "Requests answered 503 by admission control.", "reason=\"busy\"");
+Counter httpShedLowMemory(MetricRegistry::global(), "growctl_http_shed_total", nullptr, "reason=\"low_memory\"");
+Gauge httpActiveRequests(MetricRegistry::global(), "growctl_http_active_requests", "Admitted requests in progress.");
+
+Counter mutexTimeoutsSensor(MetricRegistry::global(), "growctl_mutex_timeouts_total",
+                            "Mutex acquisitions that timed out, by owner.", "owner=\"sensor\"");
+Counter mutexTimeoutsHistory(MetricRegistry::global(), "growctl_mutex_timeouts_total", nullptr, "owner=\"history\"");
+Counter mutexTimeoutsSettings(MetricRegistry::global(), "growctl_mutex_timeouts_total", nullptr, "owner=\"settings\"");
+Counter mutexTimeoutsMqttStore(MetricRegistry::global(), "growctl_mutex_timeouts_total", nullptr, "owner=\"mqtt_store\"");
+
+// Atualizados no momento da coleta (GET /metrics)
+Gauge heapFreeBytes(MetricRegistry::global(), "growctl_heap_free_bytes", "Free heap.");
+Gauge heapMinFreeBytes(MetricRegistry::global(), "growctl_heap_min_free_bytes", "Lowest free heap since boot.");
+Gauge uptimeSeconds(MetricRegistry::global(), "growctl_uptime_seconds", "Seconds since boot.");
+Gauge wifiRssi(MetricRegistry::global(), "growctl_wifi_rssi_dbm", "WiFi signal strength.");
+Gauge sseClients(MetricRegistry::global(), "growctl_sse_clients", "Connected /events clients.");
+Gauge wsClients(MetricRegistry::global(), "growctl_ws_clients", "Connected /ws clients.");
+
+} // namespace Metrics
+
+} // namespace GrowController
@@ -0,0 +1,257 @@
+// src/utils/metrics.hpp
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+
+namespace GrowController {
+
+/**
+ * @brief Contadores, gauges e histogramas de buckets fixos, expostos em /metrics (texto Prometheus).
+ *
+ * As métricas são objetos estáticos que se registram no MetricRegistry no construtor
+ * (inicialização estática, antes de qualquer tarefa); depois disso a lista não muda.
+ * Atualizar é um fetch_add/store relaxed: seguro em qualquer tarefa, sem lock.
+ * Métricas com o mesmo nome e labels diferentes devem ser declaradas em sequência
+ * para que HELP/TYPE saiam uma única vez.
+ */
+enum class MetricType : uint8_t { Counter, Gauge, Histogram };
+
+class MetricRegistry;
+
+class Metric {
+public:
+    Metric(const Metric&) = delete;
+    Metric& operator=(const Metric&) = delete;
+
+    const char* name() const { return name_; }
+    const char* help() const { return help_; }
+    const char* labels() const { return labels_; } ///< Ex: "result=\"ok\"" ou nullptr
+    MetricType type() const { return type_; }
+
+protected:
+    Metric(MetricRegistry& registry, MetricType type, const char* name, const char* help, const char* labels);
+
+private:
+    friend class MetricRegistry;
+    const char* name_;
+    const char* help_;
+    const char* labels_;
+    MetricType type_;
+    Metric* next_ = nullptr;
+};
+
+class Counter : public Metric {
+public:
+    Counter(MetricRegistry& registry, const char* name, const char* help, const char* labels = nullptr)
+        : Metric(registry, MetricType::Counter, name, help, labels) {}
+
+    void inc(uint32_t amount = 1) { value_.fetch_add(amount, std::memory_order_relaxed); }
+    uint32_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> value_{0};
+};
+
+class Gauge : public Metric {
+public:
+    Gauge(MetricRegistry& registry, const char* name, const char* help, const char* labels = nullptr)
+        : Metric(registry, MetricType::Gauge, name, help, labels) {}
+
+    void set(int32_t value) { value_.store(value, std::memory_order_relaxed); }
+    void add(int32_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+    int32_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int32_t> value_{0};
+};
+
+/**
+ * @brief Histograma de durações em microssegundos, exposto em segundos (convenção Prometheus).
+ * Os limites (bounds, em us, crescentes) definem os buckets; o +Inf é implícito.
+ */
+class HistogramBase : public Metric {
+public:
+    void observe(uint32_t micros) {
+        size_t bucket = 0;
+        while (bucket < boundCount_ && micros > bounds_[bucket]) ++bucket;
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+        // Soma em 64 bits com dois atômicos de 32 (o Xtensa não tem atômico de 64 sem lock)
+        uint32_t previous = sumLow_.fetch_add(micros, std::memory_order_relaxed);
+        if ((uint32_t)(previous + micros) < previous) {
+            sumHigh_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    size_t boundCount() const { return boundCount_; }
+    uint32_t bound(size_t index) const { return bounds_[index]; }
+    /// Contagem do bucket (não cumulativa); index == boundCount() é o +Inf.
+    uint32_t bucket(size_t index) const { return buckets_[index].load(std::memory_order_relaxed); }
+    uint64_t sumMicros() const {
+        uint32_t high = sumHigh_.load(std::memory_order_relaxed);
+        uint32_t low = sumLow_.load(std::memory_order_relaxed);
+        return ((uint64_t)high << 32) | low;
+    }
+
+protected:
+    HistogramBase(MetricRegistry& registry, const char* name, const char* help, const char* labels,
+                  const uint32_t* bounds, size_t boundCount, std::atomic<uint32_t>* buckets)
+        : Metric(registry, MetricType::Histogram, name, help, labels),
+          bounds_(bounds), boundCount_(boundCount), buckets_(buckets) {}
+
+private:
+    const uint32_t* bounds_;
+    size_t boundCount_;
+    std::atomic<uint32_t>* buckets_;
+    std::atomic<uint32_t> sumLow_{0};
+    std::atomic<uint32_t> sumHigh_{0};
+};
+
+template <size_t BoundCount>
+class Histogram : public HistogramBase {
+public:
+    Histogram(MetricRegistry& registry, const char* name, const char* help, const uint32_t (&bounds)[BoundCount],
+              const char* labels = nullptr)
+        : HistogramBase(registry, name, help, labels, bounds, BoundCount, storage_) {}
+
+private:
+    std::atomic<uint32_t> storage_[BoundCount + 1] = {};
+};
+
+class MetricRegistry {
+public:
+    /**
+     * @brief Escreve todas as métricas no formato texto do Prometheus (0.0.4), linha a linha.
+     * @tparam Out Qualquer coisa com print(const char*) (Print do Arduino, AsyncResponseStream...).
+     */
+    template <typename Out>
+    void writePrometheus(Out& out) const {
+        char line[192];
+        const char* previousName = nullptr;
+        for (const Metric* metric = head_; metric != nullptr; metric = metric->next_) {
+            if (previousName == nullptr || strcmp(previousName, metric->name()) != 0) {
+                snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n", metric->name(),
+                         metric->help() ? metric->help() : "", metric->name(), _typeName(metric->type()));
+                out.print(line);
+                previousName = metric->name();
+            }
+            const char* labels = metric->labels() ? metric->labels() : "";
+            const char* open = labels[0] ? "{" : "";
+            const char* close = labels[0] ? "}" : "";
+
+            switch (metric->type()) {
+                case MetricType::Counter:
+                    snprintf(line, sizeof(line), "%s%s%s%s %lu\n", metric->name(), open, labels, close,
+                             (unsigned long)static_cast<const Counter*>(metric)->value());
+                    out.print(line);
+                    break;
+                case MetricType::Gauge:
+                    snprintf(line, sizeof(line), "%s%s%s%s %ld\n", metric->name(), open, labels, close,
+                             (long)static_cast<const Gauge*>(metric)->value());
+                    out.print(line);
+                    break;
+                case MetricType::Histogram: {
+                    const HistogramBase* histogram = static_cast<const HistogramBase*>(metric);
+                    const char* separator = labels[0] ? "," : "";
+                    uint32_t cumulative = 0;
+                    for (size_t i = 0; i <= histogram->boundCount(); ++i) {
+                        cumulative += histogram->bucket(i);
+                        char le[16];
+                        if (i < histogram->boundCount()) {
+                            uint32_t bound = histogram->bound(i);
+                            snprintf(le, sizeof(le), "%lu.%06lu", (unsigned long)(bound / 1000000),
+                                     (unsigned long)(bound % 1000000));
+                        } else {
+                            snprintf(le, sizeof(le), "+Inf");
+                        }
+                        snprintf(line, sizeof(line), "%s_bucket{%s%sle=\"%s\"} %lu\n", metric->name(), labels,
+                                 separator, le, (unsigned long)cumulative);
+                        out.print(line);
+                    }
+                    uint64_t sum = histogram->sumMicros();
+                    snprintf(line, sizeof(line), "%s_sum%s%s%s %lu.%06lu\n%s_count%s%s%s %lu\n", metric->name(),
+                             open, labels, close, (unsigned long)(sum / 1000000), (unsigned long)(sum % 1000000),
+                             metric->name(), open, labels, close, (unsigned long)cumulative);
+                    out.print(line);
+                    break;
+                }
+            }
+        }
+    }
+
+    /// Registro global usado pelas métricas em Metrics:: (metrics.cpp).
+    static MetricRegistry& global();
+
+private:
+    friend class Metric;
+
+    void _add(Metric* metric) {
+        // Mantém a ordem de declaração (cauda), para HELP/TYPE agrupados
+        metric->next_ = nullptr;
+        if (tail_ == nullptr) {
+            head_ = metric;
+        } else {
+            tail_->next_ = metric;
+        }
+        tail_ = metric;
+    }
+
+    static const char* _typeName(MetricType type) {
+        switch (type) {
+            case MetricType::Counter:   return "counter";
+            case MetricType::Gauge:     return "gauge";
+            case MetricType::Histogram: return "histogram";
+        }
+        return "untyped";
+    }
+
+    Metric* head_ = nullptr;
+    Metric* tail_ = nullptr;
+};
+
+inline Metric::Metric(MetricRegistry& registry, MetricType type, const char* name, const char* help, const char* labels)
+    : name_(name), help_(help), labels_(labels), type_(type) {
+    registry._add(this);
+}
+
+/**
+ * @brief Métricas do firmware (definidas em metrics.cpp, registradas em MetricRegistry::global()).
+ */
+namespace Metrics {
+    extern Counter sensorReadsOk;
+    extern Counter sensorReadsFailed;
+    extern Histogram<6> sensorReadDuration;
+    extern Counter mqttPublishOk;
+    extern Counter mqttPublishFailed;
+    extern Counter mqttOutboxDropped;
+    extern Gauge mqttOutboxDepth;
+    extern Gauge mqttConnected;
+    extern Counter historyWritesOk;
+    extern Counter historyWritesFailed;
+    extern Histogram<6> historyWriteDuration;
+    extern Counter httpRequests;
+    extern Counter httpRejectedTooLarge;
+    extern Counter httpRejectedBusy;
+    extern Histogram<6> httpHandlerDuration;
+    extern Counter httpShedBusy;
+    extern Counter httpShedLowMemory;
+    extern Gauge httpActiveRequests;
+    extern Counter mutexTimeoutsSensor;
+    extern Counter mutexTimeoutsHistory;
+    extern Counter mutexTimeoutsSettings;
+    extern Counter mutexTimeoutsMqttStore;
+    extern Gauge heapFreeBytes;
+    extern Gauge heapMinFreeBytes;
+    extern Gauge uptimeSeconds;
+    extern Gauge wifiRssi;
+    extern Gauge sseClients;
+    extern Gauge wsClients;
+} // namespace Metrics
+
+} // namespace GrowController
+
+#endif // METRICS_HPP
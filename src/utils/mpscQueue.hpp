@@ -0,0 +1,106 @@
+// src/utils/mpscQueue.hpp
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+namespace GrowController {
+
+/**
+ * @brief Fila limitada lock-free com múltiplos produtores e um único consumidor.
+ *
+ * Cada célula carrega um número de sequência (algoritmo de Vyukov): produtores
+ * reservam uma posição com um CAS e publicam o dado com um store-release; o
+ * consumidor só lê células já publicadas. tryPush() e tryPop() são O(1) e
+ * nunca bloqueiam, então podem ser chamados de qualquer tarefa.
+ *
+ * @tparam T Tipo do elemento (copiável, idealmente POD).
+ * @tparam N Capacidade; deve ser potência de 2.
+ */
+template <typename T, size_t N>
+class MpscQueue {
+public:
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscQueue capacity must be a power of two");
+
+    MpscQueue() {
+        for (size_t i = 0; i < N; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Enfileira uma cópia do item. Seguro para vários produtores.
+     * @return false Se a fila está cheia.
+     */
+    bool tryPush(const T& item) {
+        Cell* cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & (N - 1)];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Cheia
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = item;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove o item mais antigo. Apenas o consumidor pode chamar.
+     * @return false Se a fila está vazia (ou o próximo item ainda está sendo escrito).
+     */
+    bool tryPop(T& out) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = cells[pos & (N - 1)];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(pos + 1) < 0) {
+            return false;
+        }
+        out = cell.data;
+        cell.sequence.store(pos + N, std::memory_order_release);
+        dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Número aproximado de itens (exato apenas sem produtores concorrentes).
+     */
+    size_t sizeApprox() const {
+        size_t enq = enqueuePos.load(std::memory_order_relaxed);
+        size_t deq = dequeuePos.load(std::memory_order_relaxed);
+        return enq >= deq ? enq - deq : 0;
+    }
+
+    bool emptyApprox() const { return sizeApprox() == 0; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    Cell cells[N];
+    std::atomic<size_t> enqueuePos;
+    std::atomic<size_t> dequeuePos;
+};
+
+} // namespace GrowController
+
+#endif // MPSC_QUEUE_HPP
@@ -0,0 +1,53 @@
+// src/utils/psychrometrics.hpp
+#ifndef PSYCHROMETRICS_HPP
+#define PSYCHROMETRICS_HPP
+
+#include <math.h>
+
+namespace GrowController {
+
+/**
+ * @brief Pressão de vapor de saturação (kPa), fórmula de Tetens.
+ * SVP = 0.61078 · e^(17.27·T / (T + 237.3)); erro < 0.1% entre 0 e 50 °C.
+ */
+inline float saturationVaporPressureKpa(float tempC) {
+    return 0.61078f * expf((17.27f * tempC) / (tempC + 237.3f));
+}
+
+/**
+ * @brief Faixa de temperatura aceita nos cálculos (fora dela o sensor provavelmente falhou).
+ */
+inline bool psychrometricTempValid(float tempC) {
+    return !isnan(tempC) && tempC >= -20.0f && tempC <= 70.0f;
+}
+
+/**
+ * @brief Déficit de pressão de vapor (kPa) a partir da temperatura e da umidade relativa.
+ * @return NAN se alguma entrada for inválida; nunca negativo.
+ */
+inline float vpdKpa(float tempC, float relativeHumidity) {
+    if (!psychrometricTempValid(tempC) || isnan(relativeHumidity) || relativeHumidity < 0.0f ||
+        relativeHumidity > 100.0f) {
+        return NAN;
+    }
+    float svp = saturationVaporPressureKpa(tempC);
+    float vpd = svp * (1.0f - relativeHumidity / 100.0f);
+    return vpd >= 0.0f ? vpd : 0.0f;
+}
+
+/**
+ * @brief Umidade relativa (%) que dá o VPD alvo na temperatura atual: UR = 100 · (1 - VPD / SVP(T)).
+ * Inverso de vpdKpa() sem log: uma exponencial e uma divisão por amostra.
+ * @return NAN se a temperatura ou o alvo forem inválidos; limitado a [0, 100].
+ */
+inline float humidityForVpd(float tempC, float targetVpdKpa) {
+    if (!psychrometricTempValid(tempC) || isnan(targetVpdKpa) || targetVpdKpa < 0.0f) {
+        return NAN;
+    }
+    float relativeHumidity = 100.0f * (1.0f - targetVpdKpa / saturationVaporPressureKpa(tempC));
+    return relativeHumidity < 0.0f ? 0.0f : (relativeHumidity > 100.0f ? 100.0f : relativeHumidity);
+}
+
+} // namespace GrowController
+
+#endif // PSYCHROMETRICS_HPP
@@ -0,0 +1,86 @@
+// src/utils/ringBuffer.hpp
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <stddef.h>
+
+namespace GrowController {
+
+/**
+ * @brief Buffer circular de capacidade fixa, sem alocação dinâmica.
+ * Não é thread-safe; o chamador deve proteger o acesso (ex: FreeRTOSMutex).
+ * @tparam T Tipo do elemento (copiável).
+ * @tparam N Capacidade máxima.
+ */
+template <typename T, size_t N>
+class RingBuffer {
+public:
+    static_assert(N > 0, "RingBuffer capacity must be greater than zero");
+
+    /**
+     * @brief Insere um elemento no final.
+     * @return false Se o buffer está cheio (o elemento não é inserido).
+     */
+    bool push(const T& item) {
+        if (count == N) {
+            return false;
+        }
+        items[(head + count) % N] = item;
+        count++;
+        return true;
+    }
+
+    /**
+     * @brief Lê o elemento mais antigo sem removê-lo.
+     * @return false Se o buffer está vazio.
+     */
+    bool peek(T& out) const {
+        if (count == 0) {
+            return false;
+        }
+        out = items[head];
+        return true;
+    }
+
+    /**
+     * @brief Remove e retorna o elemento mais antigo.
+     * @return false Se o buffer está vazio.
+     */
+    bool pop(T& out) {
+        if (!peek(out)) {
+            return false;
+        }
+        head = (head + 1) % N;
+        count--;
+        return true;
+    }
+
+    /**
+     * @brief Descarta o elemento mais antigo, se houver.
+     */
+    void dropOldest() {
+        if (count > 0) {
+            head = (head + 1) % N;
+            count--;
+        }
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    T items[N] = {};
+    size_t head = 0;
+    size_t count = 0;
+};
+
+} // namespace GrowController
+
+#endif // RING_BUFFER_HPP
@@ -0,0 +1,105 @@
+// src/utils/snapshotBuffer.hpp
+#ifndef SNAPSHOT_BUFFER_HPP
+#define SNAPSHOT_BUFFER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+namespace GrowController {
+
+/**
+ * @brief Texto pré-serializado (ex: JSON) em buffer duplo fixo, com versão.
+ *
+ * Um único escritor monta a versão nova no slot que não está publicado e só
+ * então a publica; leitores copiam o slot publicado sem lock. Cada slot tem um
+ * contador de sequência (ímpar durante a escrita): se o escritor reutilizar o
+ * slot durante a cópia, o leitor percebe e tenta de novo. Sem alocação.
+ * @tparam N Capacidade de cada slot em bytes (inclui o '\0').
+ */
+template <size_t N>
+class SnapshotBuffer {
+public:
+    static_assert(N > 1, "SnapshotBuffer capacity must hold at least one char");
+
+    /**
+     * @brief Publica um snapshot novo. Apenas um escritor por vez.
+     * @param fill Chamado como fill(char* out, size_t capacity) -> size_t; retornar 0 (ou >= capacity) descarta.
+     * @return false Se fill falhou; o snapshot anterior continua publicado.
+     */
+    template <typename Fill>
+    bool write(Fill fill) {
+        uint32_t next = published.load(std::memory_order_relaxed) + 1;
+        Slot& slot = slots[next & 1];
+        slot.sequence.fetch_add(1, std::memory_order_relaxed); // Ímpar: em escrita
+        std::atomic_thread_fence(std::memory_order_release);
+        size_t length = fill(slot.data, N);
+        bool ok = length > 0 && length < N;
+        if (ok) {
+            slot.data[length] = '\0';
+            slot.length.store(length, std::memory_order_relaxed);
+        }
+        slot.sequence.fetch_add(1, std::memory_order_release); // Par: estável
+        if (ok) {
+            published.store(next, std::memory_order_release);
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Copia o snapshot publicado (terminado em '\0') para out.
+     * @param version Recebe a versão copiada (opcional).
+     * @return size_t Tamanho copiado, ou 0 se nada foi publicado ou out é pequeno demais.
+     */
+    size_t read(char* out, size_t size, uint32_t* version = nullptr) const {
+        while (true) {
+            uint32_t current = published.load(std::memory_order_acquire);
+            if (current == 0) {
+                return 0;
+            }
+            const Slot& slot = slots[current & 1];
+            uint32_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue; // Escritor reutilizando este slot; a próxima volta pega o novo
+            }
+            size_t length = slot.length.load(std::memory_order_relaxed);
+            if (length >= size) {
+                return 0;
+            }
+            memcpy(out, slot.data, length);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != before) {
+                continue; // Cópia possivelmente rasgada
+            }
+            out[length] = '\0';
+            if (version) *version = current;
+            return length;
+        }
+    }
+
+    /**
+     * @brief Versão publicada (0 = nenhum snapshot ainda). Cresce a cada write() bem-sucedido.
+     */
+    uint32_t version() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() {
+        return N;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<size_t> length{0};
+        char data[N];
+    };
+
+    Slot slots[2];
+    std::atomic<uint32_t> published{0};
+};
+
+} // namespace GrowController
+
+#endif // SNAPSHOT_BUFFER_HPP
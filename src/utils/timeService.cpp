@@ -2,11 +2,18 @@
 #include <Arduino.h> // Para Serial e funções de tempo do ESP-IDF via Arduino core
 #include <time.h>    // Para configTime, getLocalTime, struct tm
 #include <string.h>  // Para strlen
+#include <sys/time.h> // Para gettimeofday
+#include "esp_sntp.h" // Para sntp_set_time_sync_notification_cb
 
 namespace GrowController {
 
+// Antes disso o relógio ainda não foi acertado (mesmo critério do getLocalTime)
+static const time_t MIN_VALID_EPOCH = 1451606400; // 2016-01-01
+
+TimeService* TimeService::syncInstance = nullptr;
+
 // --- Construtor ---
-TimeService::TimeService() : serviceInitializedState(false) {
+TimeService::TimeService(ChangeNotifier* notifier) : serviceInitializedState(false), changeNotifier(notifier) {
     // Inicialização básica, o trabalho pesado fica no método initialize()
 }
 
@@ -39,6 +46,9 @@ bool TimeService::initialize(const TimeConfig& config) {
 
     // Configura o cliente SNTP interno do ESP-IDF
     configTime(config.utcOffsetInSeconds, 0, config.ntpServer);
+    // Cada sincronização (inicial e correções periódicas) avisa quem agenda por horário
+    syncInstance = this;
+    sntp_set_time_sync_notification_cb(&TimeService::_onTimeSync);
 
     // Tenta obter a hora inicial para verificar se a configuração funcionou
     Serial.println("TimeService: Waiting for initial NTP sync...");
@@ -93,6 +103,29 @@ bool TimeService::getCurrentTime(struct tm& timeinfo) const {
     return true; // Hora obtida com sucesso
 }
 
+bool TimeService::getCurrentEpoch(time_t& now, uint16_t* millisPart) const {
+    if (!this->serviceInitializedState) {
+        return false;
+    }
+    struct timeval tv;
+    if (gettimeofday(&tv, nullptr) != 0 || tv.tv_sec < MIN_VALID_EPOCH) {
+        return false; // Relógio ainda não sincronizado
+    }
+    now = tv.tv_sec;
+    if (millisPart) {
+        *millisPart = (uint16_t)(tv.tv_usec / 1000);
+    }
+    return true;
+}
+
+void TimeService::_onTimeSync(struct timeval* tv) {
+    (void)tv;
+    TimeService* instance = syncInstance;
+    if (instance && instance->changeNotifier) {
+        instance->changeNotifier->notify(CHANGE_TIME);
+    }
+}
+
 // --- Verificação de Inicialização ---
 /**
  * @brief Verifica se o serviço de tempo foi inicializado com sucesso.
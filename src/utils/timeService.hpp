@@ -3,6 +3,8 @@
 
 #include "config.hpp" // Para a struct TimeConfig
 #include <time.h>     // Para a struct tm
+#include <stdint.h>
+#include "utils/changeNotifier.hpp" // Aviso de ajuste do relógio (CHANGE_TIME)
 
 namespace GrowController {
 
@@ -13,9 +15,10 @@ namespace GrowController {
 class TimeService {
 public:
     /**
-     * @brief Construtor padrão.
+     * @brief Construtor.
+     * @param notifier Avisado (CHANGE_TIME) a cada sincronização SNTP (opcional).
      */
-    TimeService();
+    explicit TimeService(ChangeNotifier* notifier = nullptr);
 
     /**
      * @brief Destrutor padrão.
@@ -47,6 +50,16 @@ public:
      */
     bool getCurrentTime(struct tm& timeinfo) const; // Marcado como const
 
+    /**
+     * @brief Obtém o instante atual (epoch, UTC) sem bloquear.
+     *
+     * @param now Preenchido com os segundos desde 1970 se a função for bem-sucedida.
+     * @param millisPart Opcional: fração de segundo em ms, para agendar com precisão.
+     * @return true Se o relógio já foi acertado pelo NTP.
+     * @return false Se o serviço não foi inicializado ou o relógio ainda não é válido.
+     */
+    bool getCurrentEpoch(time_t& now, uint16_t* millisPart = nullptr) const;
+
     /**
      * @brief Verifica se o serviço de tempo foi inicializado (tentativa de configuração NTP ocorreu).
      * Não garante que o NTP esteja *atualmente* sincronizado.
@@ -57,7 +70,14 @@ public:
     bool isInitialized() const; // Marcado como const
 
 private:
+    /**
+     * @brief Callback do SNTP (roda na tarefa do lwIP): só repassa o aviso.
+     */
+    static void _onTimeSync(struct timeval* tv);
+
+    static TimeService* syncInstance;     // Instância avisada pelo callback do SNTP (sem contexto)
     bool serviceInitializedState = false; // Estado interno da classe
+    ChangeNotifier* changeNotifier;       // Pode ser nullptr
     // Poderia armazenar a config aqui se necessário para re-inicialização, mas não é o caso agora.
     // const TimeConfig* timeConfigPtr = nullptr;
 };
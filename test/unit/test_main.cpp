@@ -1,6 +1,79 @@
 #include <unity.h>
 #include "sensors/sensorManager.hpp" // Inclui a declaração de calculateVpd
 #include <cmath> // Incluir para isnan se usar no teste (ou confiar que a função interna faz)
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "network/mqttTopics.hpp"
+#include "network/mqttOutbox.hpp"
+#include "utils/ringBuffer.hpp"
+#include "network/storeForwardQueue.hpp"
+#include "utils/mpscQueue.hpp"
+#include "network/mqttBackoff.hpp"
+#include "network/mqttQos1.hpp"
+#include "network/mqttHistory.hpp"
+#include "network/telemetryCodec.hpp"
+#include "data/runtimeRates.hpp"
+#include "network/staticAssetManifest.hpp"
+#include "utils/snapshotBuffer.hpp"
+#include "network/stateFields.hpp"
+#include "network/liveFrame.hpp"
+#include "network/requestBodyPool.hpp"
+#include "utils/metrics.hpp"
+#include "data/historyCursor.hpp"
+#include "network/admissionControl.hpp"
+#include "actuators/controlSchedule.hpp"
+#include "actuators/humidityController.hpp"
+#include "actuators/lightSchedule.hpp"
+#include "actuators/actuatorEngine.hpp"
+#include "actuators/actuatorUsage.hpp"
+#include "utils/psychrometrics.hpp"
+#include <string>
+#ifndef ARDUINO
+#include <thread>
+#include <vector>
+#endif
+
+// Hook de alocação: o ambiente de teste linka com -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc
+// (ver platformio.ini), então toda chamada a malloc/calloc/realloc passa por aqui, inclusive
+// as do operator new abaixo e as de funções da libc ligadas estaticamente (newlib no ESP32).
+static volatile bool g_countAllocations = false;
+static volatile unsigned long g_allocationCount = 0;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    if (g_countAllocations) g_allocationCount++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    if (g_countAllocations) g_allocationCount++;
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    if (g_countAllocations) g_allocationCount++;
+    return __real_realloc(ptr, size);
+}
+}
+
+void* operator new(size_t size) {
+    void* ptr = malloc(size); // Contado pelo __wrap_malloc
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
 
 using GrowController::SensorManager; // Opcional: para evitar digitar GrowController::SensorManager:: repetidamente
 
@@ -45,12 +118,1258 @@ void test_calculateVpd(void) {
    TEST_ASSERT_TRUE(isnan(actual_vpd5));
 }
 
+void test_mqttTopicTable(void) {
+    GrowController::MqttTopicTable table;
+    TEST_ASSERT_EQUAL_STRING("", table.get(GrowController::MqttTopic::Control)); // Ainda não montada
+    TEST_ASSERT_TRUE(table.build("01"));
+    TEST_ASSERT_EQUAL_STRING("01/control", table.get(GrowController::MqttTopic::Control));
+    TEST_ASSERT_EQUAL_STRING("01/devices", table.get(GrowController::MqttTopic::Devices));
+    TEST_ASSERT_EQUAL_STRING("01/sensors/air_humidity", table.get(GrowController::MqttTopic::SensorAirHumidity));
+    TEST_ASSERT_EQUAL_STRING("01", table.getBase());
+
+    // Tópico base longo demais não pode ser truncado silenciosamente
+    char longRoom[GrowController::MqttTopicTable::MAX_TOPIC_LENGTH];
+    memset(longRoom, 'x', sizeof(longRoom) - 1);
+    longRoom[sizeof(longRoom) - 1] = '\0';
+    TEST_ASSERT_FALSE(table.build(longRoom));
+}
+
+void test_mqttPublishPathDoesNotAllocate(void) {
+    using namespace GrowController;
+    MqttTopicTable table;
+    TEST_ASSERT_TRUE(table.build("01")); // Montagem (setup) fora da contagem
+    static MqttOutbox<32> outbox; // Mesma outbox de MqttManager::publish() -> _enqueue()
+
+    // Sanidade do hook: uma alocação de verdade é contada
+    g_allocationCount = 0;
+    g_countAllocations = true;
+    void* volatile probe = malloc(16); // volatile: o par malloc/free não pode ser eliminado
+    g_countAllocations = false;
+    free(probe);
+    TEST_ASSERT_EQUAL_UINT32(1, g_allocationCount);
+
+    const MqttTopic sensorTopics[] = {
+        MqttTopic::SensorTemperature,
+        MqttTopic::SensorAirHumidity,
+        MqttTopic::SensorSoilHumidity,
+        MqttTopic::SensorVpd,
+    };
+    const TelemetryCodec codecs[] = {TelemetryCodec::Text, TelemetryCodec::Cbor, TelemetryCodec::Binary};
+    size_t totalLength = 0;
+    uint32_t pushed = 0;
+
+    g_allocationCount = 0;
+    g_countAllocations = true;
+    for (int i = 0; i < 10000; ++i) {
+        // Caminho do produtor: codifica no item, enfileira; a tarefa MQTT consome
+        MqttOutboxItem item;
+        bool encoded = (i % 10 == 9)
+            ? encodeTextItem(item, MqttTopic::Devices, (i & 1) ? "online" : "offline", true)
+            : encodeTelemetryItem(item, sensorTopics[i % 4], 20.0f + (i % 100) * 0.1f, codecs[i % 3], 1, false);
+        if (encoded && outbox.push(item, (uint32_t)i)) pushed++;
+
+        MqttOutboxItem sent;
+        while (outbox.tryPop(sent)) {
+            totalLength += strlen(table.get(sent.topic)) + sent.length;
+        }
+    }
+    g_countAllocations = false;
+
+    TEST_ASSERT_EQUAL_UINT32(10000, pushed);
+    TEST_ASSERT_EQUAL_UINT32(10000, outbox.enqueued());
+    TEST_ASSERT_TRUE(totalLength > 0);
+    TEST_ASSERT_EQUAL_UINT32(0, g_allocationCount);
+
+    // Fila cheia e payload grande demais: descartados e contados, sem alocar
+    MqttOutboxItem item;
+    TEST_ASSERT_TRUE(encodeTelemetryItem(item, MqttTopic::SensorVpd, 1.0f, TelemetryCodec::Text, 0, false));
+    for (size_t i = 0; i < 32; ++i) TEST_ASSERT_TRUE(outbox.push(item, 0));
+    TEST_ASSERT_FALSE(outbox.push(item, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, outbox.dropped());
+    TEST_ASSERT_EQUAL_UINT32(32, outbox.maxDepth());
+    TEST_ASSERT_FALSE(encodeTextItem(item, MqttTopic::Devices, "0123456789012345678901234567890123456789", false));
+}
+
+void test_ringBufferFifoAndCapacity(void) {
+    GrowController::RingBuffer<int, 4> ring;
+    int value = 0;
+    TEST_ASSERT_TRUE(ring.empty());
+    TEST_ASSERT_FALSE(ring.pop(value));
+
+    for (int i = 1; i <= 4; ++i) TEST_ASSERT_TRUE(ring.push(i));
+    TEST_ASSERT_TRUE(ring.full());
+    TEST_ASSERT_FALSE(ring.push(5)); // Cheio: não sobrescreve silenciosamente
+
+    TEST_ASSERT_TRUE(ring.pop(value));
+    TEST_ASSERT_EQUAL_INT(1, value);
+    TEST_ASSERT_TRUE(ring.push(5)); // Dá a volta no índice
+    ring.dropOldest();              // Descarta o 2
+
+    int expected[] = {3, 4, 5};
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT_TRUE(ring.pop(value));
+        TEST_ASSERT_EQUAL_INT(expected[i], value);
+    }
+    TEST_ASSERT_TRUE(ring.empty());
+}
+
+void test_storeForwardQueueSpillAndReplay(void) {
+    using namespace GrowController;
+    typedef StoreForwardQueue<4, 8> Queue;
+    static uint8_t file[sizeof(SpillHeader) + 8 * sizeof(QueuedReading)]; // Arquivo de segmento em RAM
+    auto writeFile = [](size_t offset, const QueuedReading& reading) {
+        if (offset + sizeof(reading) > sizeof(file)) return false;
+        memcpy(file + offset, &reading, sizeof(reading));
+        return true;
+    };
+    auto readFile = [](size_t offset, QueuedReading& out) {
+        if (offset + sizeof(out) > sizeof(file)) return false;
+        memcpy(&out, file + offset, sizeof(out));
+        return true;
+    };
+    auto reading = [](uint32_t timestamp) {
+        QueuedReading r = {};
+        r.timestamp = timestamp;
+        r.value = timestamp * 0.5f;
+        return r;
+    };
+
+    // Mesmo fluxo do MqttStoreForward::enqueue(): RAM cheia despeja tudo no arquivo antes do push
+    Queue queue;
+    queue.resetSpill(0x53465131);
+    for (uint32_t t = 1; t <= 20; ++t) {
+        if (queue.ramFull()) TEST_ASSERT_TRUE(queue.spillRam(writeFile));
+        TEST_ASSERT_TRUE(queue.push(reading(t)));
+    }
+    // Arquivo (8) deu a volta duas vezes: 1..8 descartados, ficam 9..16 no arquivo e 17..20 na RAM
+    TEST_ASSERT_EQUAL_UINT32(8, queue.droppedCount());
+    TEST_ASSERT_EQUAL_UINT32(8, queue.spilled());
+    TEST_ASSERT_EQUAL_UINT32(12, queue.size());
+    TEST_ASSERT_EQUAL_UINT32(8, queue.header().head);
+    TEST_ASSERT_EQUAL_UINT32(16, queue.header().tail);
+    TEST_ASSERT_EQUAL_UINT32(Queue::spillOffset(8), Queue::spillOffset(16));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(SpillHeader), Queue::spillOffset(0));
+
+    // Replay: do mais antigo para o mais novo, arquivo e depois RAM
+    QueuedReading out;
+    uint32_t version = 0;
+    uint32_t expected = 9;
+    int headerWrites = 0;
+    while (queue.front(out, &version, readFile) == Queue::FrontStatus::Ready) {
+        TEST_ASSERT_EQUAL_UINT32(expected, out.timestamp);
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, expected * 0.5f, out.value);
+        if (queue.popFront(version)) headerWrites++;
+        expected++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(21, expected);
+    TEST_ASSERT_EQUAL_INT(8, headerWrites); // Só as remoções do arquivo mexem no cabeçalho
+    TEST_ASSERT_EQUAL_UINT32(0, queue.size());
+
+    // Frente descartada durante a entrega: popFront() não remove o item seguinte (no máximo duplica)
+    Queue ramOnly;
+    for (uint32_t t = 1; t <= 4; ++t) ramOnly.push(reading(t));
+    TEST_ASSERT_TRUE(ramOnly.front(out, &version, readFile) == Queue::FrontStatus::Ready);
+    TEST_ASSERT_EQUAL_UINT32(1, out.timestamp);
+    TEST_ASSERT_FALSE(ramOnly.push(reading(5))); // Sem arquivo: descarta o 1
+    TEST_ASSERT_FALSE(ramOnly.popFront(version));
+    TEST_ASSERT_EQUAL_UINT32(4, ramOnly.size());
+    TEST_ASSERT_TRUE(ramOnly.front(out, &version, readFile) == Queue::FrontStatus::Ready);
+    TEST_ASSERT_EQUAL_UINT32(2, out.timestamp);
+    ramOnly.popFront(version);
+    TEST_ASSERT_TRUE(ramOnly.front(out, &version, readFile) == Queue::FrontStatus::Ready);
+    TEST_ASSERT_EQUAL_UINT32(3, out.timestamp);
+
+    // Registro ilegível no arquivo é descartado em vez de travar a drenagem
+    Queue broken;
+    broken.resetSpill(0x53465131);
+    for (uint32_t t = 1; t <= 4; ++t) broken.push(reading(t));
+    TEST_ASSERT_TRUE(broken.spillRam(writeFile));
+    auto failRead = [](size_t, QueuedReading&) { return false; };
+    TEST_ASSERT_TRUE(broken.front(out, &version, failRead) == Queue::FrontStatus::Unreadable);
+    TEST_ASSERT_EQUAL_UINT32(1, broken.droppedCount());
+    TEST_ASSERT_EQUAL_UINT32(3, broken.size());
+
+    // Cabeçalho gravado: aceito só com magic certo e ocupação dentro da capacidade
+    SpillHeader stored = {0x53465131, 100, 108};
+    TEST_ASSERT_TRUE(broken.restore(stored, 0x53465131));
+    TEST_ASSERT_EQUAL_UINT32(8, broken.spilled());
+    stored.tail = 109;
+    TEST_ASSERT_FALSE(broken.restore(stored, 0x53465131));
+    stored.tail = 101;
+    TEST_ASSERT_FALSE(broken.restore(stored, 0x12345678));
+}
+
+void test_mpscQueueFifoAndConcurrentProducers(void) {
+    GrowController::MpscQueue<uint32_t, 8> queue;
+    uint32_t value = 0;
+    TEST_ASSERT_FALSE(queue.tryPop(value));
+    for (uint32_t i = 0; i < 8; ++i) TEST_ASSERT_TRUE(queue.tryPush(i));
+    TEST_ASSERT_FALSE(queue.tryPush(99)); // Cheia: o produtor não bloqueia
+    TEST_ASSERT_EQUAL_UINT32(8, queue.sizeApprox());
+    for (uint32_t i = 0; i < 8; ++i) {
+        TEST_ASSERT_TRUE(queue.tryPop(value));
+        TEST_ASSERT_EQUAL_UINT32(i, value);
+    }
+    TEST_ASSERT_TRUE(queue.emptyApprox());
+
+#ifndef ARDUINO
+    // Vários produtores, um consumidor: nada perdido, ordem preservada por produtor
+    static GrowController::MpscQueue<uint32_t, 64> shared;
+    const uint32_t producers = 4, perProducer = 20000;
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; ++p) {
+        threads.emplace_back([p]() {
+            for (uint32_t i = 0; i < perProducer; ++i) {
+                while (!shared.tryPush((p << 24) | i)) std::this_thread::yield();
+            }
+        });
+    }
+    uint32_t next[producers] = {0};
+    uint32_t received = 0;
+    bool ordered = true;
+    while (received < producers * perProducer) {
+        if (!shared.tryPop(value)) continue;
+        uint32_t p = value >> 24;
+        ordered = ordered && (value & 0xFFFFFF) == next[p];
+        next[p]++;
+        received++;
+    }
+    for (auto& t : threads) t.join();
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_TRUE(shared.emptyApprox());
+#endif
+}
+
+void test_mqttBackoffBoundsAndJitter(void) {
+    using GrowController::backoffCeilingMs;
+    using GrowController::computeBackoffMs;
+    // Teto dobra a cada falha até maxDoublings e respeita o limite absoluto
+    TEST_ASSERT_EQUAL_UINT32(5000, backoffCeilingMs(0, 5000, 60000, 3));
+    TEST_ASSERT_EQUAL_UINT32(10000, backoffCeilingMs(1, 5000, 60000, 3));
+    TEST_ASSERT_EQUAL_UINT32(40000, backoffCeilingMs(3, 5000, 60000, 3));
+    TEST_ASSERT_EQUAL_UINT32(40000, backoffCeilingMs(200, 5000, 60000, 3));
+    TEST_ASSERT_EQUAL_UINT32(60000, backoffCeilingMs(200, 5000, 60000, 255)); // Sem overflow no shift
+
+    // Jitter cobre [0, teto] inteiro
+    TEST_ASSERT_EQUAL_UINT32(0, computeBackoffMs(2, 5000, 60000, 3, 0));
+    TEST_ASSERT_EQUAL_UINT32(20000, computeBackoffMs(2, 5000, 60000, 3, 20000));
+    uint32_t seed = 12345;
+    for (int i = 0; i < 1000; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        uint8_t failures = (uint8_t)(i % 8);
+        TEST_ASSERT_TRUE(computeBackoffMs(failures, 5000, 60000, 3, seed) <= backoffCeilingMs(failures, 5000, 60000, 3));
+    }
+}
+
+void test_mqttQos1PublishAndPubackParsing(void) {
+    using namespace GrowController;
+    // PUBLISH QoS 1, retained, packet id 0x1234: "a/b" -> "1.5"
+    uint8_t packet[32];
+    size_t len = encodeQos1Publish(packet, sizeof(packet), "a/b", "1.5", 3, 0x1234, true, false);
+    const uint8_t expected[] = {0x33, 10, 0x00, 0x03, 'a', '/', 'b', 0x12, 0x34, '1', '.', '5'};
+    TEST_ASSERT_EQUAL_UINT32(sizeof(expected), len);
+    TEST_ASSERT_EQUAL_MEMORY(expected, packet, sizeof(expected));
+    len = encodeQos1Publish(packet, sizeof(packet), "a/b", "1.5", 3, 0x1234, false, true);
+    TEST_ASSERT_EQUAL_HEX8(0x3A, packet[0]); // DUP sem retain
+    TEST_ASSERT_EQUAL_UINT32(0, encodeQos1Publish(packet, 8, "a/b", "1.5", 3, 1, false, false)); // Não cabe
+    TEST_ASSERT_EQUAL_UINT32(0, encodeQos1Publish(packet, sizeof(packet), "a/b", "1.5", 3, 0, false, false)); // ID 0
+
+    // Fluxo: SUBACK, PUBLISH recebido (payload longo), PINGRESP, dois PUBACKs
+    const uint8_t stream[] = {0x90, 0x03, 0x00, 0x01, 0x00,
+                              0x30, 0x07, 0x00, 0x01, 'x', 'a', 'b', 'c', 'd',
+                              0xD0, 0x00,
+                              0x40, 0x02, 0x00, 0x07,
+                              0x40, 0x02, 0xFF, 0xFE};
+    MqttPacketSniffer sniffer;
+    uint16_t acks[4];
+    size_t ackCount = 0;
+    for (size_t i = 0; i < sizeof(stream); ++i) {
+        uint16_t id;
+        if (sniffer.feed(stream[i], id)) acks[ackCount++] = id;
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, ackCount);
+    TEST_ASSERT_EQUAL_UINT16(0x0007, acks[0]);
+    TEST_ASSERT_EQUAL_UINT16(0xFFFE, acks[1]);
+
+    // Janela: IDs únicos e não nulos, libera só com o PUBACK certo, ordem de retransmissão
+    MqttInflightWindow<int, 3> window;
+    auto* e1 = window.add(10, 100);
+    auto* e2 = window.add(20, 101);
+    auto* e3 = window.add(30, 102);
+    TEST_ASSERT_NOT_NULL(e3);
+    TEST_ASSERT_NULL(window.add(40, 103));
+    TEST_ASSERT_TRUE(e1->packetId != 0 && e1->packetId != e2->packetId && e2->packetId != e3->packetId);
+    uint16_t secondId = e2->packetId;
+    TEST_ASSERT_TRUE(window.acknowledge(secondId));
+    TEST_ASSERT_FALSE(window.acknowledge(secondId)); // PUBACK duplicado
+    TEST_ASSERT_NOT_NULL(window.add(50, 104));
+    int order[3];
+    size_t visited = 0;
+    window.forEachOldestFirst([&](MqttInflightWindow<int, 3>::Entry& entry) { order[visited++] = entry.message; });
+    TEST_ASSERT_EQUAL_UINT32(3, visited);
+    TEST_ASSERT_EQUAL_INT(10, order[0]);
+    TEST_ASSERT_EQUAL_INT(30, order[1]);
+    TEST_ASSERT_EQUAL_INT(50, order[2]);
+    TEST_ASSERT_EQUAL_INT(10, window.oldest()->message);
+}
+
+void test_mqttHistoryChunkFormatting(void) {
+    using namespace GrowController;
+    HistoricDataPoint points[3] = {
+        {1700000000, 24.5f, 70.0f, NAN, 0.92f},
+        {1700001800, 25.0f, 71.25f, 40.0f, 0.9f},
+        {1700003600, 25.5f, 72.0f, 41.0f, 0.875f},
+    };
+    char out[256];
+    size_t consumed = 0;
+    size_t len = formatHistoryChunk(out, sizeof(out), "abc", 2, points, 2, true, consumed);
+    TEST_ASSERT_EQUAL_UINT32(2, consumed);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":\"abc\",\"seq\":2,\"tier\":\"30min\",\"records\":["
+                             "[1700000000,24.50,70.00,null,0.920],[1700001800,25.00,71.25,40.00,0.900]],\"end\":true}", out);
+    TEST_ASSERT_EQUAL_UINT32(strlen(out), len);
+
+    // Buffer pequeno: só cabe parte dos registros, e o fim não é marcado
+    char small[110];
+    len = formatHistoryChunk(small, sizeof(small), "abc", 0, points, 3, true, consumed);
+    TEST_ASSERT_TRUE(len > 0 && len < sizeof(small));
+    TEST_ASSERT_EQUAL_UINT32(1, consumed);
+    TEST_ASSERT_NOT_NULL(strstr(small, "\"end\":false}"));
+
+    // Chunk vazio de fim de stream
+    len = formatHistoryChunk(out, sizeof(out), "abc", 3, points, 0, true, consumed);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":\"abc\",\"seq\":3,\"tier\":\"30min\",\"records\":[],\"end\":true}", out);
+
+    // ID com aspas, barra ou controle quebraria o JSON (ou injetaria campos): rejeitado
+    TEST_ASSERT_EQUAL_UINT32(0, formatHistoryChunk(out, sizeof(out), "a\"b", 0, points, 1, true, consumed));
+    TEST_ASSERT_FALSE(isValidHistoryId("a\"b"));
+    TEST_ASSERT_FALSE(isValidHistoryId("a\\b"));
+    TEST_ASSERT_FALSE(isValidHistoryId("a\nb"));
+    TEST_ASSERT_FALSE(isValidHistoryId("x\",\"end\":true,\"y"));
+    TEST_ASSERT_FALSE(isValidHistoryId("0123456789abcdef0123456789abcdef0")); // 33 caracteres
+    TEST_ASSERT_TRUE(isValidHistoryId("0123456789abcdef0123456789abcdef"));
+    TEST_ASSERT_TRUE(isValidHistoryId("req-42_v1.0"));
+    TEST_ASSERT_TRUE(isValidHistoryId(""));
+
+    // Filtro por intervalo em ordem de cursor: registro anterior ao NTP (fora de ordem) e
+    // timestamps repetidos continuam no stream; só o que está fora de [from, to] sai
+    HistoricDataPoint ring[5] = {
+        {1700001800, 1.0f, 0, 0, 0},
+        {1700001800, 2.0f, 0, 0, 0}, // Mesmo timestamp do anterior
+        {1000, 3.0f, 0, 0, 0},       // Gravado antes do NTP, fora do intervalo
+        {1700000900, 4.0f, 0, 0, 0}, // Fora de ordem, mas dentro do intervalo
+        {1700009000, 5.0f, 0, 0, 0}, // Depois de "to"
+    };
+    uint32_t cursors[5];
+    size_t kept = filterHistoryRange(ring, 5, 41, 1700000000, 1700005000, cursors);
+    TEST_ASSERT_EQUAL_UINT32(3, kept);
+    const float expectedTemps[] = {1.0f, 2.0f, 4.0f};
+    const uint32_t expectedCursors[] = {41, 42, 44};
+    for (size_t i = 0; i < kept; ++i) {
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, expectedTemps[i], ring[i].avgTemperature);
+        TEST_ASSERT_EQUAL_UINT32(expectedCursors[i], cursors[i]);
+    }
+}
+
+void test_telemetryCodecGoldenVectors(void) {
+    using namespace GrowController;
+    uint8_t out[16];
+    float decoded = 0.0f;
+
+    // Texto
+    TEST_ASSERT_EQUAL_UINT32(5, encodeTelemetry(TelemetryCodec::Text, 24.5f, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY("24.50", out, 5);
+
+    // CBOR: meia precisão quando exata, float32 caso contrário
+    const uint8_t cborHalf[] = {0xF9, 0x4E, 0x20};
+    TEST_ASSERT_EQUAL_UINT32(3, encodeTelemetry(TelemetryCodec::Cbor, 24.5f, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(cborHalf, out, 3);
+    const uint8_t cborFloat[] = {0xFA, 0x3F, 0x6B, 0x85, 0x1F};
+    TEST_ASSERT_EQUAL_UINT32(5, encodeTelemetry(TelemetryCodec::Cbor, 0.92f, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(cborFloat, out, 5);
+
+    // Struct binária: v1 (centésimos int16 LE) e v2 (float32 LE) fora do alcance
+    const uint8_t binCenti[] = {0x01, 0x92, 0x09};
+    TEST_ASSERT_EQUAL_UINT32(3, encodeTelemetry(TelemetryCodec::Binary, 24.5f, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(binCenti, out, 3);
+    const uint8_t binNegative[] = {0x01, 0x06, 0xFF}; // -2.50
+    TEST_ASSERT_EQUAL_UINT32(3, encodeTelemetry(TelemetryCodec::Binary, -2.5f, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(binNegative, out, 3);
+    const uint8_t binFloat[] = {0x02, 0x00, 0x00, 0x7A, 0x44}; // 1000.0
+    TEST_ASSERT_EQUAL_UINT32(5, encodeTelemetry(TelemetryCodec::Binary, 1000.0f, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(binFloat, out, 5);
+
+    // Ida e volta com precisão de 2 casas (a mesma do texto)
+    const float samples[] = {0.0f, 24.37f, 73.21f, 1.234f, -10.5f, 327.67f, 4095.0f};
+    const TelemetryCodec codecs[] = {TelemetryCodec::Text, TelemetryCodec::Cbor, TelemetryCodec::Binary};
+    for (TelemetryCodec codec : codecs) {
+        for (float sample : samples) {
+            size_t len = encodeTelemetry(codec, sample, out, sizeof(out));
+            TEST_ASSERT_TRUE(len > 0);
+            TEST_ASSERT_TRUE(decodeTelemetry(codec, out, len, decoded));
+            TEST_ASSERT_FLOAT_WITHIN(0.005f, sample, decoded);
+        }
+        size_t len = encodeTelemetry(codec, NAN, out, sizeof(out));
+        TEST_ASSERT_TRUE(decodeTelemetry(codec, out, len, decoded));
+        TEST_ASSERT_TRUE(isnan(decoded));
+    }
+
+    // Payloads malformados são rejeitados
+    const uint8_t unknownVersion[] = {0x07, 0x00, 0x00};
+    TEST_ASSERT_FALSE(decodeTelemetry(TelemetryCodec::Binary, unknownVersion, 3, decoded));
+    TEST_ASSERT_FALSE(decodeTelemetry(TelemetryCodec::Cbor, cborFloat, 4, decoded));
+    TEST_ASSERT_FALSE(decodeTelemetry(TelemetryCodec::Text, (const uint8_t*)"12x", 3, decoded));
+}
+
+void test_runtimeRatesValidation(void) {
+    using namespace GrowController;
+    RuntimeRates rates;
+    const char* invalidKey = nullptr;
+    TEST_ASSERT_TRUE(validateRuntimeRates(rates, &invalidKey)); // Padrões sempre válidos
+    TEST_ASSERT_NULL(invalidKey);
+
+    // Limites são inclusivos
+    rates.sensorReadIntervalMs = 2000;
+    rates.mqttServiceIntervalMs = 10000;
+    TEST_ASSERT_TRUE(validateRuntimeRates(rates));
+
+    // DHT22 não lê em menos de 2 s
+    rates.sensorReadIntervalMs = 1999;
+    TEST_ASSERT_FALSE(validateRuntimeRates(rates, &invalidKey));
+    TEST_ASSERT_EQUAL_STRING("sensorReadIntervalMs", invalidKey);
+
+    rates = RuntimeRates();
+    rates.historySaveIntervalMs = 86400001;
+    TEST_ASSERT_FALSE(validateRuntimeRates(rates, &invalidKey));
+    TEST_ASSERT_EQUAL_STRING("historySaveIntervalMs", invalidKey);
+
+    // Chaves NVS precisam caber no limite de 15 caracteres
+    for (size_t i = 0; i < RUNTIME_RATE_FIELD_COUNT; ++i) {
+        TEST_ASSERT_TRUE(strlen(RUNTIME_RATE_FIELDS[i].nvsKey) <= 15);
+    }
+}
+
+void test_staticAssetManifestAndEtag(void) {
+    using namespace GrowController;
+    StaticAsset asset;
+    TEST_ASSERT_TRUE(parseStaticAssetLine("/scripts.js 710d8bc33080091a immutable", asset));
+    TEST_ASSERT_EQUAL_STRING("/scripts.js", asset.path);
+    TEST_ASSERT_EQUAL_STRING("\"710d8bc33080091a\"", asset.etag);
+    TEST_ASSERT_TRUE(asset.immutable);
+    TEST_ASSERT_TRUE(parseStaticAssetLine("/index.html 8cea12a23e105d7f revalidate\r", asset));
+    TEST_ASSERT_FALSE(asset.immutable);
+
+    TEST_ASSERT_FALSE(parseStaticAssetLine("scripts.js 710d8bc33080091a immutable", asset)); // Sem '/'
+    TEST_ASSERT_FALSE(parseStaticAssetLine("/scripts.js 710d8bc33080091a forever", asset));
+    TEST_ASSERT_FALSE(parseStaticAssetLine("/scripts.js", asset));
+    TEST_ASSERT_FALSE(parseStaticAssetLine("/scripts.js 710d8bc33080091a7 immutable", asset)); // 17 dígitos
+    TEST_ASSERT_FALSE(parseStaticAssetLine("/scripts.js 710d8bc33080091 immutable", asset));   // 15 dígitos
+    TEST_ASSERT_FALSE(parseStaticAssetLine("/scripts.js 710d8bc33080091z immutable", asset));  // Não hex
+
+    const char* etag = "\"8cea12a23e105d7f\"";
+    TEST_ASSERT_TRUE(etagMatches("\"8cea12a23e105d7f\"", etag));
+    TEST_ASSERT_TRUE(etagMatches("W/\"8cea12a23e105d7f\"", etag));
+    TEST_ASSERT_TRUE(etagMatches("\"aaaa\", \"8cea12a23e105d7f\"", etag));
+    TEST_ASSERT_TRUE(etagMatches("*", etag));
+    TEST_ASSERT_FALSE(etagMatches("\"8cea12a23e105d7\"", etag)); // Prefixo não basta
+    TEST_ASSERT_FALSE(etagMatches("", etag));
+}
+
+void test_snapshotBufferVersionsAndConsistency(void) {
+    GrowController::SnapshotBuffer<32> snapshot;
+    char out[32];
+    uint32_t version = 0;
+    TEST_ASSERT_EQUAL_UINT32(0, snapshot.version());
+    TEST_ASSERT_EQUAL_UINT32(0, snapshot.read(out, sizeof(out))); // Nada publicado
+
+    TEST_ASSERT_TRUE(snapshot.write([](char* buf, size_t size) { return (size_t)snprintf(buf, size, "{\"a\":1}"); }));
+    TEST_ASSERT_EQUAL_UINT32(7, snapshot.read(out, sizeof(out), &version));
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1}", out);
+    TEST_ASSERT_EQUAL_UINT32(1, version);
+
+    // Falha do serializador mantém o snapshot anterior
+    TEST_ASSERT_FALSE(snapshot.write([](char*, size_t) { return (size_t)0; }));
+    TEST_ASSERT_EQUAL_UINT32(1, snapshot.version());
+    TEST_ASSERT_EQUAL_UINT32(7, snapshot.read(out, sizeof(out)));
+    TEST_ASSERT_EQUAL_UINT32(0, snapshot.read(out, 4)); // Destino pequeno demais
+
+#ifndef ARDUINO
+    // Um escritor, vários leitores: nenhuma cópia rasgada (todos os dígitos iguais)
+    static GrowController::SnapshotBuffer<64> shared;
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> torn{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            char local[64];
+            while (!done.load()) {
+                size_t len = shared.read(local, sizeof(local));
+                for (size_t i = 1; i < len; ++i) {
+                    if (local[i] != local[0]) { torn++; break; }
+                }
+            }
+        });
+    }
+    for (uint32_t i = 0; i < 50000; ++i) {
+        char digit = (char)('0' + i % 10);
+        shared.write([digit](char* buf, size_t) { memset(buf, digit, 48); return (size_t)48; });
+    }
+    done = true;
+    for (auto& t : readers) t.join();
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT32(50000, shared.version());
+#endif
+}
+
+void test_stateFieldsParsing(void) {
+    using namespace GrowController;
+    const char* unknown = nullptr;
+    TEST_ASSERT_EQUAL_UINT8(STATE_FIELDS_DEFAULT, parseStateFields(nullptr));
+    TEST_ASSERT_EQUAL_UINT8(STATE_FIELDS_DEFAULT, parseStateFields(""));
+    TEST_ASSERT_EQUAL_UINT8(STATE_FIELDS_DEFAULT, parseStateFields(" , ,"));
+    TEST_ASSERT_EQUAL_UINT8(STATE_FIELD_SENSORS | STATE_FIELD_STATUS, parseStateFields("sensors,status"));
+    TEST_ASSERT_EQUAL_UINT8(STATE_FIELD_HISTORY | STATE_FIELD_SYSTEM, parseStateFields(" history , system,"));
+    TEST_ASSERT_EQUAL_UINT8(STATE_FIELD_TARGETS, parseStateFields("targets,targets"));
+    TEST_ASSERT_EQUAL_UINT8(0, parseStateFields("sensors,sensor", &unknown)); // Prefixo não é aceito
+    TEST_ASSERT_EQUAL_STRING("sensor", unknown);
+    TEST_ASSERT_EQUAL_UINT8(0, parseStateFields("statusx"));
+}
+
+void test_liveFrameRoundTripAndRateCommand(void) {
+    using namespace GrowController;
+    uint8_t frame[LIVE_FRAME_SENSORS_SIZE];
+    LiveSensorSample sample;
+    sample.temperature = -3.25f;
+    sample.airHumidity = 61.5f;
+    sample.vpd = 1.234f;
+    sample.soilAdc = 2875; // soilHumidity fica NAN
+
+    TEST_ASSERT_EQUAL_UINT32(0, encodeLiveSensorFrame(sample, 1, 0, frame, sizeof(frame) - 1));
+    TEST_ASSERT_EQUAL_UINT32(18, encodeLiveSensorFrame(sample, 0x1234, 0xA0B0C0D0u, frame, sizeof(frame)));
+    // Cabeçalho e temperatura little-endian (o decodificador JS depende deste layout)
+    const uint8_t header[] = {LIVE_FRAME_VERSION, LIVE_FRAME_SENSORS, 0x34, 0x12, 0xD0, 0xC0, 0xB0, 0xA0, 0xBB, 0xFE};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(header, frame, sizeof(header));
+
+    LiveSensorSample decoded;
+    uint16_t seq = 0;
+    uint32_t at = 0;
+    TEST_ASSERT_TRUE(decodeLiveSensorFrame(frame, sizeof(frame), decoded, &seq, &at));
+    TEST_ASSERT_EQUAL_UINT16(0x1234, seq);
+    TEST_ASSERT_EQUAL_UINT32(0xA0B0C0D0u, at);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -3.25f, decoded.temperature);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 61.5f, decoded.airHumidity);
+    TEST_ASSERT_TRUE(isnan(decoded.soilHumidity));
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 1.234f, decoded.vpd);
+    TEST_ASSERT_EQUAL_UINT16(2875, decoded.soilAdc);
+    TEST_ASSERT_FALSE(decodeLiveSensorFrame(frame, sizeof(frame) - 1, decoded));
+
+    uint8_t relays[LIVE_FRAME_ACTUATORS_SIZE];
+    TEST_ASSERT_EQUAL_UINT32(10, encodeLiveActuatorFrame(LIVE_RELAY_HUMIDIFIER, LIVE_RELAY_LIGHT, 7, 0, relays, sizeof(relays)));
+    TEST_ASSERT_EQUAL_UINT8(LIVE_FRAME_ACTUATORS, relays[1]);
+    TEST_ASSERT_EQUAL_UINT8(LIVE_RELAY_HUMIDIFIER, relays[8]);
+    TEST_ASSERT_EQUAL_UINT8(LIVE_RELAY_LIGHT, relays[9]);
+
+    uint16_t rate = 0;
+    TEST_ASSERT_TRUE(parseLiveRateCommand("rate=250", 8, rate));
+    TEST_ASSERT_EQUAL_UINT16(250, rate);
+    TEST_ASSERT_TRUE(parseLiveRateCommand("rate=5", 6, rate));
+    TEST_ASSERT_EQUAL_UINT16(LIVE_RATE_MIN_MS, rate);
+    TEST_ASSERT_TRUE(parseLiveRateCommand("rate=999999", 11, rate));
+    TEST_ASSERT_EQUAL_UINT16(LIVE_RATE_MAX_MS, rate);
+    TEST_ASSERT_FALSE(parseLiveRateCommand("rate=", 5, rate));
+    TEST_ASSERT_FALSE(parseLiveRateCommand("rate=1x", 7, rate));
+    TEST_ASSERT_FALSE(parseLiveRateCommand("speed=100", 9, rate));
+}
+
+void test_requestBodyPoolInterleavedRequests(void) {
+    typedef GrowController::RequestBodyPool<2, 16> Pool;
+    static Pool pool;
+    int requestA, requestB, requestC; // Só os endereços importam (owner)
+    const uint8_t* a = (const uint8_t*)"{\"a\":1111}";   // 10 bytes
+    const uint8_t* b = (const uint8_t*)"{\"bb\":22222}"; // 12 bytes
+    Pool::Body body = {nullptr, 0};
+
+    // Chunks de A e B intercalados não se misturam
+    TEST_ASSERT_EQUAL(Pool::Status::Incomplete, pool.append(&requestA, a, 4, 0, 10));
+    TEST_ASSERT_EQUAL(Pool::Status::Incomplete, pool.append(&requestB, b, 5, 0, 12));
+    TEST_ASSERT_EQUAL(Pool::Status::Busy, pool.append(&requestC, a, 4, 0, 10)); // Pool cheio: 503
+    TEST_ASSERT_EQUAL(Pool::Status::Incomplete, pool.append(&requestB, b + 5, 5, 5, 12));
+    TEST_ASSERT_EQUAL(Pool::Status::Complete, pool.append(&requestA, a + 4, 6, 4, 10, &body));
+    TEST_ASSERT_EQUAL_UINT32(10, body.length);
+    TEST_ASSERT_EQUAL_MEMORY(a, body.data, 10);
+    pool.release(&requestA);
+    TEST_ASSERT_EQUAL_UINT32(1, pool.inUse());
+    TEST_ASSERT_EQUAL(Pool::Status::Invalid, pool.append(&requestC, a + 4, 6, 4, 10)); // Resto do recusado: ignorado
+    TEST_ASSERT_EQUAL(Pool::Status::Complete, pool.append(&requestB, b + 10, 2, 10, 12, &body));
+    TEST_ASSERT_EQUAL_MEMORY(b, body.data, 12);
+    pool.release(&requestB);
+    pool.release(&requestB); // Idempotente (onDisconnect depois da resposta)
+    TEST_ASSERT_EQUAL_UINT32(0, pool.inUse());
+
+    // Limite de tamanho já no primeiro chunk, sem ocupar slot
+    TEST_ASSERT_EQUAL(Pool::Status::TooLarge, pool.append(&requestA, a, 4, 0, 17));
+    TEST_ASSERT_EQUAL(Pool::Status::Invalid, pool.append(&requestA, a, 4, 4, 17));
+    TEST_ASSERT_EQUAL_UINT32(0, pool.inUse());
+
+    // Chunk fora de ordem libera o slot
+    TEST_ASSERT_EQUAL(Pool::Status::Incomplete, pool.append(&requestC, a, 4, 0, 10));
+    TEST_ASSERT_EQUAL(Pool::Status::Invalid, pool.append(&requestC, a + 6, 4, 6, 10));
+    TEST_ASSERT_EQUAL_UINT32(0, pool.inUse());
+}
+
+struct StringSink {
+    std::string text;
+    void print(const char* line) { text += line; }
+};
+
+void test_metricsRegistryPrometheusText(void) {
+    using namespace GrowController;
+    static MetricRegistry registry;
+    static const uint32_t BOUNDS[2] = {1000, 250000};
+    static Counter ok(registry, "t_reads_total", "Reads.", "result=\"ok\"");
+    static Counter failed(registry, "t_reads_total", nullptr, "result=\"error\"");
+    static Gauge depth(registry, "t_depth", "Depth.");
+    static Histogram<2> duration(registry, "t_duration_seconds", "Duration.", BOUNDS);
+
+    ok.inc(3);
+    failed.inc();
+    depth.set(-2);
+    duration.observe(500);     // <= 1ms
+    duration.observe(1000);    // Limite inclusivo
+    duration.observe(300000);  // +Inf
+    duration.observe(UINT32_MAX); // Soma passa de 32 bits
+
+    StringSink sink;
+    registry.writePrometheus(sink);
+    TEST_ASSERT_EQUAL_STRING(
+        "# HELP t_reads_total Reads.\n# TYPE t_reads_total counter\n"
+        "t_reads_total{result=\"ok\"} 3\n"
+        "t_reads_total{result=\"error\"} 1\n"
+        "# HELP t_depth Depth.\n# TYPE t_depth gauge\n"
+        "t_depth -2\n"
+        "# HELP t_duration_seconds Duration.\n# TYPE t_duration_seconds histogram\n"
+        "t_duration_seconds_bucket{le=\"0.001000\"} 2\n"
+        "t_duration_seconds_bucket{le=\"0.250000\"} 2\n"
+        "t_duration_seconds_bucket{le=\"+Inf\"} 4\n"
+        "t_duration_seconds_sum 4295.268795\n"
+        "t_duration_seconds_count 4\n",
+        sink.text.c_str());
+}
+
+void test_historyCursorWindow(void) {
+    using namespace GrowController;
+    // 5 registros guardados, cursores 1..5
+    HistoryWindow w = historyWindowSince(0, 5, 5);
+    TEST_ASSERT_EQUAL_UINT32(1, w.firstCursor);
+    TEST_ASSERT_EQUAL_UINT32(0, w.offset);
+    TEST_ASSERT_EQUAL_UINT32(5, w.count);
+    TEST_ASSERT_FALSE(w.reset);
+
+    w = historyWindowSince(3, 5, 5);
+    TEST_ASSERT_EQUAL_UINT32(4, w.firstCursor);
+    TEST_ASSERT_EQUAL_UINT32(3, w.offset);
+    TEST_ASSERT_EQUAL_UINT32(2, w.count);
+
+    w = historyWindowSince(5, 5, 5); // Nada novo
+    TEST_ASSERT_EQUAL_UINT32(0, w.count);
+    TEST_ASSERT_FALSE(w.reset);
+
+    // Buffer circular cheio (48) após 100 gravações: cursores 53..100
+    w = historyWindowSince(10, 100, 48); // Cliente ficou para trás: envia tudo que existe
+    TEST_ASSERT_EQUAL_UINT32(53, w.firstCursor);
+    TEST_ASSERT_EQUAL_UINT32(0, w.offset);
+    TEST_ASSERT_EQUAL_UINT32(48, w.count);
+    w = historyWindowSince(99, 100, 48);
+    TEST_ASSERT_EQUAL_UINT32(100, w.firstCursor);
+    TEST_ASSERT_EQUAL_UINT32(47, w.offset);
+    TEST_ASSERT_EQUAL_UINT32(1, w.count);
+
+    // Cliente à frente (histórico apagado no dispositivo): reset e envia tudo
+    w = historyWindowSince(120, 2, 2);
+    TEST_ASSERT_TRUE(w.reset);
+    TEST_ASSERT_EQUAL_UINT32(1, w.firstCursor);
+    TEST_ASSERT_EQUAL_UINT32(2, w.count);
+    w = historyWindowSince(0, 0, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, w.count);
+
+    char etag[16];
+    formatHistoryEtag(etag, sizeof(etag), 100);
+    TEST_ASSERT_EQUAL_STRING("\"h100\"", etag);
+}
+
+void test_admissionControlPriorities(void) {
+    using namespace GrowController;
+    AdmissionLimits limits;
+    limits.maxActiveRequests = 3;
+    limits.reservedForHigh = 1;
+    limits.maxStreamClients = 2;
+    AdmissionController admission(limits);
+    const uint32_t plenty = 100 * 1024;
+
+    TEST_ASSERT_EQUAL(RequestPriority::High, requestPriorityFor("/api/targets", true));
+    TEST_ASSERT_EQUAL(RequestPriority::Normal, requestPriorityFor("/api/history", false));
+    TEST_ASSERT_EQUAL(RequestPriority::Low, requestPriorityFor("/scripts.js", false));
+    TEST_ASSERT_EQUAL(RequestPriority::Low, requestPriorityFor("/metrics", false));
+
+    // Vagas: Low/Normal usam 2 das 3; a última fica para escritas
+    TEST_ASSERT_EQUAL(AdmissionResult::Admitted, admission.tryAdmit(RequestPriority::Low, plenty));
+    TEST_ASSERT_EQUAL(AdmissionResult::Admitted, admission.tryAdmit(RequestPriority::Normal, plenty));
+    TEST_ASSERT_EQUAL(AdmissionResult::Busy, admission.tryAdmit(RequestPriority::Low, plenty));
+    TEST_ASSERT_EQUAL(AdmissionResult::Admitted, admission.tryAdmit(RequestPriority::High, plenty));
+    TEST_ASSERT_EQUAL(AdmissionResult::Busy, admission.tryAdmit(RequestPriority::High, plenty));
+    TEST_ASSERT_EQUAL_UINT32(3, admission.active());
+    admission.release();
+    admission.release();
+    admission.release();
+    admission.release(); // Release extra não deixa o contador negativo
+    TEST_ASSERT_EQUAL_UINT32(0, admission.active());
+
+    // Heap: assets caem primeiro, escritas por último
+    uint32_t heap = limits.minHeapNormal; // Abaixo do limite de Low
+    TEST_ASSERT_EQUAL(AdmissionResult::LowMemory, admission.tryAdmit(RequestPriority::Low, heap));
+    TEST_ASSERT_EQUAL(AdmissionResult::Admitted, admission.tryAdmit(RequestPriority::Normal, heap));
+    heap = limits.minHeapHigh;
+    TEST_ASSERT_EQUAL(AdmissionResult::LowMemory, admission.tryAdmit(RequestPriority::Normal, heap));
+    TEST_ASSERT_EQUAL(AdmissionResult::Admitted, admission.tryAdmit(RequestPriority::High, heap));
+    TEST_ASSERT_EQUAL(AdmissionResult::LowMemory, admission.tryAdmit(RequestPriority::High, heap - 1));
+
+    // Streams (SSE/WS) contam clientes conectados, não vagas de requisição
+    TEST_ASSERT_EQUAL(AdmissionResult::Admitted, admission.tryAdmitStream(1, plenty));
+    TEST_ASSERT_EQUAL(AdmissionResult::Busy, admission.tryAdmitStream(2, plenty));
+    TEST_ASSERT_EQUAL(AdmissionResult::LowMemory, admission.tryAdmitStream(0, limits.minHeapLow - 1));
+}
+
+// Estufa simulada: umidade cai com o umidificador desligado e sobe com ele ligado.
+// O sensor amostra a cada 10 s com fase própria; o laço de controle roda com a mesma
+// EventDrivenSchedule do firmware. Mede o atraso entre a amostra que exige mudar o relé
+// e a mudança do relé, com e sem notificação de amostra nova.
+static uint32_t simulateHumidityLoop(bool eventDriven, uint32_t* evaluations) {
+    using namespace GrowController;
+    const uint32_t stepMs = 10;           // Granularidade da simulação (~1 tick)
+    const uint32_t samplePeriodMs = 10000;
+    const uint32_t samplePhaseMs = 3700;  // Sem sincronia com o laço de controle
+    const uint32_t fallbackMs = 10000;
+    const float target = 60.0f;
+
+    float humidity = 62.0f;
+    float cached = NAN;
+    bool relayOn = false;
+    bool pending = false;     // Amostra já pede outro estado do relé
+    uint32_t pendingSince = 0;
+    uint32_t worstLatency = 0;
+    EventDrivenSchedule schedule;
+    uint32_t wakeAt = 0;
+    bool notified = false;
+    *evaluations = 0;
+
+    for (uint32_t now = 0; now <= 600000; now += stepMs) {
+        humidity += (relayOn ? 0.4f : -0.1f) * stepMs / 1000.0f;
+        if (now >= samplePhaseMs && (now - samplePhaseMs) % samplePeriodMs == 0) {
+            cached = humidity;
+            if (!pending && humidifierShouldRun(cached, target) != relayOn) {
+                pending = true;
+                pendingSince = now;
+            }
+            if (eventDriven) notified = true; // notify(CHANGE_SENSORS)
+        }
+        if (!notified && now < wakeAt) continue; // Tarefa dormindo
+        if (schedule.due(notified, now, fallbackMs)) {
+            (*evaluations)++;
+            relayOn = humidifierShouldRun(cached, target);
+            schedule.markRun(now);
+            if (pending) {
+                uint32_t latency = now - pendingSince;
+                if (latency > worstLatency) worstLatency = latency;
+                pending = false;
+            }
+        }
+        notified = false;
+        wakeAt = now + schedule.waitMs(now, fallbackMs);
+    }
+    return worstLatency;
+}
+
+void test_humidityControlReactsToNewSamples(void) {
+    using namespace GrowController;
+    TEST_ASSERT_FALSE(humidifierShouldRun(NAN, 60.0f));
+    TEST_ASSERT_FALSE(humidifierShouldRun(50.0f, 0.0f));
+    TEST_ASSERT_TRUE(humidifierShouldRun(59.9f, 60.0f));
+    TEST_ASSERT_FALSE(humidifierShouldRun(60.0f, 60.0f));
+
+    EventDrivenSchedule schedule;
+    TEST_ASSERT_EQUAL_UINT32(0, schedule.waitMs(123, 10000)); // Primeira avaliação é imediata
+    schedule.markRun(0xFFFFF000u);
+    TEST_ASSERT_EQUAL_UINT32(10000 - 0x1000 - 0x100, schedule.waitMs(0x100, 10000)); // millis() deu a volta
+    TEST_ASSERT_TRUE(schedule.due(true, 0x100, 10000));
+    TEST_ASSERT_FALSE(schedule.due(false, 0x100, 10000));
+
+    uint32_t evaluations = 0;
+    uint32_t eventLatency = simulateHumidityLoop(true, &evaluations);
+    TEST_ASSERT_TRUE(evaluations >= 60);     // Uma por amostra em 10 min
+    TEST_ASSERT_EQUAL_UINT32(0, eventLatency); // Relé muda no mesmo tick da amostra
+
+    uint32_t pollingLatency = simulateHumidityLoop(false, &evaluations);
+    TEST_ASSERT_TRUE(pollingLatency > 5000); // Só polling: a amostra envelhece até a próxima volta
+    TEST_ASSERT_TRUE(pollingLatency <= 10000);
+    TEST_ASSERT_TRUE(evaluations >= 60);     // Sem eventos, a reavaliação de segurança continua
+}
+
+// Malha fechada simulada: estufa de primeira ordem (perde umidade para o ambiente),
+// névoa do umidificador com atraso, sensor com ruído de ±1 %UR amostrado a cada 10 s.
+// Relatório: trocas do relé e erro RMS (após 30 min de aquecimento) por estratégia.
+struct HumiditySimResult {
+    uint32_t switches;
+    float rmsError;
+};
+
+static HumiditySimResult simulateHumidityStrategy(GrowController::HumidityControlMode mode) {
+    using namespace GrowController;
+    HumidityControlParams params;
+    params.mode = mode;
+    HumidityController controller(params);
+    const float target = 60.0f;
+    const float ambient = 45.0f;
+    const float lossTauS = 900.0f;     // Constante de tempo da perda para o ambiente
+    const float mistGain = 0.06f;      // %UR/s com a névoa no máximo
+    const float mistTauS = 40.0f;      // Atraso da névoa depois de ligar/desligar
+    float humidity = 55.0f;
+    float mist = 0.0f;
+    uint32_t seed = 12345;
+    double squaredError = 0.0;
+    uint32_t errorSamples = 0;
+
+    for (uint32_t second = 0; second < 6 * 3600; ++second) {
+        uint32_t nowMs = second * 1000;
+        if (second % 10 == 0) {
+            seed = seed * 1103515245u + 12345u;
+            float noise = ((seed >> 16) % 2001) / 1000.0f - 1.0f; // [-1, 1]
+            controller.onSample(humidity + noise, target, nowMs);
+        }
+        bool on = controller.relayState(nowMs);
+        mist += ((on ? 1.0f : 0.0f) - mist) / mistTauS;
+        humidity += (ambient - humidity) / lossTauS + mistGain * mist;
+        if (second >= 1800) {
+            squaredError += (double)(humidity - target) * (humidity - target);
+            errorSamples++;
+        }
+    }
+    HumiditySimResult result = {controller.switchCount(), (float)sqrt(squaredError / errorSamples)};
+    return result;
+}
+
+void test_humidityControllerStrategies(void) {
+    using namespace GrowController;
+    HumidityControlParams params;
+    TEST_ASSERT_TRUE(humidityControlParamsValid(params));
+    params.windowMs = 1000;
+    TEST_ASSERT_FALSE(humidityControlParamsValid(params));
+    HumidityControlMode mode = HumidityControlMode::OnOff;
+    TEST_ASSERT_TRUE(parseHumidityControlMode("pid", &mode));
+    TEST_ASSERT_EQUAL(HumidityControlMode::Pid, mode);
+    TEST_ASSERT_FALSE(parseHumidityControlMode("bangbang", &mode));
+    TEST_ASSERT_EQUAL_STRING("hysteresis", humidityControlModeName(HumidityControlMode::Hysteresis));
+
+    // Histerese: dentro da banda mantém; tempo mínimo ligado segura o relé; leitura inválida desliga na hora
+    HumidityController hysteresis;
+    hysteresis.onSample(58.0f, 60.0f, 0);
+    TEST_ASSERT_TRUE(hysteresis.relayState(0));
+    hysteresis.onSample(60.5f, 60.0f, 10000);
+    TEST_ASSERT_TRUE(hysteresis.relayState(10000));
+    hysteresis.onSample(61.5f, 60.0f, 20000);
+    TEST_ASSERT_TRUE(hysteresis.relayState(20000)); // Ainda nos 30 s mínimos
+    TEST_ASSERT_EQUAL_UINT32(10000, hysteresis.msUntilNextChange(20000));
+    TEST_ASSERT_FALSE(hysteresis.relayState(30000));
+    hysteresis.onSample(50.0f, 60.0f, 40000);
+    TEST_ASSERT_FALSE(hysteresis.relayState(40000)); // 60 s mínimos desligado
+    TEST_ASSERT_TRUE(hysteresis.relayState(90000));
+    hysteresis.onSample(NAN, 60.0f, 95000);
+    TEST_ASSERT_FALSE(hysteresis.relayState(95000));
+
+    // PID saturado em erro grande: integral não acumula (anti-windup)
+    params = HumidityControlParams();
+    params.mode = HumidityControlMode::Pid;
+    HumidityController pid(params);
+    for (uint32_t t = 0; t <= 600000; t += 10000) pid.onSample(40.0f, 60.0f, t);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 1.0f, pid.duty());
+    pid.onSample(60.5f, 60.0f, 610000);
+    TEST_ASSERT_TRUE(pid.duty() < 0.05f); // Sem integral acumulada, desliga logo ao passar do alvo
+
+    HumiditySimResult onOff = simulateHumidityStrategy(HumidityControlMode::OnOff);
+    HumiditySimResult band = simulateHumidityStrategy(HumidityControlMode::Hysteresis);
+    HumiditySimResult timeProportional = simulateHumidityStrategy(HumidityControlMode::Pid);
+    printf("humidity control 6h sim: onoff %lu switches rms %.2f | hysteresis %lu switches rms %.2f | pid %lu switches rms %.2f\n",
+           (unsigned long)onOff.switches, onOff.rmsError, (unsigned long)band.switches, band.rmsError,
+           (unsigned long)timeProportional.switches, timeProportional.rmsError);
+    TEST_ASSERT_TRUE(band.switches * 3 < onOff.switches);
+    TEST_ASSERT_TRUE(timeProportional.switches * 3 < onOff.switches);
+    TEST_ASSERT_TRUE(band.rmsError < 2.0f);
+    TEST_ASSERT_TRUE(timeProportional.rmsError < 2.0f);
+}
+
+static struct tm hourMinute(int hour, int minute) {
+    struct tm value = {};
+    value.tm_hour = hour;
+    value.tm_min = minute;
+    return value;
+}
+
+void test_nextLightTransition(void) {
+    using namespace GrowController;
+    const char* previousTz = getenv("TZ");
+    std::string savedTz = previousTz ? previousTz : "";
+
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    struct tm on = hourMinute(6, 0), off = hourMinute(18, 0);
+    LightTransition next = nextLightTransition(1709294400, on, off); // 2024-03-01 12:00
+    TEST_ASSERT_EQUAL_INT(1709316000, (long)next.at);                // 18:00, desliga
+    TEST_ASSERT_FALSE(next.turnsOn);
+    next = nextLightTransition(1709323200, on, off);                 // 20:00
+    TEST_ASSERT_EQUAL_INT(1709359200, (long)next.at);                // 06:00 do dia seguinte
+    TEST_ASSERT_TRUE(next.turnsOn);
+    next = nextLightTransition(1709316000, on, off);                 // Exatamente 18:00: próxima é amanhã
+    TEST_ASSERT_EQUAL_INT(1709359200, (long)next.at);
+
+    // Atravessa a meia-noite: 22:00-04:00
+    on = hourMinute(22, 0);
+    off = hourMinute(4, 0);
+    TEST_ASSERT_TRUE(lightShouldBeOn(23 * 60, 22 * 60, 4 * 60));
+    TEST_ASSERT_TRUE(lightShouldBeOn(3 * 60 + 59, 22 * 60, 4 * 60));
+    TEST_ASSERT_FALSE(lightShouldBeOn(4 * 60, 22 * 60, 4 * 60));
+    next = nextLightTransition(1709334000, on, off);                 // 23:00
+    TEST_ASSERT_EQUAL_INT(1709352000, (long)next.at);                // 04:00 do dia seguinte
+    TEST_ASSERT_FALSE(next.turnsOn);
+    TEST_ASSERT_EQUAL_INT(0, (long)nextLightTransition(1709334000, on, on).at); // on == off: nunca
+
+    // Horário de verão europeu (CET/CEST): 2024-03-31 02:00 -> 03:00, 2024-10-27 03:00 -> 02:00
+    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+    tzset();
+    on = hourMinute(1, 0);
+    off = hourMinute(7, 0);
+    next = nextLightTransition(1711845000, on, off);                 // 01:30 CET
+    TEST_ASSERT_EQUAL_INT(1711861200, (long)next.at);                // 07:00 CEST = 05:00 UTC (luz ligada 1 h a menos)
+    next = nextLightTransition(1729980000, on, off);                 // 00:00 CEST
+    TEST_ASSERT_EQUAL_INT(1729983600, (long)next.at);                // 01:00 CEST = 23:00 UTC
+    TEST_ASSERT_TRUE(next.turnsOn);
+    next = nextLightTransition(next.at, on, off);
+    TEST_ASSERT_EQUAL_INT(1730008800, (long)next.at);                // 07:00 CET = 06:00 UTC (luz ligada 1 h a mais)
+    // Horário que não existe no dia do salto é normalizado para depois dele
+    next = nextLightTransition(1711845000, hourMinute(2, 30), off);
+    TEST_ASSERT_TRUE(next.at > 1711845000 && next.at <= 1711848600);
+    TEST_ASSERT_TRUE(next.turnsOn);
+
+    if (previousTz) setenv("TZ", savedTz.c_str(), 1); else unsetenv("TZ");
+    tzset();
+}
+
+void test_actuatorEngineRuleEvaluation(void) {
+    using namespace GrowController;
+    const char* previousTz = getenv("TZ");
+    std::string savedTz = previousTz ? previousTz : "";
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    ActuatorEngine<3> engine;
+    TEST_ASSERT_TRUE(engine.add(ActuatorDescriptor::schedule("light", 1, &TargetValues::lightOnTime, &TargetValues::lightOffTime)));
+    TEST_ASSERT_TRUE(engine.add(ActuatorDescriptor::setpoint("humidifier", 2, ActuatorInput::AirHumidity,
+                                                             &TargetValues::airHumidity, SetpointDirection::Raise)));
+    TEST_ASSERT_TRUE(engine.add(ActuatorDescriptor::setpoint("fan", 3, ActuatorInput::Temperature, &TargetValues::temperature,
+                                                             SetpointDirection::Lower, nullptr, 60000)));
+    TEST_ASSERT_FALSE(engine.add(ActuatorDescriptor::schedule("extra", 4, &TargetValues::lightOnTime, &TargetValues::lightOffTime)));
+
+    ActuatorInputs in;
+    in.targets.lightOnTime = hourMinute(6, 0);
+    in.targets.lightOffTime = hourMinute(18, 0);
+    in.targets.airHumidity = 60.0f;
+    in.targets.temperature = 25.0f;
+    in.clockValid = true;
+    in.epoch = 1709294400; // 2024-03-01 12:00 UTC
+    in.nowMs = 1000;
+    in.resample = true;
+    in.readings.airHumidity = 55.0f;
+    in.readings.temperature = 24.0f;
+
+    // Primeira passada reporta todas as saídas
+    uint32_t waitMs = 0;
+    TEST_ASSERT_EQUAL_UINT32(0x7, engine.evaluate(in, &waitMs));
+    TEST_ASSERT_TRUE(engine.output(0));
+    TEST_ASSERT_TRUE(engine.output(1));
+    TEST_ASSERT_FALSE(engine.output(2));
+    TEST_ASSERT_EQUAL_UINT32((ActuatorEngine<3>::MAX_SLEEP_MS), waitMs); // 18:00 está a 6 h: teto
+
+    // Exaustor (Lower) liga acima do alvo; umidificador (Raise) desliga acima do alvo
+    in.nowMs = 11000;
+    in.readings.airHumidity = 61.0f;
+    in.readings.temperature = 27.0f;
+    TEST_ASSERT_EQUAL_UINT32(0x6, engine.evaluate(in, &waitMs));
+    TEST_ASSERT_FALSE(engine.output(1));
+    TEST_ASSERT_TRUE(engine.output(2));
+
+    // Tempo mínimo do exaustor segura a troca e vira o próximo prazo
+    in.nowMs = 21000;
+    in.readings.temperature = 24.0f;
+    TEST_ASSERT_EQUAL_UINT32(0, engine.evaluate(in, &waitMs));
+    TEST_ASSERT_TRUE(engine.output(2));
+    TEST_ASSERT_EQUAL_UINT32(50000, waitMs);
+    in.nowMs = 71000;
+    in.resample = false; // Acordou pelo prazo, sem amostra nova
+    TEST_ASSERT_EQUAL_UINT32(0x4, engine.evaluate(in, &waitMs));
+    TEST_ASSERT_FALSE(engine.output(2));
+
+    // Horário: prazo até a troca com a fração de segundo descontada
+    in.epoch = 1709315970; // 17:59:30
+    in.epochMillis = 500;
+    TEST_ASSERT_EQUAL_UINT32(0, engine.evaluate(in, &waitMs));
+    TEST_ASSERT_EQUAL_UINT32(29500 + ActuatorEngine<3>::WAKE_MARGIN_MS, waitMs);
+    in.epoch = 1709316000; // 18:00
+    TEST_ASSERT_EQUAL_UINT32(0x1, engine.evaluate(in, &waitMs));
+    TEST_ASSERT_FALSE(engine.output(0));
+
+    // Sem relógio: mantém o estado e tenta de novo no intervalo configurado
+    in.clockValid = false;
+    in.clockRetryMs = 5000;
+    TEST_ASSERT_EQUAL_UINT32(0, engine.evaluate(in, &waitMs));
+    TEST_ASSERT_EQUAL_UINT32(5000, waitMs);
+
+    // Leitura inválida desliga na hora
+    in.clockValid = true;
+    in.resample = true;
+    in.readings.airHumidity = 50.0f;
+    engine.evaluate(in, &waitMs);
+    TEST_ASSERT_TRUE(engine.output(1));
+    in.readings.airHumidity = NAN;
+    TEST_ASSERT_EQUAL_UINT32(0x2, engine.evaluate(in, &waitMs));
+    TEST_ASSERT_FALSE(engine.output(1));
+
+    if (previousTz) setenv("TZ", savedTz.c_str(), 1); else unsetenv("TZ");
+    tzset();
+}
+
+void test_actuatorUsageAccounting(void) {
+    using namespace GrowController;
+    ActuatorUsageTracker tracker;
+    tracker.begin(false, 1000);
+    tracker.onTransition(true, 1000);
+    tracker.onTransition(true, 500000); // Mesmo estado: acumula, não conta troca
+    tracker.onTransition(false, 3601000);
+
+    ActuatorUsageSnapshot snapshot = tracker.snapshot(3601000);
+    TEST_ASSERT_FALSE(snapshot.on);
+    TEST_ASSERT_EQUAL_UINT32(3600000, (uint32_t)snapshot.totalOnMs);
+    TEST_ASSERT_EQUAL_UINT32(2, snapshot.totalSwitches);
+    TEST_ASSERT_EQUAL_UINT32(2, snapshot.todaySwitches);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.0f - expf(-1.0f), snapshot.duty1h);     // 1 h ligado, τ = 1 h
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.0f - expf(-1.0f / 24.0f), snapshot.duty24h);
+
+    // O intervalo aberto entra no snapshot sem alterar o estado
+    tracker.onTransition(true, 4000000);
+    snapshot = tracker.snapshot(4600000);
+    TEST_ASSERT_TRUE(snapshot.on);
+    TEST_ASSERT_EQUAL_UINT32(600000, snapshot.onForMs);
+    TEST_ASSERT_EQUAL_UINT32(4200000, snapshot.todayOnMs);
+    TEST_ASSERT_EQUAL_UINT32(4200000, tracker.snapshot(4600000).todayOnMs);
+
+    // Virada do dia: devolve os totais e zera só os contadores diários
+    uint32_t onSeconds = 0;
+    uint32_t switches = 0;
+    tracker.closeDay(4600000, &onSeconds, &switches);
+    TEST_ASSERT_EQUAL_UINT32(4200, onSeconds);
+    TEST_ASSERT_EQUAL_UINT32(3, switches);
+    snapshot = tracker.snapshot(4700000);
+    TEST_ASSERT_EQUAL_UINT32(100000, snapshot.todayOnMs);
+    TEST_ASSERT_EQUAL_UINT32(0, snapshot.todaySwitches);
+    TEST_ASSERT_EQUAL_UINT32(4300000, (uint32_t)snapshot.totalOnMs);
+
+    // Checkpoint de antes do reboot soma ao que já contou
+    tracker.seedToday(60, 4);
+    snapshot = tracker.snapshot(4700000);
+    TEST_ASSERT_EQUAL_UINT32(160000, snapshot.todayOnMs);
+    TEST_ASSERT_EQUAL_UINT32(4, snapshot.todaySwitches);
+
+    // Wraparound do millis()
+    tracker.begin(true, 0xFFFFF000u);
+    TEST_ASSERT_EQUAL_UINT32(0x2000, tracker.snapshot(0x1000).todayOnMs);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, energyWh(7200, 25.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, energyWh(7200, 0.0f));
+    char payload[40];
+    TEST_ASSERT_TRUE(formatUsagePayload(payload, sizeof(payload), "humidifier", 20261018, 86400, 65535, 9999.9f) > 0);
+    TEST_ASSERT_EQUAL_STRING("humidifier 20261018 86400 65535 9999.9", payload);
+    volatile size_t payloadSize = sizeof(payload); // Tamanho em runtime: o estouro aqui é proposital (sem -Wformat-truncation)
+    TEST_ASSERT_EQUAL(-1, formatUsagePayload(payload, payloadSize, "a-very-long-actuator-name", 20261018, 86400, 1, 1.0f));
+
+    // Dia local e meia-noite seguinte, inclusive no dia de 25 h do fim do horário de verão
+    const char* previousTz = getenv("TZ");
+    std::string savedTz = previousTz ? previousTz : "";
+    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+    tzset();
+    TEST_ASSERT_EQUAL_UINT32(20241027, localDayKey(1729980000));                 // 2024-10-27 00:00 CEST
+    TEST_ASSERT_EQUAL_UINT32(25 * 3600, (uint32_t)(nextLocalMidnight(1729980000) - 1729980000));
+    TEST_ASSERT_EQUAL_UINT32(20241026, localDayKey(1729979999));
+    if (previousTz) setenv("TZ", savedTz.c_str(), 1); else unsetenv("TZ");
+    tzset();
+}
+
+void test_psychrometricsVpdInverse(void) {
+    using namespace GrowController;
+    // SVP(25 °C) ≈ 3.168 kPa: VPD 1.0 pede UR ≈ 68.4%
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 68.4f, humidityForVpd(25.0f, 1.0f));
+    const float temps[] = {15.0f, 22.0f, 28.0f, 35.0f};
+    for (float temp : temps) {
+        TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.2f, vpdKpa(temp, humidityForVpd(temp, 1.2f)));
+    }
+    // Mais quente pede mais UR para o mesmo VPD
+    TEST_ASSERT_TRUE(humidityForVpd(28.0f, 1.0f) > humidityForVpd(22.0f, 1.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, humidityForVpd(10.0f, 5.0f)); // VPD maior que a SVP: limita em 0
+    TEST_ASSERT_TRUE(isnan(humidityForVpd(NAN, 1.0f)));
+    TEST_ASSERT_TRUE(isnan(humidityForVpd(25.0f, NAN)));
+    TEST_ASSERT_TRUE(isnan(humidityForVpd(90.0f, 1.0f)));
+    TEST_ASSERT_TRUE(isnan(vpdKpa(25.0f, 110.0f)));
+}
+
+struct PlantRunStats {
+    float vpdMeanAbsError;
+    float soilMeanAbsError;
+    float soilMin;
+    float soilMax;
+    float airHumidityMax;
+    uint32_t humidifierSwitches;
+    uint32_t pumpSwitches;
+};
+
+// Estufa simplificada por 26 h (amostras de 5 s), medida depois das 2 h iniciais:
+// - temperatura sobe de 22 para 28 °C com a luz (06:00-18:00), constante de 30 min;
+// - pressão de vapor: troca com o ar externo (0.9 kPa, 20 min), umidificador e transpiração (∝ VPD, maior com luz);
+// - solo: perde água com a transpiração; a bomba molha a superfície, que infiltra até o sensor em ~10 min.
+static PlantRunStats runPlantModel(GrowController::ClimateMode mode) {
+    using namespace GrowController;
+    ActuatorEngine<3> engine;
+    engine.add(ActuatorDescriptor::schedule("light", 1, &TargetValues::lightOnTime, &TargetValues::lightOffTime));
+    engine.add(ActuatorDescriptor::setpoint("humidifier", 2, ActuatorInput::AirHumidity, &TargetValues::airHumidity,
+                                            SetpointDirection::Raise, &TargetValues::humidityControl, 0, 0.0f,
+                                            SetpointTarget::HumidityForVpd));
+    engine.add(ActuatorDescriptor::setpoint("irrigation", 3, ActuatorInput::SoilHumidity, &TargetValues::soilHumidity,
+                                            SetpointDirection::Raise, &TargetValues::irrigationControl));
+
+    const float targetVpd = 1.0f;
+    const float targetSoil = 60.0f;
+    ActuatorInputs in;
+    in.targets.lightOnTime = hourMinute(6, 0);
+    in.targets.lightOffTime = hourMinute(18, 0);
+    in.targets.climateMode = mode;
+    in.targets.vpd = targetVpd;
+    in.targets.airHumidity = humidityForVpd(22.0f, targetVpd); // UR fixa: certa só na temperatura da noite
+    in.targets.soilHumidity = targetSoil;
+    in.clockValid = true;
+    in.resample = true;
+
+    float temp = 22.0f;
+    float vapor = 1.6f;
+    float soil = 50.0f;
+    float surfaceWater = 0.0f;
+    const float dt = 5.0f;
+    PlantRunStats stats = {0.0f, 0.0f, 100.0f, 0.0f, 0.0f, 0, 0};
+    double vpdError = 0.0;
+    double soilError = 0.0;
+    uint32_t samples = 0;
+    bool lastHumidifier = false;
+    bool lastPump = false;
+    for (uint32_t t = 0; t < 26 * 3600; t += 5) {
+        float svp = saturationVaporPressureKpa(temp);
+        in.epoch = 1709251200 + t; // 2024-03-01 00:00 UTC
+        in.nowMs = 1000 + t * 1000;
+        in.readings.temperature = temp;
+        in.readings.airHumidity = 100.0f * vapor / svp;
+        in.readings.soilHumidity = soil;
+        engine.evaluate(in, nullptr);
+        bool light = engine.output(0);
+        bool humidifier = engine.output(1);
+        bool pump = engine.output(2);
+
+        float vpd = svp - vapor;
+        float transpiration = (light ? 0.00015f : 0.00002f) * vpd; // kPa/s
+        temp += ((light ? 28.0f : 22.0f) - temp) * dt / 1800.0f;
+        vapor += ((0.9f - vapor) / 1200.0f + (humidifier ? 0.0015f : 0.0f) + transpiration) * dt;
+        if (vapor > svp) vapor = svp;
+        float infiltration = surfaceWater * dt / 600.0f;
+        surfaceWater += (pump ? 0.05f : 0.0f) * dt - infiltration;
+        soil += infiltration - (0.2f / 3600.0f + transpiration * 5.5f) * dt;
+
+        if (t >= 2 * 3600) {
+            vpdError += fabsf(vpd - targetVpd);
+            soilError += fabsf(soil - targetSoil);
+            samples++;
+            if (soil < stats.soilMin) stats.soilMin = soil;
+            if (soil > stats.soilMax) stats.soilMax = soil;
+            if (in.readings.airHumidity > stats.airHumidityMax) stats.airHumidityMax = in.readings.airHumidity;
+            if (humidifier != lastHumidifier) stats.humidifierSwitches++;
+            if (pump != lastPump) stats.pumpSwitches++;
+        }
+        lastHumidifier = humidifier;
+        lastPump = pump;
+    }
+    stats.vpdMeanAbsError = (float)(vpdError / samples);
+    stats.soilMeanAbsError = (float)(soilError / samples);
+    return stats;
+}
+
+void test_vpdAndIrrigationOnPlantModel(void) {
+    using namespace GrowController;
+    const char* previousTz = getenv("TZ");
+    std::string savedTz = previousTz ? previousTz : "";
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    PlantRunStats fixed = runPlantModel(ClimateMode::Humidity);
+    PlantRunStats vpd = runPlantModel(ClimateMode::Vpd);
+
+    // UR fixa erra o VPD quando a luz esquenta a estufa; o alvo derivado acompanha a temperatura
+    TEST_ASSERT_TRUE(fixed.vpdMeanAbsError > 0.15f);
+    TEST_ASSERT_TRUE(vpd.vpdMeanAbsError < 0.05f);
+    TEST_ASSERT_TRUE(vpd.airHumidityMax <= ActuatorEngine<3>::VPD_HUMIDITY_MAX + 2.0f);
+    TEST_ASSERT_TRUE(vpd.humidifierSwitches < 1000); // Histerese + tempos mínimos (~1 ciclo a cada 3 min)
+
+    // Irrigação em pulsos: solo perto do alvo, sem encharcar, poucas regas por dia
+    TEST_ASSERT_TRUE(vpd.soilMeanAbsError < 1.5f);
+    TEST_ASSERT_TRUE(vpd.soilMin > 55.0f);
+    TEST_ASSERT_TRUE(vpd.soilMax < 66.0f);
+    TEST_ASSERT_TRUE(vpd.pumpSwitches > 0);
+    TEST_ASSERT_TRUE(vpd.pumpSwitches <= 2 * 96); // No máximo um pulso por janela de 15 min
+
+    if (previousTz) setenv("TZ", savedTz.c_str(), 1); else unsetenv("TZ");
+    tzset();
+}
+
 #ifdef ARDUINO
 #include <Arduino.h> // Necessário para setup/loop no Arduino
 void setup() {
    delay(2000); // Delay para dar tempo ao monitor serial de conectar
     UNITY_BEGIN();
     RUN_TEST(test_calculateVpd);
+    RUN_TEST(test_mqttTopicTable);
+    RUN_TEST(test_mqttPublishPathDoesNotAllocate);
+    RUN_TEST(test_ringBufferFifoAndCapacity);
+    RUN_TEST(test_storeForwardQueueSpillAndReplay);
+    RUN_TEST(test_mpscQueueFifoAndConcurrentProducers);
+    RUN_TEST(test_mqttBackoffBoundsAndJitter);
+    RUN_TEST(test_mqttQos1PublishAndPubackParsing);
+    RUN_TEST(test_mqttHistoryChunkFormatting);
+    RUN_TEST(test_telemetryCodecGoldenVectors);
+    RUN_TEST(test_runtimeRatesValidation);
+    RUN_TEST(test_staticAssetManifestAndEtag);
+    RUN_TEST(test_snapshotBufferVersionsAndConsistency);
+    RUN_TEST(test_stateFieldsParsing);
+    RUN_TEST(test_liveFrameRoundTripAndRateCommand);
+    RUN_TEST(test_requestBodyPoolInterleavedRequests);
+    RUN_TEST(test_metricsRegistryPrometheusText);
+    RUN_TEST(test_historyCursorWindow);
+    RUN_TEST(test_admissionControlPriorities);
+    RUN_TEST(test_humidityControlReactsToNewSamples);
+    RUN_TEST(test_humidityControllerStrategies);
+    RUN_TEST(test_nextLightTransition);
+    RUN_TEST(test_actuatorEngineRuleEvaluation);
+    RUN_TEST(test_actuatorUsageAccounting);
+    RUN_TEST(test_psychrometricsVpdInverse);
+    RUN_TEST(test_vpdAndIrrigationOnPlantModel);
     UNITY_END();
 }
 
@@ -62,6 +1381,31 @@ void loop() {
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_calculateVpd);
+    RUN_TEST(test_mqttTopicTable);
+    RUN_TEST(test_mqttPublishPathDoesNotAllocate);
+    RUN_TEST(test_ringBufferFifoAndCapacity);
+    RUN_TEST(test_storeForwardQueueSpillAndReplay);
+    RUN_TEST(test_mpscQueueFifoAndConcurrentProducers);
+    RUN_TEST(test_mqttBackoffBoundsAndJitter);
+    RUN_TEST(test_mqttQos1PublishAndPubackParsing);
+    RUN_TEST(test_mqttHistoryChunkFormatting);
+    RUN_TEST(test_telemetryCodecGoldenVectors);
+    RUN_TEST(test_runtimeRatesValidation);
+    RUN_TEST(test_staticAssetManifestAndEtag);
+    RUN_TEST(test_snapshotBufferVersionsAndConsistency);
+    RUN_TEST(test_stateFieldsParsing);
+    RUN_TEST(test_liveFrameRoundTripAndRateCommand);
+    RUN_TEST(test_requestBodyPoolInterleavedRequests);
+    RUN_TEST(test_metricsRegistryPrometheusText);
+    RUN_TEST(test_historyCursorWindow);
+    RUN_TEST(test_admissionControlPriorities);
+    RUN_TEST(test_humidityControlReactsToNewSamples);
+    RUN_TEST(test_humidityControllerStrategies);
+    RUN_TEST(test_nextLightTransition);
+    RUN_TEST(test_actuatorEngineRuleEvaluation);
+    RUN_TEST(test_actuatorUsageAccounting);
+    RUN_TEST(test_psychrometricsVpdInverse);
+    RUN_TEST(test_vpdAndIrrigationOnPlantModel);
     return UNITY_END();
 }
 #endif
\ No newline at end of file
@@ -3,11 +3,17 @@ document.addEventListener('DOMContentLoaded', function() {
     const airHumidityValueEl = document.getElementById('air-humidity-value');
     const soilHumidityValueEl = document.getElementById('soil-humidity-value');
     const vpdValueEl = document.getElementById('vpd-value');
+    const soilAdcRowEl = document.getElementById('soil-adc-row');
+    const soilAdcValueEl = document.getElementById('soil-adc-value');
+    const historySummaryEl = document.getElementById('history-summary');
 
     const lightStatusEl = document.getElementById('light-status');
     const lightOnTimeEl = document.getElementById('light-on-time');
     const lightOffTimeEl = document.getElementById('light-off-time');
     const humidifierStatusEl = document.getElementById('humidifier-status');
+    const humidifierModeEl = document.getElementById('humidifier-mode');
+    const irrigationRowEl = document.getElementById('irrigation-row');
+    const irrigationStatusEl = document.getElementById('irrigation-status');
     const currentTargetAirHumidityEl = document.getElementById('current-target-air-humidity');
 
     const targetsForm = document.getElementById('targets-form');
@@ -29,6 +35,16 @@ document.addEventListener('DOMContentLoaded', function() {
         lightOffTimeEl.textContent = data.light.offTime;
 
         humidifierStatusEl.textContent = data.humidifier.isOn ? 'Ligado' : 'Desligado';
+        const modeNames = { onoff: 'Liga/Desliga', hysteresis: 'Histerese', pid: 'PID' };
+        let modeText = modeNames[data.humidifier.mode] || '--';
+        if (data.humidifier.climate === 'vpd' && typeof data.humidifier.effectiveTarget === 'number') {
+            modeText += ` (VPD, alvo ${data.humidifier.effectiveTarget.toFixed(1)} %)`;
+        }
+        humidifierModeEl.textContent = modeText;
+        if (data.irrigation) {
+            irrigationRowEl.hidden = false;
+            irrigationStatusEl.textContent = data.irrigation.isOn ? 'Ligada' : 'Desligada';
+        }
         if (typeof data.humidifier.targetAirHumidity === 'number') {
             currentTargetAirHumidityEl.textContent = data.humidifier.targetAirHumidity.toFixed(1);
             if (targetAirHumidityInput.value === '') {
@@ -45,33 +61,133 @@ document.addEventListener('DOMContentLoaded', function() {
         }
     }
 
-    async function fetchInitialData() {
-        try {
-            const sensorsResponse = await fetch('/api/sensors');
-            if (sensorsResponse.ok) {
-                const sensorsData = await sensorsResponse.json();
-                updateSensorUI(sensorsData);
+    // Frames binários de /ws (espelha src/network/liveFrame.hpp; little-endian)
+    const LIVE_FRAME_VERSION = 1;
+    const LIVE_FRAME_SENSORS = 1;
+    const LIVE_FRAME_ACTUATORS = 2;
+
+    function decodeLiveFrame(buffer) {
+        const view = new DataView(buffer);
+        if (view.byteLength < 8 || view.getUint8(0) !== LIVE_FRAME_VERSION) return null;
+        const frame = { type: view.getUint8(1), seq: view.getUint16(2, true), millis: view.getUint32(4, true) };
+        const u16 = (offset, scale) => {
+            const raw = view.getUint16(offset, true);
+            return raw === 0xFFFF ? null : raw / scale;
+        };
+        if (frame.type === LIVE_FRAME_SENSORS && view.byteLength === 18) {
+            const centi = view.getInt16(8, true);
+            frame.temperature = centi === -32768 ? null : centi / 100;
+            frame.airHumidity = u16(10, 100);
+            frame.soilHumidity = u16(12, 100);
+            frame.vpd = u16(14, 1000);
+            frame.soilAdc = u16(16, 1);
+            return frame;
+        }
+        if (frame.type === LIVE_FRAME_ACTUATORS && view.byteLength === 10) {
+            const relays = view.getUint8(8);
+            frame.lightOn = (relays & 1) !== 0;
+            frame.humidifierOn = (relays & 2) !== 0;
+            frame.irrigationOn = (relays & 4) !== 0;
+            frame.changed = view.getUint8(9);
+            return frame;
+        }
+        return null;
+    }
+
+    // Painéis de parede: /?live=250 troca o SSE pelo stream binário a cada 250 ms
+    function openLiveStream(rateMs) {
+        const socket = new WebSocket(`ws://${location.host}/ws`);
+        socket.binaryType = 'arraybuffer';
+        socket.onopen = () => socket.send(`rate=${rateMs}`);
+        socket.onmessage = (event) => {
+            if (!(event.data instanceof ArrayBuffer)) return;
+            const frame = decodeLiveFrame(event.data);
+            if (!frame) return;
+            if (frame.type === LIVE_FRAME_SENSORS) {
+                updateSensorUI(frame);
+                if (frame.soilAdc !== null) {
+                    soilAdcRowEl.hidden = false;
+                    soilAdcValueEl.textContent = frame.soilAdc;
+                }
             } else {
-                console.error('Error fetching sensor data:', sensorsResponse.status);
+                lightStatusEl.textContent = frame.lightOn ? 'Ligada' : 'Desligada';
+                humidifierStatusEl.textContent = frame.humidifierOn ? 'Ligado' : 'Desligado';
+                if (!irrigationRowEl.hidden) {
+                    irrigationStatusEl.textContent = frame.irrigationOn ? 'Ligada' : 'Desligada';
+                }
             }
+        };
+        socket.onclose = () => setTimeout(() => openLiveStream(rateMs), 2000);
+    }
 
-            const statusResponse = await fetch('/api/status');
-            if (statusResponse.ok) {
-                const statusData = await statusResponse.json();
-                updateStatusUI(statusData);
+    async function fetchInitialData() {
+        try {
+            // Uma única requisição para o estado inicial do painel
+            const stateResponse = await fetch('/api/state?fields=sensors,status');
+            if (stateResponse.ok) {
+                const state = await stateResponse.json();
+                if (state.sensors) updateSensorUI(state.sensors);
+                if (state.status) updateStatusUI(state.status);
             } else {
-                console.error('Error fetching status data:', statusResponse.status);
+                console.error('Error fetching dashboard state:', stateResponse.status);
             }
         } catch (error) {
             console.error('Failed to fetch initial data:', error);
         }
     }
 
+    // Histórico incremental: só registros novos (?since=<cursor>); 304 enquanto nada foi gravado
+    const HISTORY_MAX_RECORDS = 48; // MAX_RECORDS do DataHistoryManager
+    const historyRecords = [];
+    let historyCursor = 0;
+    let historyEtag = null;
+
+    function updateHistoryUI() {
+        if (historyRecords.length === 0) {
+            historySummaryEl.textContent = 'sem registros';
+            return;
+        }
+        const last = new Date(historyRecords[historyRecords.length - 1].timestamp * 1000);
+        historySummaryEl.textContent = `${historyRecords.length} registros, último às ${last.toLocaleTimeString([], { hour: '2-digit', minute: '2-digit' })}`;
+    }
+
+    async function syncHistory() {
+        try {
+            const headers = historyEtag ? { 'If-None-Match': historyEtag } : {};
+            const response = await fetch(`/api/history?since=${historyCursor}`, { headers, cache: 'no-store' });
+            if (response.status === 304) {
+                return;
+            }
+            if (!response.ok) {
+                console.error('Error fetching history:', response.status);
+                return;
+            }
+            const data = await response.json();
+            if (data.reset) {
+                historyRecords.length = 0; // Histórico do dispositivo foi apagado
+            }
+            historyRecords.push(...data.records);
+            if (historyRecords.length > HISTORY_MAX_RECORDS) {
+                historyRecords.splice(0, historyRecords.length - HISTORY_MAX_RECORDS);
+            }
+            historyCursor = data.cursor;
+            historyEtag = response.headers.get('ETag');
+            updateHistoryUI();
+        } catch (error) {
+            console.error('Failed to sync history:', error);
+        }
+    }
+
     // Fetch initial data on load
     fetchInitialData();
+    syncHistory();
+    setInterval(syncHistory, 60000);
 
-    // Server-Sent Events for real-time updates
-    if (!!window.EventSource) {
+    const liveRate = parseInt(new URLSearchParams(location.search).get('live'), 10);
+    if (liveRate > 0 && !!window.WebSocket) {
+        openLiveStream(liveRate);
+    } else if (!!window.EventSource) {
+        // Server-Sent Events for real-time updates
         const source = new EventSource('/events');
 
         source.addEventListener('sensor_update', function(event) {